@@ -26,6 +26,7 @@
 #include <graphene/app/api.hpp>
 #include <graphene/app/api_access.hpp>
 #include <graphene/app/application.hpp>
+#include <graphene/account_history/account_history_plugin.hpp>
 #include <graphene/chain/database.hpp>
 #include <graphene/chain/get_config.hpp>
 #include <graphene/utilities/key_conversion.hpp>
@@ -77,7 +78,8 @@ namespace graphene { namespace app {
     {
        if( api_name == "database_api" )
        {
-          _database_api = std::make_shared< database_api >( std::ref( *_app.chain_database() ), &( _app.get_options() ) );
+          _database_api = std::make_shared< database_api >( std::ref( *_app.chain_database() ), &( _app.get_options() ),
+                                                            _app.get_subscription_dispatcher() );
        }
        else if( api_name == "network_broadcast_api" )
        {
@@ -95,6 +97,10 @@ namespace graphene { namespace app {
        {
           _crypto_api = std::make_shared< crypto_api >();
        }
+       else if( api_name == "metrics_api" )
+       {
+          _metrics_api = std::make_shared< metrics_api >( std::ref(_app) );
+       }
        else if( api_name == "debug_api" )
        {
           // can only enable this API if the plugin was loaded
@@ -203,6 +209,40 @@ namespace graphene { namespace app {
        return _app.p2p_node()->set_advanced_node_parameters(params);
     }
 
+    net::compact_block_relay_stats network_node_api::get_compact_block_relay_stats() const
+    {
+       return _app.p2p_node()->get_compact_block_relay_stats();
+    }
+
+    metrics_api::metrics_api( application& a ) : _app( a )
+    {
+    }
+
+    chain::block_profile metrics_api::get_block_profile() const
+    {
+       return _app.chain_database()->get_block_profiler().get_profile();
+    }
+
+    string metrics_api::get_block_profile_text() const
+    {
+       return _app.chain_database()->get_block_profiler().to_prometheus();
+    }
+
+    transaction_admission_stats metrics_api::get_transaction_admission_stats() const
+    {
+       return _app.get_transaction_admission_stats();
+    }
+
+    subscription_dispatch_stats metrics_api::get_subscription_dispatch_stats() const
+    {
+       return _app.get_subscription_dispatcher()->get_stats();
+    }
+
+    db::undo_stats metrics_api::get_undo_stats() const
+    {
+       return _app.chain_database()->get_last_block_undo_stats();
+    }
+
     fc::api<network_broadcast_api> login_api::network_broadcast()const
     {
        FC_ASSERT(_network_broadcast_api);
@@ -233,6 +273,12 @@ namespace graphene { namespace app {
        return *_crypto_api;
     }
 
+    fc::api<metrics_api> login_api::metrics() const
+    {
+       FC_ASSERT(_metrics_api);
+       return *_metrics_api;
+    }
+
     fc::api<graphene::debug_witness::debug_api> login_api::debug() const
     {
        FC_ASSERT(_debug_api);
@@ -270,7 +316,7 @@ namespace graphene { namespace app {
                                                                        operation_history_id_type start ) const
     {
        return get_account_history_impl(account,
-                                       [](const account_transaction_history_object*) { return true; },
+                                       [](const operation_history_object&) { return true; },
                                        stop,
                                        limit,
                                        start);
@@ -282,14 +328,12 @@ namespace graphene { namespace app {
                                                                       unsigned limit,
                                                                       operation_history_id_type start) const
     {
-       FC_ASSERT( _app.chain_database() );
-       const auto& db = *_app.chain_database();
-       return get_account_history_impl(account,
-                                       [&operation_types, &db](const account_transaction_history_object* node) {
-                                           return operation_types.find(node->operation_id(db).op.which()) != operation_types.end(); },
-                                       stop,
-                                       limit,
-                                       start);
+       return get_account_history_of_types(account,
+                                           operation_types,
+                                           [](const operation_history_object&) { return true; },
+                                           stop,
+                                           limit,
+                                           start);
     }
 
     vector<operation_history_object> history_api::get_trade_history_for_account( asset_id_type base,
@@ -299,27 +343,17 @@ namespace graphene { namespace app {
                                                                                  unsigned limit,
                                                                                  operation_history_id_type start)const
     {
-       FC_ASSERT( _app.chain_database() );
        FC_ASSERT( limit <= 100 );
-       const auto& db = *_app.chain_database();
-       auto fill_operation_type = operation(fill_order_operation()).which();
-       auto f = [&fill_operation_type, &db](const account_transaction_history_object* node, asset_id_type base, asset_id_type quote) {
-           auto& op = node->operation_id(db).op;
-           if(op.which() == fill_operation_type)
-           {
-               fill_order_operation fop = op.get<fill_order_operation>();
-               return fop.pays.asset_id == base && fop.receives.asset_id == quote;
-           }
-           return false;
-       };
-       vector<operation_history_object> r1 = get_account_history_impl(account, std::bind(f, std::placeholders::_1, base, quote), stop, limit, start);
-       vector<operation_history_object> r2 = get_account_history_impl(account, std::bind(f, std::placeholders::_1, quote, base), stop, limit, start);
-       vector<operation_history_object> result(r1);
-       std::move(r2.begin(), r2.end(), std::back_inserter(result));
-       std::sort(result.begin(), result.end(), [](const operation_history_object& a, const operation_history_object& b){
-           return a.id > b.id;
-       });
-       return result;
+       const uint32_t fill_operation_type = operation::tag<fill_order_operation>::value;
+       return get_account_history_of_types(account,
+                                           { fill_operation_type },
+                                           [base, quote](const operation_history_object& node) {
+                                               const auto& fop = node.op.get<fill_order_operation>();
+                                               return ( fop.pays.asset_id == base && fop.receives.asset_id == quote )
+                                                   || ( fop.pays.asset_id == quote && fop.receives.asset_id == base ); },
+                                           stop,
+                                           limit,
+                                           start);
     }
 
     vector<operation_history_object> history_api::get_relative_account_history( account_id_type account,
@@ -334,17 +368,13 @@ namespace graphene { namespace app {
        if( start == 0 )
          start = account(db).statistics(db).total_ops;
        else start = min( account(db).statistics(db).total_ops, start );
-       const auto& hist_idx = db.get_index_type<account_transaction_history_index>();
-       const auto& by_seq_idx = hist_idx.indices().get<by_seq>();
 
-       auto itr = by_seq_idx.upper_bound( boost::make_tuple( account, start ) );
-       auto itr_stop = by_seq_idx.lower_bound( boost::make_tuple( account, stop ) );
-       --itr;
-
-       while ( itr != itr_stop && result.size() < limit )
+       const auto* store = history_store();
+       for( uint32_t sequence = start; sequence > 0 && sequence >= stop && result.size() < limit; --sequence )
        {
-          result.push_back( itr->operation_id(db) );
-          --itr;
+          auto op = account_history::find_account_operation( db, store, account, sequence );
+          if( op.valid() )
+             result.push_back( std::move( *op ) );
        }
 
        return result;
@@ -384,7 +414,7 @@ namespace graphene { namespace app {
     } FC_CAPTURE_AND_RETHROW( (a)(b)(bucket_seconds)(start)(end) ) }
 
     vector<operation_history_object> history_api::get_account_history_impl( account_id_type account,
-                                                                            const std::function<bool(const account_transaction_history_object* node)> &selector,
+                                                                            const std::function<bool(const operation_history_object& op)> &selector,
                                                                             operation_history_id_type stop,
                                                                             unsigned limit,
                                                                             operation_history_id_type start ) const
@@ -393,24 +423,74 @@ namespace graphene { namespace app {
         const auto& db = *_app.chain_database();
         FC_ASSERT( limit <= 100 );
         vector<operation_history_object> result;
-        const auto& stats = account(db).statistics(db);
-        if( stats.most_recent_op == account_transaction_history_id_type() ) return result;
-        const account_transaction_history_object* node = &stats.most_recent_op(db);
-        if( start == operation_history_id_type() )
-            start = node->operation_id;
+        const bool from_most_recent = start == operation_history_id_type();
+
+        account_history::visit_account_history( db, history_store(), account,
+                                                [&]( const operation_history_object& op ) {
+            if( op.id.instance() <= stop.instance.value || result.size() >= limit )
+                return false;
+            if( ( from_most_recent || op.id.instance() <= start.instance.value ) && selector(op) )
+                result.push_back( op );
+            return true;
+        });
 
-        while(node && node->operation_id.instance.value > stop.instance.value && result.size() < limit)
+        return result;
+    }
+
+    vector<operation_history_object> history_api::get_account_history_of_types( account_id_type account,
+                                                                                const flat_set<uint32_t>& operation_types,
+                                                                                const std::function<bool(const operation_history_object& op)> &selector,
+                                                                                operation_history_id_type stop,
+                                                                                unsigned limit,
+                                                                                operation_history_id_type start ) const
+    {
+        // Without the account_history plugin there is no index by operation type, e.g. when history is in elasticsearch
+        if( !std::dynamic_pointer_cast<account_history::account_history_plugin>( _app.get_plugin( "account_history" ) ) )
+            return get_account_history_impl(account,
+                                            [&](const operation_history_object& op) {
+                                                return operation_types.find(op.op.which()) != operation_types.end()
+                                                    && selector(op); },
+                                            stop,
+                                            limit,
+                                            start);
+
+        FC_ASSERT( _app.chain_database() );
+        const auto& db = *_app.chain_database();
+        FC_ASSERT( limit <= 100 );
+        vector<operation_history_object> result;
+        const bool from_most_recent = start == operation_history_id_type();
+
+        // Up to limit operations of each type, merged below
+        for( uint32_t which : operation_types )
         {
-            if( node->operation_id.instance.value <= start.instance.value && selector(node) )
-                result.push_back( node->operation_id(db) );
-            if( node->next == account_transaction_history_id_type() )
-                node = nullptr;
-            else node = &node->next(db);
+            unsigned found = 0;
+            account_history::visit_account_history_of_type( db, history_store(), account, which,
+                                                            [&]( const operation_history_object& op ) {
+                if( op.id.instance() <= stop.instance.value || found >= limit )
+                    return false;
+                if( ( from_most_recent || op.id.instance() <= start.instance.value ) && selector(op) )
+                {
+                    result.push_back( op );
+                    ++found;
+                }
+                return true;
+            });
         }
 
+        std::sort( result.begin(), result.end(), []( const operation_history_object& a, const operation_history_object& b ) {
+            return a.id > b.id;
+        });
+        if( result.size() > limit )
+            result.resize( limit );
         return result;
     }
 
+    const account_history::account_history_store* history_api::history_store()const
+    {
+        auto plugin = std::dynamic_pointer_cast<account_history::account_history_plugin>( _app.get_plugin( "account_history" ) );
+        return plugin ? plugin->store() : nullptr;
+    }
+
     crypto_api::crypto_api(){};
 
     blind_factor_type crypto_api::blind_sum( const std::vector<blind_factor_type>& blinds_in, uint32_t non_neg )
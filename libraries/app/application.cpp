@@ -395,7 +395,11 @@ void application_impl::startup()
 
    try
    {
-      _chain_db->open( _data_dir / "blockchain", initial_state, GRAPHENE_CURRENT_DB_VERSION );
+      if( _options->count("import-snapshot") )
+         _chain_db->open_from_snapshot( _data_dir / "blockchain", _options->at("import-snapshot").as<boost::filesystem::path>(),
+                                        initial_state, GRAPHENE_CURRENT_DB_VERSION );
+      else
+         _chain_db->open( _data_dir / "blockchain", initial_state, GRAPHENE_CURRENT_DB_VERSION );
    }
    catch( const fc::exception& e )
    {
@@ -403,6 +407,24 @@ void application_impl::startup()
       throw;
    }
 
+   if( _options->count("export-snapshot") )
+      _chain_db->export_snapshot( _options->at("export-snapshot").as<boost::filesystem::path>() );
+
+   if( _options->count("block-profiler") )
+      _chain_db->get_block_profiler().enable( _options->at("block-profiler").as<bool>() );
+   if( _options->count("block-profiler-file") && _chain_db->get_block_profiler().enabled() )
+   {
+      _block_profile_file = _options->at("block-profiler-file").as<boost::filesystem::path>();
+      _block_profile_interval = fc::seconds( _options->count("block-profiler-interval") ?
+                                             _options->at("block-profiler-interval").as<uint32_t>() : 60 );
+      _block_profile_connection = _chain_db->applied_block.connect( [this]( const signed_block& ) {
+         write_block_profile();
+      });
+   }
+
+   _transaction_admission.reset( new transaction_admission( *_chain_db, _options->count("admission-threads") ?
+                                                            _options->at("admission-threads").as<uint32_t>() : 2 ) );
+
    if( _options->count("force-validate") )
    {
       ilog( "All transaction signatures will be validated" );
@@ -447,6 +469,30 @@ void application_impl::startup()
    reset_websocket_tls_server();
 } FC_LOG_AND_RETHROW() }
 
+void application_impl::write_block_profile()
+{
+   const auto now = fc::time_point::now();
+   if( now - _last_block_profile_write < _block_profile_interval )
+      return;
+   _last_block_profile_write = now;
+
+   // Written next to the target and renamed, so that scrapers never see a partial file:
+   try
+   {
+      const fc::path tmp = _block_profile_file.generic_string() + ".tmp";
+      const std::string text = _chain_db->get_block_profiler().to_prometheus();
+      {
+         fc::ofstream out( tmp );
+         out.write( text.data(), text.size() );
+      }
+      fc::rename( tmp, _block_profile_file );
+   }
+   catch( const fc::exception& e )
+   {
+      wlog( "Unable to write block profile to ${f}: ${e}", ("f", _block_profile_file)("e", e.to_detail_string()) );
+   }
+}
+
 optional< api_access_info > application_impl::get_api_access_info(const string& username)const
 {
    optional< api_access_info > result;
@@ -563,7 +609,7 @@ void application_impl::handle_transaction(const graphene::net::trx_message& tran
       trx_count = 0;
    }
 
-   _chain_db->push_transaction( transaction_message.trx );
+   _transaction_admission->admit( transaction_message.trx );
 } FC_CAPTURE_AND_RETHROW( (transaction_message) ) }
 
 void application_impl::handle_message(const message& message_to_process)
@@ -939,6 +985,15 @@ void application::set_program_options(boost::program_options::options_descriptio
          ("api-access", bpo::value<boost::filesystem::path>(), "JSON file specifying API permissions")
          ("plugins", bpo::value<string>(), "Space-separated list of plugins to activate")
          ("io-threads", bpo::value<uint16_t>()->implicit_value(0), "Number of IO threads, default to 0 for auto-configuration")
+         ("block-profiler", bpo::value<bool>()->default_value(true),
+          "Collect per-stage block apply timings and per-operation latencies, exposed through metrics_api")
+         ("block-profiler-file", bpo::value<boost::filesystem::path>(),
+          "File to periodically write the block profiler metrics to, in the Prometheus text format")
+         ("block-profiler-interval", bpo::value<uint32_t>()->default_value(60),
+          "Seconds between writes of block-profiler-file")
+         ("admission-threads", bpo::value<uint32_t>()->default_value(2),
+          "Number of threads validating and recovering signatures of transactions received from the network, "
+          "0 to check them on the main thread")
          // TODO uncomment this when GUI is ready
          //("enable-subscribe-to-all", bpo::value<bool>()->implicit_value(false),
          // "Whether allow API clients to subscribe to universal object creation and removal events")
@@ -952,6 +1007,10 @@ void application::set_program_options(boost::program_options::options_descriptio
          ("replay-blockchain", "Rebuild object graph by replaying all blocks")
          ("resync-blockchain", "Delete all blocks and re-sync with network from scratch")
          ("force-validate", "Force validation of all transactions")
+         ("import-snapshot", bpo::value<boost::filesystem::path>(),
+          "Replace the chain state with a snapshot written by --export-snapshot and continue from its block")
+         ("export-snapshot", bpo::value<boost::filesystem::path>(),
+          "Write a snapshot of the chain state to this file once the database has been opened")
          ("genesis-timestamp", bpo::value<uint32_t>(),
           "Replace timestamp from genesis.json with current time plus this many seconds (experts only!)")
          ;
@@ -1050,6 +1109,21 @@ std::shared_ptr<chain::database> application::chain_database() const
    return my->_chain_db;
 }
 
+const fc::path& application::data_dir() const
+{
+   return my->_data_dir;
+}
+
+transaction_admission_stats application::get_transaction_admission_stats() const
+{
+   return my->_transaction_admission ? my->_transaction_admission->get_stats() : transaction_admission_stats();
+}
+
+std::shared_ptr<subscription_dispatcher> application::get_subscription_dispatcher() const
+{
+   return my->_subscription_dispatcher;
+}
+
 void application::set_block_production(bool producing_blocks)
 {
    my->_is_block_producer = producing_blocks;
@@ -3,6 +3,8 @@
 #include <fc/network/http/websocket.hpp>
 #include <graphene/app/application.hpp>
 #include <graphene/app/api_access.hpp>
+#include <graphene/app/subscription_dispatcher.hpp>
+#include <graphene/app/transaction_admission.hpp>
 #include <graphene/chain/genesis_state.hpp>
 #include <graphene/chain/protocol/types.hpp>
 #include <graphene/net/message.hpp>
@@ -30,7 +32,8 @@ class application_impl : public net::node_delegate
 
       explicit application_impl(application* self)
          : _self(self),
-           _chain_db(std::make_shared<chain::database>())
+           _chain_db(std::make_shared<chain::database>()),
+           _subscription_dispatcher(std::make_shared<subscription_dispatcher>(*_chain_db))
       {
       }
 
@@ -42,6 +45,9 @@ class application_impl : public net::node_delegate
 
       void startup();
 
+      /// Writes the block profiler metrics to --block-profiler-file, at most once per --block-profiler-interval.
+      void write_block_profile();
+
       fc::optional< api_access_info > get_api_access_info(const string& username)const;
 
       void set_api_access_info(const string& username, api_access_info&& permissions);
@@ -186,6 +192,7 @@ class application_impl : public net::node_delegate
       api_access _apiaccess;
 
       std::shared_ptr<graphene::chain::database>            _chain_db;
+      std::shared_ptr<subscription_dispatcher>              _subscription_dispatcher;
       std::shared_ptr<graphene::net::node>                  _p2p_network;
       std::shared_ptr<fc::http::websocket_server>      _websocket_server;
       std::shared_ptr<fc::http::websocket_tls_server>  _websocket_tls_server;
@@ -194,6 +201,13 @@ class application_impl : public net::node_delegate
       std::map<string, std::shared_ptr<abstract_plugin>> _available_plugins;
 
       bool _is_finished_syncing = false;
+
+      fc::path _block_profile_file;
+      fc::microseconds _block_profile_interval;
+      fc::time_point _last_block_profile_write;
+      boost::signals2::scoped_connection _block_profile_connection;
+
+      std::unique_ptr<transaction_admission> _transaction_admission;
    };
 
 }}} // namespace graphene namespace app namespace detail
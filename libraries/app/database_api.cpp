@@ -23,14 +23,16 @@
  */
 
 #include <graphene/app/database_api.hpp>
+#include <graphene/app/subscription_dispatcher.hpp>
 #include <graphene/chain/get_config.hpp>
 
 #include <graphene/chain/access_layer.hpp>
 #include <graphene/chain/das33_evaluator.hpp>
 #include <graphene/chain/withdrawal_limit_object.hpp>
 #include <graphene/chain/issued_asset_record_object.hpp>
-
-#include <fc/bloom_filter.hpp>
+#include <graphene/chain/queue_projection_index.hpp>
+#include <graphene/chain/limit_order_price_level_index.hpp>
+#include <graphene/chain/das33_pledge_aggregate_index.hpp>
 
 #include <fc/crypto/hex.hpp>
 #include <fc/uint128.hpp>
@@ -49,15 +51,14 @@
 
 namespace graphene { namespace app {
 
-typedef std::map< std::pair<graphene::chain::asset_id_type, graphene::chain::asset_id_type>, std::vector<fc::variant> > market_queue_type;
-
 class database_api_impl;
 
 
 class database_api_impl : public std::enable_shared_from_this<database_api_impl>
 {
    public:
-      explicit database_api_impl( graphene::chain::database& db, const application_options* app_options );
+      database_api_impl( graphene::chain::database& db, const application_options* app_options,
+                         std::shared_ptr<subscription_dispatcher> dispatcher );
       ~database_api_impl();
 
       // Objects
@@ -124,7 +125,8 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       vector<limit_order_object>         get_limit_orders_for_account(account_id_type id, asset_id_type a, asset_id_type b, uint32_t limit)const;
       template<typename T>
       using repack_function = std::function<void(std::vector<T>&, std::map<share_type, aggregated_limit_orders_with_same_price> &, bool)>;
-      template<typename T, typename Collection> T get_limit_orders_grouped_by_price(asset_id_type a, asset_id_type b, uint32_t limit, uint32_t precision, repack_function<Collection>)const;
+      template<typename T, typename Collection> T get_limit_orders_grouped_by_price(asset_id_type a, asset_id_type b, uint32_t max_groups, share_type group_divisor, uint32_t precision, repack_function<Collection>)const;
+      template<typename Iter> void collect_price_levels(Iter itr, Iter end, uint32_t max_groups, share_type group_divisor, std::map<share_type, aggregated_limit_orders_with_same_price>& helper_map)const;
       vector<call_order_object>          get_call_orders(asset_id_type a, uint32_t limit)const;
       vector<force_settlement_object>    get_settle_orders(asset_id_type a, uint32_t limit)const;
       vector<call_order_object>          get_margin_positions( const account_id_type& id )const;
@@ -196,6 +198,7 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       optional<cycle_price> calculate_cycle_price(share_type cycle_amount, asset_id_type asset_id) const;
 
       vector<dasc_holder> get_top_dasc_holders() const;
+      vector<dasc_holder> get_dasc_holders(uint32_t from, uint32_t limit) const;
 
       optional<withdrawal_limit> get_withdrawal_limit(account_id_type account, asset_id_type asset_id) const;
 
@@ -213,40 +216,27 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       vector<asset> get_amount_of_assets_pledged_to_project_in_phase(das33_project_id_type project, uint32_t phase) const;
       das33_project_tokens_amount get_amount_of_project_tokens_received_for_asset(das33_project_id_type project, asset to_pledge) const;
       das33_project_tokens_amount get_amount_of_asset_needed_for_project_token(das33_project_id_type project, asset_id_type asset_id, asset tokens) const;
+      const das33_pledge_aggregate_index& get_das33_pledge_aggregates() const;
 
       // Prices:
       vector<last_price_object> get_last_prices() const;
       vector<external_price_object> get_external_prices() const;
 
-      template<typename T>
-      void subscribe_to_item( const T& i )const
+      void subscribe_to_item( const object_id_type& id )const
       {
-         auto vec = fc::raw::pack(i);
-         if( !_subscribe_callback )
-            return;
-
-         if( !is_subscribed_to_item(i) )
-            _subscribe_filter.insert( vec.data(), vec.size() );
+         if( _subscribe_callback )
+            _dispatcher->subscribe_to_object( _dispatch_session, id );
       }
 
-      template<typename T>
-      bool is_subscribed_to_item( const T& i )const
+      template<uint8_t SpaceID, uint8_t TypeID, typename T>
+      void subscribe_to_item( const object_id<SpaceID,TypeID,T>& id )const
       {
-         if( !_subscribe_callback )
-            return false;
-
-         return _subscribe_filter.contains( i );
+         subscribe_to_item( object_id_type( id ) );
       }
 
-      bool is_impacted_account( const flat_set<account_id_type>& accounts)
-      {
-         if( !_subscribed_accounts.size() || !accounts.size() )
-            return false;
-
-         return std::any_of(accounts.begin(), accounts.end(), [this](const account_id_type& account) {
-            return _subscribed_accounts.find(account) != _subscribed_accounts.end();
-         });
-      }
+      /// Only changes of objects are notified, so keys, addresses and other items are not tracked.
+      template<typename T>
+      void subscribe_to_item( const T& )const {}
 
       // TODO: figure out some way to use copy.
       template<typename IndexType, typename IndexBy>
@@ -352,40 +342,18 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
          return result;
       }
 
-      template<typename T>
-      void enqueue_if_subscribed_to_market(const object* obj, market_queue_type& queue, bool full_object=true)
-      {
-         const T* order = dynamic_cast<const T*>(obj);
-         FC_ASSERT( order != nullptr);
-
-         auto market = order->get_market();
-
-         auto sub = _market_subscriptions.find( market );
-         if( sub != _market_subscriptions.end() ) {
-            queue[market].emplace_back( full_object ? obj->to_variant() : fc::variant(obj->id, 1) );
-         }
-      }
-
+      /** called by the subscription dispatcher with the changed objects this session is subscribed to */
       void broadcast_updates( const vector<variant>& updates );
       void broadcast_market_updates( const market_queue_type& queue);
-      void handle_object_changed(bool force_notify, bool full_object, const vector<object_id_type>& ids, const flat_set<account_id_type>& impacted_accounts, std::function<const object*(object_id_type id)> find_object);
-
-      /** called every time a block is applied to report the objects that were changed */
-      void on_objects_new(const vector<object_id_type>& ids, const flat_set<account_id_type>& impacted_accounts);
-      void on_objects_changed(const vector<object_id_type>& ids, const flat_set<account_id_type>& impacted_accounts);
-      void on_objects_removed(const vector<object_id_type>& ids, const vector<const object*>& objs, const flat_set<account_id_type>& impacted_accounts);
       void on_applied_block();
 
       bool _notify_remove_create = false;
-      mutable fc::bloom_filter _subscribe_filter;
-      std::set<account_id_type> _subscribed_accounts;
       std::function<void(const fc::variant&)> _subscribe_callback;
       std::function<void(const fc::variant&)> _pending_trx_callback;
       std::function<void(const fc::variant&)> _block_applied_callback;
 
-      boost::signals2::scoped_connection _new_connection;
-      boost::signals2::scoped_connection _change_connection;
-      boost::signals2::scoped_connection _removed_connection;
+      std::shared_ptr<subscription_dispatcher> _dispatcher;
+      subscription_dispatcher::session_id_type _dispatch_session;
       boost::signals2::scoped_connection _applied_block_connection;
       boost::signals2::scoped_connection _pending_trx_connection;
       map< pair<asset_id_type,asset_id_type>, std::function<void(const variant&)> > _market_subscriptions;
@@ -403,24 +371,21 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
 //                                                                  //
 //////////////////////////////////////////////////////////////////////
 
-database_api::database_api( graphene::chain::database& db, const application_options* app_options )
-   : my( new database_api_impl( db, app_options ) ) {}
+database_api::database_api( graphene::chain::database& db, const application_options* app_options,
+                            std::shared_ptr<subscription_dispatcher> dispatcher )
+   : my( new database_api_impl( db, app_options, std::move( dispatcher ) ) ) {}
 
 database_api::~database_api() {}
 
-database_api_impl::database_api_impl( graphene::chain::database& db, const application_options* app_options  )
-: _db(db), _dal(db), _app_options(app_options)
+database_api_impl::database_api_impl( graphene::chain::database& db, const application_options* app_options,
+                                      std::shared_ptr<subscription_dispatcher> dispatcher )
+: _dispatcher(std::move(dispatcher)), _db(db), _dal(db), _app_options(app_options)
 {
    wlog("creating database api ${x}", ("x",int64_t(this)) );
-   _new_connection = _db.new_objects.connect([this](const vector<object_id_type>& ids, const flat_set<account_id_type>& impacted_accounts) {
-                                             on_objects_new(ids, impacted_accounts);
-                                            });
-   _change_connection = _db.changed_objects.connect([this](const vector<object_id_type>& ids, const flat_set<account_id_type>& impacted_accounts) {
-                                on_objects_changed(ids, impacted_accounts);
-                                });
-   _removed_connection = _db.removed_objects.connect([this](const vector<object_id_type>& ids, const vector<const object*>& objs, const flat_set<account_id_type>& impacted_accounts) {
-                                                     on_objects_removed(ids, objs, impacted_accounts);
-                                                   });
+   if( !_dispatcher )
+      _dispatcher = std::make_shared<subscription_dispatcher>( _db );
+   _dispatch_session = _dispatcher->add_session( [this](const vector<variant>& updates) { broadcast_updates(updates); },
+                                                 [this](const market_queue_type& queue) { broadcast_market_updates(queue); } );
    _applied_block_connection = _db.applied_block.connect([this](const signed_block&){ on_applied_block(); });
 
    _pending_trx_connection = _db.on_pending_transaction.connect([this](const signed_transaction& trx ){
@@ -431,6 +396,7 @@ database_api_impl::database_api_impl( graphene::chain::database& db, const appli
 database_api_impl::~database_api_impl()
 {
    elog("freeing database api ${x}", ("x",int64_t(this)) );
+   _dispatcher->remove_session( _dispatch_session );
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -494,14 +460,7 @@ void database_api_impl::set_subscribe_callback( std::function<void(const variant
 
    _subscribe_callback = cb;
    _notify_remove_create = notify_remove_create;
-   _subscribed_accounts.clear();
-
-   static fc::bloom_parameters param;
-   param.projected_element_count    = 10000;
-   param.false_positive_probability = 1.0/100;
-   param.maximum_size = 1024*8*8*2;
-   param.compute_optimal_parameters();
-   _subscribe_filter = fc::bloom_filter(param);
+   _dispatcher->reset_session( _dispatch_session, _subscribe_callback && notify_remove_create );
 }
 
 void database_api::set_pending_transaction_callback( std::function<void(const variant&)> cb )
@@ -533,6 +492,7 @@ void database_api_impl::cancel_all_subscriptions()
 {
    set_subscribe_callback( std::function<void(const fc::variant&)>(), true);
    _market_subscriptions.clear();
+   _dispatcher->unsubscribe_from_markets( _dispatch_session );
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -686,22 +646,12 @@ optional<total_cycles_res> database_api::get_total_cycles() const {
 }
 
 optional<total_cycles_res> database_api_impl::get_total_cycles() const {
-    total_cycles_res result;
-    const auto& accounts = _db.get_index_type<account_index>().indices().get<by_id>();
-
-    for (const account_object& acc : accounts)
-    {
-        if (acc.is_vault())
-        {
-            optional<total_cycles_res> vaultCycles = _dal.get_total_cycles(acc.get_id());
-            if (vaultCycles.valid())
-            {
-                result.total_cycles += vaultCycles->total_cycles;
-                result.total_dascoin += vaultCycles->total_dascoin;
-            }
-        }
-    }
-    return result;
+    const auto& idx = _db.get_index_type<account_index>();
+    const auto& aidx = dynamic_cast<const primary_index<account_index>&>(idx);
+    const auto& projection = aidx.get_secondary_index<graphene::chain::queue_projection_index>();
+    FC_ASSERT( projection.get_excluded_vaults().empty(), "Queue projection could not be calculated for vaults ${v}",
+               ("v", projection.get_excluded_vaults()) );
+    return projection.get_total_cycles();
 }
 
 optional<queue_projection_res> database_api::get_queue_projection() const {
@@ -709,21 +659,12 @@ optional<queue_projection_res> database_api::get_queue_projection() const {
 }
 
 optional<queue_projection_res> database_api_impl::get_queue_projection() const {
-    queue_projection_res result;
-    const auto& accounts = _db.get_index_type<account_index>().indices().get<by_id>();
-
-    for (const account_object& acc : accounts)
-    {
-        if (acc.is_vault())
-        {
-            optional<queue_projection_res> vaultQueue = _dal.get_queue_state_for_account(acc.get_id());
-            if (vaultQueue.valid())
-            {
-                result = result + *vaultQueue;
-            }
-        }
-    }
-    return result;
+    const auto& idx = _db.get_index_type<account_index>();
+    const auto& aidx = dynamic_cast<const primary_index<account_index>&>(idx);
+    const auto& projection = aidx.get_secondary_index<graphene::chain::queue_projection_index>();
+    FC_ASSERT( projection.get_excluded_vaults().empty(), "Queue projection could not be calculated for vaults ${v}",
+               ("v", projection.get_excluded_vaults()) );
+    return projection.get_queue_projection();
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -849,10 +790,8 @@ std::map<std::string, full_account> database_api_impl::get_full_accounts( const
 
       if( subscribe )
       {
-         if(_subscribed_accounts.size() < 100) {
-            _subscribed_accounts.insert( account->get_id() );
+         if( _subscribe_callback && _dispatcher->subscribe_to_account( _dispatch_session, account->get_id() ) )
             subscribe_to_item( account->id );
-         }
       }
 
       // fc::mutable_variant_object full_account;
@@ -1340,12 +1279,12 @@ vector<limit_order_object> database_api_impl::get_limit_orders_for_account(accou
 
 limit_orders_grouped_by_price database_api::get_limit_orders_grouped_by_price(asset_id_type a, asset_id_type b, uint32_t limit)const
 {
-   return my->get_limit_orders_grouped_by_price<limit_orders_grouped_by_price, aggregated_limit_orders_with_same_price>( a, b, limit, ORDER_BOOK_QUERY_PRECISION, std::bind(&database_api::repack<aggregated_limit_orders_with_same_price>, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, limit) );
+   return my->get_limit_orders_grouped_by_price<limit_orders_grouped_by_price, aggregated_limit_orders_with_same_price>( a, b, limit, 1, ORDER_BOOK_QUERY_PRECISION, std::bind(&database_api::repack<aggregated_limit_orders_with_same_price>, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, limit) );
 }
 
 limit_orders_grouped_by_price database_api::get_limit_orders_grouped_by_price_with_precision(asset_id_type a, asset_id_type b, uint32_t limit, uint32_t precision)const
 {
-   return my->get_limit_orders_grouped_by_price<limit_orders_grouped_by_price, aggregated_limit_orders_with_same_price>( a, b, limit, asset::scaled_precision(precision).value, std::bind(&database_api::repack<aggregated_limit_orders_with_same_price>, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, limit) );
+   return my->get_limit_orders_grouped_by_price<limit_orders_grouped_by_price, aggregated_limit_orders_with_same_price>( a, b, limit, 1, asset::scaled_precision(precision).value, std::bind(&database_api::repack<aggregated_limit_orders_with_same_price>, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3, limit) );
 }
 
 template<typename T>
@@ -1374,10 +1313,40 @@ void database_api::repack(std::vector<T>& ret, std::map<share_type, aggregated_l
    }
 }
 
-template<typename T, typename Collection> T database_api_impl::get_limit_orders_grouped_by_price(asset_id_type base, asset_id_type quote, uint32_t limit, uint32_t precision, repack_function<Collection> repack)const
+/**
+ * Copies price levels into @p helper_map until @p max_groups groups of levels (levels with the same price divided by
+ * @p group_divisor) have been collected, or all of them if @p max_groups is 0.
+ */
+template<typename Iter>
+void database_api_impl::collect_price_levels(Iter itr, Iter end, uint32_t max_groups, share_type group_divisor, std::map<share_type, aggregated_limit_orders_with_same_price>& helper_map)const
+{
+   uint32_t groups = 0;
+   share_type last_group;
+   for( ; itr != end; ++itr )
+   {
+      const share_type group = itr->first / group_divisor;
+      if( groups == 0 || group != last_group )
+      {
+         if( max_groups != 0 && groups == max_groups )
+            break;
+         ++groups;
+         last_group = group;
+      }
+
+      aggregated_limit_orders_with_same_price& alo = helper_map[itr->first];
+      alo.price = itr->first;
+      alo.base_volume = itr->second.base_volume;
+      alo.quote_volume = itr->second.quote_volume;
+      alo.count = itr->second.count;
+   }
+}
+
+template<typename T, typename Collection> T database_api_impl::get_limit_orders_grouped_by_price(asset_id_type base, asset_id_type quote, uint32_t max_groups, share_type group_divisor, uint32_t precision, repack_function<Collection> repack)const
 {
    const auto& limit_order_idx = _db.get_index_type<limit_order_index>();
    const auto& limit_price_idx = limit_order_idx.indices().get<by_price>();
+   const auto& price_levels = dynamic_cast<const primary_index<limit_order_index>&>(limit_order_idx)
+                                 .get_secondary_index<graphene::chain::limit_order_price_level_index>();
 
    T result;
    bool swap_buy_sell = false;
@@ -1387,9 +1356,24 @@ template<typename T, typename Collection> T database_api_impl::get_limit_orders_
       swap_buy_sell = true;
    }
 
-   auto func = [this, &limit_price_idx, limit, precision, repack](asset_id_type& a, asset_id_type& b, std::vector<Collection>& ret, bool ascending){
+   auto func = [this, &limit_price_idx, &price_levels, max_groups, group_divisor, precision, repack](asset_id_type& a, asset_id_type& b, std::vector<Collection>& ret, bool ascending){
       std::map<share_type, aggregated_limit_orders_with_same_price> helper_map;
 
+      // Levels at the default precision are maintained by the price level index, only the requested ones are copied:
+      if(precision == ORDER_BOOK_QUERY_PRECISION)
+      {
+         const auto* levels = price_levels.get_levels(a, b, ascending);
+         if(levels != nullptr)
+         {
+            if(ascending)
+               collect_price_levels(levels->begin(), levels->end(), max_groups, group_divisor, helper_map);
+            else
+               collect_price_levels(levels->rbegin(), levels->rend(), max_groups, group_divisor, helper_map);
+         }
+         repack(ret, helper_map, ascending);
+         return;
+      }
+
       auto limit_itr = limit_price_idx.lower_bound(price::max(a, b));
       auto limit_end = limit_price_idx.upper_bound(price::min(a, b));
 
@@ -1458,7 +1442,7 @@ limit_orders_collection_grouped_by_price database_api::get_limit_orders_collecti
          my->func_re_pack(helper_map.rbegin(), helper_map.rend(), ret, limit_group, limit_per_group);
       }
    };
-   return my->get_limit_orders_grouped_by_price<limit_orders_collection_grouped_by_price, aggregated_limit_orders_with_same_price_collection>( a, b, 0, ORDER_BOOK_QUERY_PRECISION, f );
+   return my->get_limit_orders_grouped_by_price<limit_orders_collection_grouped_by_price, aggregated_limit_orders_with_same_price_collection>( a, b, limit_group, ORDER_BOOK_GROUP_QUERY_PRECISION_DIFF, ORDER_BOOK_QUERY_PRECISION, f );
 }
 
 template<typename Iter>
@@ -1576,6 +1560,7 @@ void database_api_impl::subscribe_to_market(std::function<void(const variant&)>
    if(a > b) std::swap(a,b);
    FC_ASSERT(a != b);
    _market_subscriptions[ std::make_pair(a,b) ] = callback;
+   _dispatcher->subscribe_to_market( _dispatch_session, std::make_pair(a,b) );
 }
 
 void database_api::unsubscribe_from_market(asset_id_type a, asset_id_type b)
@@ -1588,6 +1573,7 @@ void database_api_impl::unsubscribe_from_market(asset_id_type a, asset_id_type b
    if(a > b) std::swap(a,b);
    FC_ASSERT(a != b);
    _market_subscriptions.erase(std::make_pair(a,b));
+   _dispatcher->unsubscribe_from_market( _dispatch_session, std::make_pair(a,b) );
 }
 
 market_ticker database_api::get_ticker( const string& base, const string& quote )const
@@ -2807,38 +2793,35 @@ vector<dasc_holder> database_api::get_top_dasc_holders() const
 vector<dasc_holder> database_api_impl::get_top_dasc_holders() const
 {
     static const uint32_t max_holders = 100;
-    vector<dasc_holder> tmp;
-    const auto& dasc_id = _db.get_dascoin_asset_id();
-    const auto& idx = _db.get_index_type<account_index>().indices().get<by_id>();
-    for ( auto it = idx.cbegin(); it != idx.cend(); ++it )
+    return get_dasc_holders(0, max_holders);
+}
+
+vector<dasc_holder> database_api::get_dasc_holders(uint32_t from, uint32_t limit) const
+{
+    return my->get_dasc_holders(from, limit);
+}
+
+vector<dasc_holder> database_api_impl::get_dasc_holders(uint32_t from, uint32_t limit) const
+{
+    FC_ASSERT( limit <= 100 );
+    const auto& idx = _db.get_index_type<account_index>();
+    const auto& aidx = dynamic_cast<const primary_index<account_index>&>(idx);
+    const auto& ranking = aidx.get_secondary_index<graphene::chain::dasc_holder_index>().get_ranking();
+
+    vector<dasc_holder> ret;
+    if ( from >= ranking.size() )
+        return ret;
+    ret.reserve(std::min<size_t>(limit, ranking.size() - from));
+
+    for ( auto it = ranking.nth(from); it != ranking.end() && ret.size() < limit; ++it )
     {
-        const auto& account = *it;
+        const auto& account = it->holder(_db);
         dasc_holder holder;
-        holder.holder = account.id;
-        if (account.kind == account_kind::wallet)
-        {
-            holder.vaults = account.vault.size();
-            const auto& balance_obj = _db.get_balance_object(account.id, dasc_id);
-            holder.amount = balance_obj.balance + balance_obj.reserved;
-            std::for_each(account.vault.begin(), account.vault.end(), [this, &holder, &dasc_id](const account_id_type& vault_id) {
-                const auto& balance_obj = _db.get_balance_object(vault_id, dasc_id);
-                holder.amount += balance_obj.balance;
-            });
-            tmp.emplace_back(holder);
-        }
-        else if (account.kind == account_kind::custodian || (account.kind == account_kind::vault && account.parents.empty()))
-        {
-            holder.vaults = 0;
-            const auto& balance_obj = _db.get_balance_object(account.id, dasc_id);
-            holder.amount = balance_obj.balance;
-            tmp.emplace_back(holder);
-        }
+        holder.holder = it->holder;
+        holder.vaults = account.is_wallet() ? account.vault.size() : 0;
+        holder.amount = it->amount;
+        ret.emplace_back(holder);
     }
-
-    std::partial_sort(tmp.begin(), tmp.begin() + max_holders, tmp.end(), [](dasc_holder& a, dasc_holder& b) {
-        return a.amount > b.amount;
-    });
-    vector<dasc_holder> ret(tmp.begin(), tmp.begin() + max_holders);
     return ret;
 }
 
@@ -2993,6 +2976,13 @@ vector<das33_pledge_holder_object> database_api_impl::get_das33_pledges(das33_pl
     return result;
 }
 
+const das33_pledge_aggregate_index& database_api_impl::get_das33_pledge_aggregates() const
+{
+    const auto& idx = _db.get_index_type<das33_pledge_holder_index>();
+    const auto& pidx = dynamic_cast<const primary_index<das33_pledge_holder_index>&>(idx);
+    return pidx.get_secondary_index<graphene::chain::das33_pledge_aggregate_index>();
+}
+
 das33_pledges_by_account_result database_api_impl::get_das33_pledges_by_account(account_id_type account) const
 {
     vector<das33_pledge_holder_object> pledges;
@@ -3002,39 +2992,15 @@ das33_pledges_by_account_result database_api_impl::get_das33_pledges_by_account(
     const auto& idx = _db.get_index_type<das33_pledge_holder_index>().indices().get<by_user>().equal_range(account);
     std::copy(idx.first, idx.second, std::back_inserter(pledges));
 
-    map<das33_project_id_type, share_type> last_round_number;
-    for (u_int i = 0; i < pledges.size(); i++)
-    {
-      das33_project_id_type project_id = pledges[i].project_id;
-      share_type round_number = pledges[i].phase_number;
-      if (total.find(project_id) != total.end())
-      {
-         total[project_id] = total[project_id] + pledges[i].base_expected.amount + pledges[i].bonus_expected.amount;
-      }
-      else
-      {
-        total[project_id] = pledges[i].base_expected.amount + pledges[i].bonus_expected.amount;
-      }
-      if (last_round_number.find(project_id) != last_round_number.end())
-      {
-        if (last_round_number[project_id] < round_number)
-          last_round_number[project_id] = round_number;
-      }
-      else
-      {
-          last_round_number[project_id] = round_number;
-      }
-    }
-    for (u_int j = 0; j < pledges.size(); j++)
+    // Totals are kept by project and phase, so the last phase of a project is its last entry:
+    const auto* totals = get_das33_pledge_aggregates().get_account_totals(account);
+    if (totals)
     {
-      das33_project_id_type project_id = pledges[j].project_id;
-      share_type round_number = pledges[j].phase_number;
-      if (round_number == last_round_number[project_id])
+      for (const auto& entry : *totals)
       {
-        if (last_round.find(project_id) != last_round.end())
-          last_round[project_id] = last_round[project_id] + pledges[j].base_expected.amount;
-        else
-          last_round[project_id] = pledges[j].base_expected.amount;
+        const das33_project_id_type project_id = entry.first.first;
+        total[project_id] += entry.second.base_expected + entry.second.bonus_expected;
+        last_round[project_id] = entry.second.base_expected;
       }
     }
 
@@ -3101,25 +3067,12 @@ vector<asset> database_api::get_amount_of_assets_pledged_to_project(das33_projec
 vector<asset> database_api_impl::get_amount_of_assets_pledged_to_project(das33_project_id_type project) const
 {
   vector<asset> result;
-  map<asset_id_type, int> index_map;
 
-  auto default_pledge_id = das33_pledge_holder_id_type();
-
-  const auto& pledges = _db.get_index_type<das33_pledge_holder_index>().indices().get<by_project>();
-  for( auto itr = pledges.lower_bound(project); itr != pledges.upper_bound(project); ++itr )
+  const auto* totals = get_das33_pledge_aggregates().get_project_totals(project);
+  if (totals)
   {
-   if (itr->id != default_pledge_id)
-   {
-     if (index_map.find(itr->pledged.asset_id) != index_map.end())
-     {
-       result[index_map[itr->pledged.asset_id]] += itr->pledged;
-     }
-     else
-     {
-       index_map[itr->pledged.asset_id] = result.size();
-       result.emplace_back(itr->pledged);
-     }
-   }
+    for (const auto& pledged : totals->pledged)
+      result.emplace_back(pledged.second.amount, pledged.first);
   }
 
   return result;
@@ -3133,7 +3086,6 @@ vector<asset> database_api::get_amount_of_assets_pledged_to_project_in_phase(das
 vector<asset> database_api_impl::get_amount_of_assets_pledged_to_project_in_phase(das33_project_id_type project, uint32_t phase) const
 {
     vector<asset> result;
-    map<asset_id_type, int> index_map;
 
     // Get project
     const auto& idx = _db.get_index_type<das33_project_index>().indices().get<by_id>();
@@ -3141,27 +3093,19 @@ vector<asset> database_api_impl::get_amount_of_assets_pledged_to_project_in_phas
     auto project_object = &(*project_iterator);
     result.emplace_back(asset{0, project_object->token_id});
     result.emplace_back(asset{0, project_object->token_id});
-    index_map[project_object->token_id] = 0;
-
-    auto default_pledge_id = das33_pledge_holder_id_type();
 
-    const auto& pledges = _db.get_index_type<das33_pledge_holder_index>().indices().get<by_project>();
-    for( auto itr = pledges.lower_bound(project); itr != pledges.upper_bound(project); ++itr )
+    const auto* totals = get_das33_pledge_aggregates().get_phase_totals(project, phase);
+    if (totals)
     {
-        if (itr->id != default_pledge_id && itr->phase_number == phase)
+        for (const auto& pledged : totals->pledged)
         {
-            if (index_map.find(itr->pledged.asset_id) != index_map.end())
-            {
-                result[index_map[itr->pledged.asset_id]] += itr->pledged;
-            }
+            if (pledged.first == project_object->token_id)
+                result[0].amount += pledged.second.amount;
             else
-            {
-                index_map[itr->pledged.asset_id] = result.size();
-                result.emplace_back(itr->pledged);
-            }
-            result[index_map[project_object->token_id]] += (itr->base_expected + itr->bonus_expected);
-            result[1] += itr->base_expected;// * project_object->token_price;
+                result.emplace_back(pledged.second.amount, pledged.first);
         }
+        result[0].amount += totals->base_expected + totals->bonus_expected;
+        result[1].amount += totals->base_expected;
     }
 
     result[1] = result[1] * project_object->token_price;
@@ -3292,83 +3236,6 @@ void database_api_impl::broadcast_market_updates( const market_queue_type& queue
    }
 }
 
-void database_api_impl::on_objects_removed( const vector<object_id_type>& ids, const vector<const object*>& objs, const flat_set<account_id_type>& impacted_accounts )
-{
-   handle_object_changed(_notify_remove_create, false, ids, impacted_accounts, 
-      [objs](object_id_type id) -> const object* {
-         auto it = std::find_if(objs.begin(), objs.end(), [id](const object* o) {return o != nullptr && o->id == id;});
-         if (it != objs.end())
-         {
-            return *it;
-         }
-         return nullptr;
-   });
-}
-
-void database_api_impl::on_objects_new(const vector<object_id_type>& ids, const flat_set<account_id_type>& impacted_accounts)
-{
-   handle_object_changed(_notify_remove_create, true, ids, impacted_accounts,
-      std::bind(&object_database::find_object, &_db, std::placeholders::_1)
-   );
-}
-
-void database_api_impl::on_objects_changed(const vector<object_id_type>& ids, const flat_set<account_id_type>& impacted_accounts)
-{
-   handle_object_changed(false, true, ids, impacted_accounts,
-      std::bind(&object_database::find_object, &_db, std::placeholders::_1)
-   );
-}
-
-void database_api_impl::handle_object_changed(bool force_notify, bool full_object, const vector<object_id_type>& ids, const flat_set<account_id_type>& impacted_accounts, std::function<const object*(object_id_type id)> find_object)
-{
-   if( _subscribe_callback )
-   {
-      vector<variant> updates;
-
-      for(auto id : ids)
-      {
-         const object* obj = nullptr;
-         if( force_notify || is_subscribed_to_item(id) || is_impacted_account(impacted_accounts) )
-         {
-            if ( full_object )
-            {
-               obj = find_object(id);
-               if( obj )
-               {
-                  updates.emplace_back( obj->to_variant() );
-               }
-            }
-            else
-            {
-               updates.emplace_back( fc::variant( id, 1 ) );
-            }
-         }
-      }
-
-      if( updates.size() )
-         broadcast_updates(updates);
-   }
-   if( _market_subscriptions.size() )
-   {
-      market_queue_type broadcast_queue;
-
-      for(auto id : ids)
-      {
-         if( id.is<call_order_object>() )
-         {
-            enqueue_if_subscribed_to_market<call_order_object>( find_object(id), broadcast_queue, full_object );
-         }
-         else if( id.is<limit_order_object>() )
-         {
-            enqueue_if_subscribed_to_market<limit_order_object>( find_object(id), broadcast_queue, full_object );
-         }
-      }
-
-      if( broadcast_queue.size() )
-         broadcast_market_updates(broadcast_queue);
-   }
-}
-
 /** note: this method cannot yield because it is called in the middle of
  * apply a block.
  */
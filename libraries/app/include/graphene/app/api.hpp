@@ -24,6 +24,8 @@
 #pragma once
 
 #include <graphene/app/database_api.hpp>
+#include <graphene/app/subscription_dispatcher.hpp>
+#include <graphene/app/transaction_admission.hpp>
 
 #include <graphene/chain/protocol/types.hpp>
 #include <graphene/chain/protocol/confidential.hpp>
@@ -46,6 +48,10 @@
 #include <string>
 #include <vector>
 
+namespace graphene { namespace account_history {
+   class account_history_store;
+} }
+
 namespace graphene { namespace app {
    using namespace graphene::chain;
    using namespace graphene::market_history;
@@ -140,10 +146,19 @@ namespace graphene { namespace app {
 
       protected:
          vector<operation_history_object> get_account_history_impl(account_id_type account,
-                                                                   const std::function<bool(const account_transaction_history_object* node)> &selector,
+                                                                   const std::function<bool(const operation_history_object& op)> &selector,
                                                                    operation_history_id_type stop = operation_history_id_type(),
                                                                    unsigned limit = 100,
                                                                    operation_history_id_type start = operation_history_id_type())const;
+         /// Like get_account_history_impl(), but only walks the history of the given operation types when it is indexed by type
+         vector<operation_history_object> get_account_history_of_types(account_id_type account,
+                                                                       const flat_set<uint32_t>& operation_types,
+                                                                       const std::function<bool(const operation_history_object& op)> &selector,
+                                                                       operation_history_id_type stop,
+                                                                       unsigned limit,
+                                                                       operation_history_id_type start)const;
+         /// The on-disk store of the account_history plugin, null if history is only kept in the object database
+         const account_history::account_history_store* history_store()const;
 
       private:
          application& _app;
@@ -247,10 +262,55 @@ namespace graphene { namespace app {
           */
          std::vector<net::potential_peer_record> get_potential_peers() const;
 
+         /**
+          * @brief Get counters of blocks relayed as compact blocks and of their transactions
+          */
+         net::compact_block_relay_stats get_compact_block_relay_stats() const;
+
       private:
          application& _app;
    };
    
+   /**
+    * @brief The metrics_api class exposes the block apply profiler of the node.
+    *
+    * It only reads metrics. Collection is turned on or off with the block-profiler node option, and the counters
+    * accumulate from the start of the node, as Prometheus counters do.
+    */
+   class metrics_api
+   {
+      public:
+         metrics_api(application& a);
+
+         /**
+          * @brief Return per-stage block apply timings and per-operation-type latencies
+          */
+         chain::block_profile get_block_profile() const;
+
+         /**
+          * @brief Return the same metrics in the Prometheus text exposition format
+          */
+         string get_block_profile_text() const;
+
+         /**
+          * @brief Return counters of transactions received from the network, by the check which rejected them
+          */
+         transaction_admission_stats get_transaction_admission_stats() const;
+
+         /**
+          * @brief Return the per-block cost of serializing changed objects and handing them to API subscribers
+          */
+         subscription_dispatch_stats get_subscription_dispatch_stats() const;
+
+         /**
+          * @brief Return the number of objects saved into undo states while applying the last block
+          */
+         db::undo_stats get_undo_stats() const;
+
+      private:
+         application& _app;
+   };
+
    class crypto_api
    {
       public:
@@ -310,6 +370,8 @@ namespace graphene { namespace app {
          fc::api<network_node_api> network_node()const;
          /// @brief Retrieve the cryptography API
          fc::api<crypto_api> crypto()const;
+         /// @brief Retrieve the metrics API
+         fc::api<metrics_api> metrics()const;
          /// @brief Retrieve the debug API (if available)
          fc::api<graphene::debug_witness::debug_api> debug()const;
 
@@ -323,6 +385,7 @@ namespace graphene { namespace app {
          optional< fc::api<network_node_api> > _network_node_api;
          optional< fc::api<history_api> >  _history_api;
          optional< fc::api<crypto_api> > _crypto_api;
+         optional< fc::api<metrics_api> > _metrics_api;
          optional< fc::api<graphene::debug_witness::debug_api> > _debug_api;
    };
 
@@ -359,6 +422,14 @@ FC_API(graphene::app::network_node_api,
        (get_potential_peers)
        (get_advanced_node_parameters)
        (set_advanced_node_parameters)
+       (get_compact_block_relay_stats)
+     )
+FC_API(graphene::app::metrics_api,
+       (get_block_profile)
+       (get_block_profile_text)
+       (get_transaction_admission_stats)
+       (get_subscription_dispatch_stats)
+       (get_undo_stats)
      )
 FC_API(graphene::app::crypto_api,
        (blind_sum)
@@ -375,5 +446,6 @@ FC_API(graphene::app::login_api,
        (history)
        (network_node)
        (crypto)
+       (metrics)
        (debug)
      )
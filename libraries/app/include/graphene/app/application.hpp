@@ -24,6 +24,7 @@
 #pragma once
 
 #include <graphene/app/api_access.hpp>
+#include <graphene/app/transaction_admission.hpp>
 #include <graphene/net/node.hpp>
 #include <graphene/chain/database.hpp>
 
@@ -31,6 +32,7 @@
 
 namespace graphene { namespace app {
    namespace detail { class application_impl; }
+   class subscription_dispatcher;
    using std::string;
 
    class abstract_plugin;
@@ -88,6 +90,12 @@ namespace graphene { namespace app {
 
          net::node_ptr                    p2p_node();
          std::shared_ptr<chain::database> chain_database()const;
+         /// Directory given to initialize(), plugins keep their files below it.
+         const fc::path&                  data_dir()const;
+         /// Counters of transactions received from the network, see @ref transaction_admission.
+         transaction_admission_stats      get_transaction_admission_stats()const;
+         /// Shared by the @ref database_api sessions of this application.
+         std::shared_ptr<subscription_dispatcher> get_subscription_dispatcher()const;
 
          void set_block_production(bool producing_blocks);
          fc::optional< api_access_info > get_api_access_info( const string& username )const;
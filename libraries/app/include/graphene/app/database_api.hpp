@@ -72,6 +72,7 @@ using namespace graphene::market_history;
 using namespace std;
 
 class database_api_impl;
+class subscription_dispatcher;
 
 struct order
 {
@@ -208,7 +209,9 @@ struct withdrawal_limit
 class database_api
 {
    public:
-      database_api( graphene::chain::database& db, const application_options* app_options );
+      /// Without a @p dispatcher the API connects its own one to @p db.
+      database_api( graphene::chain::database& db, const application_options* app_options,
+                    std::shared_ptr<subscription_dispatcher> dispatcher = nullptr );
       ~database_api();
 
       /////////////
@@ -951,6 +954,14 @@ class database_api
        */
       vector<dasc_holder> get_top_dasc_holders() const;
 
+      /**
+       * @brief Return a page of dascoin holders, ordered by the amount they hold (descending).
+       * @param from Position of the first holder to return, 0 being the largest holder
+       * @param limit Maximum number of holders to return, at most 100
+       * @return Vector of dasc_holder objects.
+       */
+      vector<dasc_holder> get_dasc_holders(uint32_t from, uint32_t limit) const;
+
       optional<withdrawal_limit> get_withdrawal_limit(account_id_type account, asset_id_type asset_id) const;
 
       //////////////////////////
@@ -1228,6 +1239,7 @@ FC_API( graphene::app::database_api,
 
    // Top dascoin holders
    (get_top_dasc_holders)
+   (get_dasc_holders)
 
    (get_withdrawal_limit)
 
@@ -0,0 +1,138 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <graphene/chain/block_profiler.hpp>
+#include <graphene/chain/database.hpp>
+
+#include <fc/reflect/reflect.hpp>
+
+#include <boost/signals2/connection.hpp>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace graphene { namespace app {
+
+typedef std::pair<chain::asset_id_type, chain::asset_id_type> market_type;
+typedef std::map< market_type, std::vector<fc::variant> > market_queue_type;
+
+/**
+ * Counters of the object updates sent to API subscribers, timings are per block.
+ */
+struct subscription_dispatch_stats
+{
+   uint64_t                   blocks = 0;
+   uint64_t                   objects_serialized = 0;  ///< a changed object is serialized once for all its subscribers
+   uint64_t                   updates_dispatched = 0;  ///< object updates handed to sessions
+   chain::latency_histogram   serialization;
+   chain::latency_histogram   dispatch;
+};
+
+/**
+ * @brief Hands the objects changed by a block to the API sessions subscribed to them.
+ *
+ * The application owns one dispatcher, shared by all its @ref database_api sessions, and only it is connected to the
+ * database's change signals. Subscriptions are indexed by object id, account id and market, so the cost of a block
+ * depends on the changed objects and the matching subscriptions rather than on the number of sessions, and each changed
+ * object is serialized once however many sessions receive it.
+ *
+ * Must only be used on the thread which owns the database.
+ */
+class subscription_dispatcher
+{
+   public:
+      typedef uint64_t session_id_type;
+      typedef std::function<void(const std::vector<fc::variant>&)> update_handler;
+      typedef std::function<void(const market_queue_type&)> market_update_handler;
+
+      /// Limits which keep the memory used by a single session bounded.
+      static const size_t max_object_subscriptions = 10000;
+      static const size_t max_account_subscriptions = 100;
+
+      explicit subscription_dispatcher( chain::database& db );
+      ~subscription_dispatcher();
+
+      session_id_type add_session( update_handler on_updates, market_update_handler on_market_updates );
+      void remove_session( session_id_type session );
+
+      /**
+       * Drops the object and account subscriptions of a session. With @p notify_remove_create the session receives all
+       * created and removed objects.
+       */
+      void reset_session( session_id_type session, bool notify_remove_create );
+      void subscribe_to_object( session_id_type session, chain::object_id_type id );
+      /// Returns false if the session already has @ref max_account_subscriptions accounts.
+      bool subscribe_to_account( session_id_type session, chain::account_id_type account );
+      void subscribe_to_market( session_id_type session, const market_type& market );
+      void unsubscribe_from_market( session_id_type session, const market_type& market );
+      void unsubscribe_from_markets( session_id_type session );
+
+      const subscription_dispatch_stats& get_stats()const { return _stats; }
+
+   private:
+      struct session_subscriptions
+      {
+         update_handler                                  on_updates;
+         market_update_handler                           on_market_updates;
+         bool                                            notify_remove_create = false;
+         std::unordered_set<chain::object_id_type>       objects;
+         fc::flat_set<chain::account_id_type>            accounts;
+         fc::flat_set<market_type>                       markets;
+      };
+
+      void on_objects( const std::vector<chain::object_id_type>& ids, const fc::flat_set<chain::account_id_type>& impacted_accounts,
+                       bool created_or_removed, bool full_object,
+                       const std::function<const chain::object*(chain::object_id_type)>& find_object );
+      void finish_block();
+      /// Impacted accounts are only computed by the database while a session is subscribed to an account.
+      void update_impacted_accounts_requirement();
+
+      chain::database&                                                           _db;
+      session_id_type                                                            _next_session = 0;
+      std::map<session_id_type, session_subscriptions>                           _sessions;
+      std::unordered_map<chain::object_id_type, fc::flat_set<session_id_type>>  _object_subscribers;
+      std::map<chain::account_id_type, fc::flat_set<session_id_type>>            _account_subscribers;
+      std::map<market_type, fc::flat_set<session_id_type>>                       _market_subscribers;
+      fc::flat_set<session_id_type>                                              _notify_remove_create_sessions;
+      bool                                                                       _requires_impacted_accounts = false;
+
+      uint64_t                                                                   _block_serialization_us = 0;
+      uint64_t                                                                   _block_dispatch_us = 0;
+      subscription_dispatch_stats                                                _stats;
+
+      boost::signals2::scoped_connection                                         _new_connection;
+      boost::signals2::scoped_connection                                         _change_connection;
+      boost::signals2::scoped_connection                                         _removed_connection;
+};
+
+} } // graphene::app
+
+FC_REFLECT( graphene::app::subscription_dispatch_stats,
+            (blocks)(objects_serialized)(updates_dispatched)(serialization)(dispatch) )
@@ -0,0 +1,95 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <graphene/chain/database.hpp>
+
+#include <fc/reflect/reflect.hpp>
+#include <fc/thread/thread.hpp>
+
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace graphene { namespace app {
+
+/**
+ * Counters of transactions received from the network, rejected ones are counted by the check which rejected them.
+ */
+struct transaction_admission_stats
+{
+   uint64_t received = 0;
+   uint64_t admitted = 0;
+   uint64_t rejected_invalid = 0;        ///< failed trx.validate()
+   uint64_t rejected_signatures = 0;     ///< signatures could not be recovered
+   uint64_t rejected_duplicate = 0;      ///< already in the pending state or in a recent block
+   uint64_t rejected_tapos = 0;
+   uint64_t rejected_expiration = 0;
+   uint64_t rejected_apply = 0;          ///< failed when applied to the pending state
+};
+
+/**
+ * @brief Checks transactions received from the network before they are applied to the pending state.
+ *
+ * Validation, hashing and signature recovery do not depend on the chain state and run on a pool of worker threads.
+ * The cheap checks which read the chain state (duplicates, TaPoS and expiration) then run on the calling thread, and
+ * only transactions which pass all of them are pushed to the database, which does not repeat the work done by the
+ * workers. Transactions are pushed in the order they were received, whichever worker finishes first.
+ */
+class transaction_admission
+{
+   public:
+      /// With no workers the stateless checks run on the calling thread.
+      transaction_admission( chain::database& db, uint32_t worker_count );
+      ~transaction_admission();
+
+      /**
+       * Must be called on the thread which owns the database.
+       * @throws fc::exception if the transaction is rejected
+       */
+      chain::processed_transaction admit( const chain::signed_transaction& trx );
+
+      const transaction_admission_stats& get_stats()const { return _stats; }
+
+   private:
+      /// Blocks the calling task until all transactions received before @p sequence are done.
+      void wait_for_turn( uint64_t sequence );
+      /// Called when the transaction whose turn it is was pushed or rejected.
+      void end_turn();
+
+      chain::database&                            _db;
+      std::vector<std::unique_ptr<fc::thread>>    _workers;
+      size_t                                      _next_worker = 0;
+      uint64_t                                    _next_sequence = 0;
+      uint64_t                                    _next_turn = 0;
+      std::map<uint64_t, fc::promise<void>::ptr>  _waiting_turns;
+      transaction_admission_stats                 _stats;
+};
+
+} } // graphene::app
+
+FC_REFLECT( graphene::app::transaction_admission_stats,
+            (received)(admitted)(rejected_invalid)(rejected_signatures)(rejected_duplicate)(rejected_tapos)
+            (rejected_expiration)(rejected_apply) )
@@ -0,0 +1,319 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <graphene/app/subscription_dispatcher.hpp>
+
+#include <graphene/chain/market_object.hpp>
+
+#include <algorithm>
+
+namespace graphene { namespace app {
+
+using namespace graphene::chain;
+
+namespace {
+
+template<typename Map, typename Key>
+void remove_subscriber( Map& subscribers, const Key& key, subscription_dispatcher::session_id_type session )
+{
+   auto itr = subscribers.find( key );
+   if( itr == subscribers.end() )
+      return;
+   itr->second.erase( session );
+   if( itr->second.empty() )
+      subscribers.erase( itr );
+}
+
+template<typename OrderType>
+optional<market_type> order_market( const object* obj )
+{
+   const OrderType* order = dynamic_cast<const OrderType*>( obj );
+   if( order == nullptr )
+      return {};
+   return order->get_market();
+}
+
+} // anonymous namespace
+
+subscription_dispatcher::subscription_dispatcher( database& db ) : _db( db )
+{
+   _new_connection = _db.new_objects.connect([this](const vector<object_id_type>& ids, const flat_set<account_id_type>& impacted_accounts) {
+      on_objects( ids, impacted_accounts, true, true, std::bind( &object_database::find_object, &_db, std::placeholders::_1 ) );
+   });
+   _change_connection = _db.changed_objects.connect([this](const vector<object_id_type>& ids, const flat_set<account_id_type>& impacted_accounts) {
+      on_objects( ids, impacted_accounts, false, true, std::bind( &object_database::find_object, &_db, std::placeholders::_1 ) );
+   });
+   _removed_connection = _db.removed_objects.connect([this](const vector<object_id_type>& ids, const vector<const object*>& objs, const flat_set<account_id_type>& impacted_accounts) {
+      on_objects( ids, impacted_accounts, true, false, [&objs](object_id_type id) -> const object* {
+         auto it = std::find_if( objs.begin(), objs.end(), [id](const object* o) { return o != nullptr && o->id == id; } );
+         return it != objs.end() ? *it : nullptr;
+      });
+      // Removed objects are reported last, see database::notify_changed_objects()
+      finish_block();
+   });
+}
+
+subscription_dispatcher::~subscription_dispatcher()
+{
+   if( _requires_impacted_accounts )
+      _db.release_impacted_accounts();
+}
+
+subscription_dispatcher::session_id_type subscription_dispatcher::add_session( update_handler on_updates,
+                                                                               market_update_handler on_market_updates )
+{
+   const session_id_type session = _next_session++;
+   auto& subscriptions = _sessions[session];
+   subscriptions.on_updates = std::move( on_updates );
+   subscriptions.on_market_updates = std::move( on_market_updates );
+   return session;
+}
+
+void subscription_dispatcher::remove_session( session_id_type session )
+{
+   reset_session( session, false );
+   unsubscribe_from_markets( session );
+   _sessions.erase( session );
+}
+
+void subscription_dispatcher::reset_session( session_id_type session, bool notify_remove_create )
+{
+   auto itr = _sessions.find( session );
+   FC_ASSERT( itr != _sessions.end() );
+   auto& subscriptions = itr->second;
+
+   for( const auto& id : subscriptions.objects )
+      remove_subscriber( _object_subscribers, id, session );
+   for( const auto& account : subscriptions.accounts )
+      remove_subscriber( _account_subscribers, account, session );
+   subscriptions.objects.clear();
+   subscriptions.accounts.clear();
+   update_impacted_accounts_requirement();
+
+   subscriptions.notify_remove_create = notify_remove_create;
+   if( notify_remove_create )
+      _notify_remove_create_sessions.insert( session );
+   else
+      _notify_remove_create_sessions.erase( session );
+}
+
+void subscription_dispatcher::subscribe_to_object( session_id_type session, object_id_type id )
+{
+   auto itr = _sessions.find( session );
+   FC_ASSERT( itr != _sessions.end() );
+   auto& subscriptions = itr->second;
+
+   if( subscriptions.objects.size() >= max_object_subscriptions )
+      return;
+   if( subscriptions.objects.insert( id ).second )
+      _object_subscribers[id].insert( session );
+}
+
+bool subscription_dispatcher::subscribe_to_account( session_id_type session, account_id_type account )
+{
+   auto itr = _sessions.find( session );
+   FC_ASSERT( itr != _sessions.end() );
+   auto& subscriptions = itr->second;
+
+   if( subscriptions.accounts.size() >= max_account_subscriptions )
+      return false;
+   if( subscriptions.accounts.insert( account ).second )
+   {
+      _account_subscribers[account].insert( session );
+      update_impacted_accounts_requirement();
+   }
+   return true;
+}
+
+void subscription_dispatcher::subscribe_to_market( session_id_type session, const market_type& market )
+{
+   auto itr = _sessions.find( session );
+   FC_ASSERT( itr != _sessions.end() );
+   if( itr->second.markets.insert( market ).second )
+      _market_subscribers[market].insert( session );
+}
+
+void subscription_dispatcher::unsubscribe_from_market( session_id_type session, const market_type& market )
+{
+   auto itr = _sessions.find( session );
+   FC_ASSERT( itr != _sessions.end() );
+   if( itr->second.markets.erase( market ) )
+      remove_subscriber( _market_subscribers, market, session );
+}
+
+void subscription_dispatcher::unsubscribe_from_markets( session_id_type session )
+{
+   auto itr = _sessions.find( session );
+   FC_ASSERT( itr != _sessions.end() );
+   for( const auto& market : itr->second.markets )
+      remove_subscriber( _market_subscribers, market, session );
+   itr->second.markets.clear();
+}
+
+void subscription_dispatcher::on_objects( const vector<object_id_type>& ids, const flat_set<account_id_type>& impacted_accounts,
+                                          bool created_or_removed, bool full_object,
+                                          const std::function<const object*(object_id_type)>& find_object )
+{
+   if( ids.empty() )
+      return;
+   const fc::time_point start = fc::time_point::now();
+
+   // Sessions subscribed to creations and removals or to one of the impacted accounts receive every object
+   flat_set<session_id_type> all_objects_sessions;
+   if( created_or_removed )
+      all_objects_sessions = _notify_remove_create_sessions;
+   for( const auto& account : impacted_accounts )
+   {
+      auto itr = _account_subscribers.find( account );
+      if( itr != _account_subscribers.end() )
+         all_objects_sessions.insert( itr->second.begin(), itr->second.end() );
+   }
+
+   // The others receive the objects they are subscribed to, and the orders of their markets
+   std::map< session_id_type, vector<size_t> > matched_objects;
+   std::map< session_id_type, vector<std::pair<market_type, size_t>> > matched_orders;
+   vector<bool> needed( ids.size(), !all_objects_sessions.empty() );
+   for( size_t i = 0; i < ids.size(); ++i )
+   {
+      const object_id_type id = ids[i];
+
+      auto subscribers = _object_subscribers.find( id );
+      if( subscribers != _object_subscribers.end() )
+      {
+         for( auto session : subscribers->second )
+         {
+            if( all_objects_sessions.find( session ) != all_objects_sessions.end() )
+               continue;
+            matched_objects[session].push_back( i );
+            needed[i] = true;
+         }
+      }
+
+      if( _market_subscribers.empty() || !( id.is<limit_order_object>() || id.is<call_order_object>() ) )
+         continue;
+      const object* obj = find_object( id );
+      const optional<market_type> market = id.is<limit_order_object>() ? order_market<limit_order_object>( obj )
+                                                                        : order_market<call_order_object>( obj );
+      if( !market )
+         continue;
+      auto market_subscribers = _market_subscribers.find( *market );
+      if( market_subscribers == _market_subscribers.end() )
+         continue;
+      for( auto session : market_subscribers->second )
+         matched_orders[session].emplace_back( *market, i );
+      needed[i] = true;
+   }
+
+   // Serialize each object once, objects which cannot be found are left null and not sent
+   vector<fc::variant> updates( ids.size() );
+   for( size_t i = 0; i < ids.size(); ++i )
+   {
+      if( !needed[i] )
+         continue;
+      if( full_object )
+      {
+         if( const object* obj = find_object( ids[i] ) )
+         {
+            updates[i] = obj->to_variant();
+            ++_stats.objects_serialized;
+         }
+      }
+      else
+         updates[i] = fc::variant( ids[i], 1 );
+   }
+   const fc::time_point serialized = fc::time_point::now();
+
+   auto dispatch = [this]( session_id_type session, const vector<fc::variant>& session_updates ) {
+      auto itr = _sessions.find( session );
+      if( itr == _sessions.end() || session_updates.empty() )
+         return;
+      _stats.updates_dispatched += session_updates.size();
+      itr->second.on_updates( session_updates );
+   };
+
+   if( !all_objects_sessions.empty() )
+   {
+      vector<fc::variant> all_updates;
+      all_updates.reserve( ids.size() );
+      for( const auto& update : updates )
+         if( !update.is_null() )
+            all_updates.push_back( update );
+      for( auto session : all_objects_sessions )
+         dispatch( session, all_updates );
+   }
+
+   for( const auto& match : matched_objects )
+   {
+      vector<fc::variant> session_updates;
+      session_updates.reserve( match.second.size() );
+      for( auto i : match.second )
+         if( !updates[i].is_null() )
+            session_updates.push_back( updates[i] );
+      dispatch( match.first, session_updates );
+   }
+
+   for( const auto& match : matched_orders )
+   {
+      auto itr = _sessions.find( match.first );
+      if( itr == _sessions.end() )
+         continue;
+      market_queue_type queue;
+      for( const auto& order : match.second )
+      {
+         if( updates[order.second].is_null() )
+            continue;
+         queue[order.first].push_back( updates[order.second] );
+         ++_stats.updates_dispatched;
+      }
+      if( queue.empty() )
+         continue;
+      itr->second.on_market_updates( queue );
+   }
+
+   _block_serialization_us += ( serialized - start ).count();
+   _block_dispatch_us += ( fc::time_point::now() - serialized ).count();
+}
+
+void subscription_dispatcher::update_impacted_accounts_requirement()
+{
+   const bool required = !_account_subscribers.empty();
+   if( required == _requires_impacted_accounts )
+      return;
+   if( required )
+      _db.require_impacted_accounts();
+   else
+      _db.release_impacted_accounts();
+   _requires_impacted_accounts = required;
+}
+
+void subscription_dispatcher::finish_block()
+{
+   ++_stats.blocks;
+   _stats.serialization.record( _block_serialization_us );
+   _stats.dispatch.record( _block_dispatch_us );
+   _block_serialization_us = 0;
+   _block_dispatch_us = 0;
+}
+
+} } // graphene::app
@@ -0,0 +1,141 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <graphene/app/transaction_admission.hpp>
+
+#include <fc/string.hpp>
+
+namespace graphene { namespace app {
+
+using namespace graphene::chain;
+
+transaction_admission::transaction_admission( database& db, uint32_t worker_count ) : _db( db )
+{
+   for( uint32_t i = 0; i < worker_count; ++i )
+      _workers.emplace_back( new fc::thread( "admission" + fc::to_string( i ) ) );
+}
+
+transaction_admission::~transaction_admission()
+{
+   for( auto& worker : _workers )
+      worker->quit();
+}
+
+processed_transaction transaction_admission::admit( const signed_transaction& trx )
+{
+   ++_stats.received;
+   const uint64_t sequence = _next_sequence++;
+
+   // The counter of the check which is running, incremented if the check throws:
+   uint64_t* rejected = &_stats.rejected_invalid;
+   try
+   {
+      const chain_id_type chain_id = _db.get_chain_id();
+      auto stateless_checks = [&]() -> precomputed_transaction_data {
+         trx.validate();
+         rejected = &_stats.rejected_signatures;
+         precomputed_transaction_data data;
+         data.id = trx.id();
+         data.signature_keys = trx.get_signature_keys( chain_id );
+         return data;
+      };
+
+      precomputed_transaction_data data;
+      try
+      {
+         if( _workers.empty() )
+            data = stateless_checks();
+         else
+         {
+            auto& worker = *_workers[_next_worker];
+            _next_worker = ( _next_worker + 1 ) % _workers.size();
+            // Blocks and other transactions are processed while this one is checked by the worker:
+            data = worker.async( stateless_checks, "admission_checks" ).wait();
+         }
+      }
+      catch( ... )
+      {
+         wait_for_turn( sequence );
+         throw;
+      }
+      // Transactions checked faster than the ones received before them wait for those to be pushed first:
+      wait_for_turn( sequence );
+
+      const uint32_t skip = _db.get_node_properties().skip_flags;
+      rejected = &_stats.rejected_duplicate;
+      FC_ASSERT( (skip & database::skip_transaction_dupe_check) || !_db.is_known_transaction( data.id ),
+                 "Duplicate transaction ${id}", ("id", data.id) );
+
+      if( _db.head_block_num() > 0 )
+      {
+         rejected = &_stats.rejected_tapos;
+         if( !(skip & database::skip_tapos_check) )
+            _db.verify_tapos( trx );
+         rejected = &_stats.rejected_expiration;
+         _db.verify_expiration( trx );
+      }
+
+      rejected = &_stats.rejected_apply;
+      auto result = _db.push_transaction( trx, data );
+      ++_stats.admitted;
+      end_turn();
+      return result;
+   }
+   catch( const fc::exception& )
+   {
+      ++*rejected;
+      end_turn();
+      throw;
+   }
+   catch( ... )
+   {
+      // Any other exception must end the turn as well, or every later admission would wait for it forever:
+      ++*rejected;
+      end_turn();
+      throw;
+   }
+}
+
+void transaction_admission::wait_for_turn( uint64_t sequence )
+{
+   if( sequence == _next_turn )
+      return;
+   fc::promise<void>::ptr turn( new fc::promise<void>( "graphene::app::transaction_admission::turn" ) );
+   _waiting_turns[sequence] = turn;
+   turn->wait();
+}
+
+void transaction_admission::end_turn()
+{
+   ++_next_turn;
+   auto itr = _waiting_turns.find( _next_turn );
+   if( itr != _waiting_turns.end() )
+   {
+      fc::promise<void>::ptr turn = itr->second;
+      _waiting_turns.erase( itr );
+      turn->set_value();
+   }
+}
+
+} } // graphene::app
@@ -55,10 +55,12 @@ vector<signed_block_with_virtual_operations_and_num> database_access_layer::get_
               ("start_n", start_block_num)
               ("head_n", head_block_num));
 
+    std::vector<bool> virtual_operation_filter(operation::count());
     for(auto operation_id : virtual_operation_ids)
     {
           FC_ASSERT(operation_type_limits::is_virtual_operation(operation_id), "Operation id ${op_id} is not valid virtual operation id.",
                 ("op_id", operation_id));
+          virtual_operation_filter[operation_id] = true;
     }
 
     vector<signed_block_with_virtual_operations_and_num> result;
@@ -67,7 +69,7 @@ vector<signed_block_with_virtual_operations_and_num> database_access_layer::get_
     if (end > head_block_num)
         end = head_block_num;
     for (auto i = start_block_num; i < end; ++i) {
-        auto signed_block = _db.fetch_block_with_virtual_operations_by_number(i, virtual_operation_ids);
+        auto signed_block = _db.fetch_block_with_virtual_operations_by_number(i, virtual_operation_filter);
         FC_ASSERT(signed_block.valid(),
                   "Block number ${num} could not be retreived",
                   ("num", i)
@@ -151,26 +153,7 @@ optional<total_cycles_res> database_access_layer::get_total_cycles(account_id_ty
     {
         auto license_information = _db.get_license_information(vault_id);
         if (license_information.valid() && license_information->is_manual_submit()) 
-        {
-            auto history = license_information->history;
-            total_cycles_res result;
-            for (auto itr = history.begin(); itr != history.end(); ++itr)
-            {
-
-                //TODO: Write helper function for code below:
-                auto lic = get_license_type(itr->license);
-                if (lic.valid())
-                  if (!(lic->kind == license_kind::locked_frequency ||
-                      lic->kind == license_kind::utility ||
-                      lic->kind == license_kind::package))
-                    continue;
-
-                result.total_cycles += itr->amount;
-                result.total_cycles += itr->non_upgradeable_amount;
-                result.total_dascoin += _db.cycles_to_dascoin(itr->amount + itr->non_upgradeable_amount, itr->frequency_lock);
-            }
-            return result;
-        }
+            return calculate_total_cycles(_db, *license_information);
     }
     return {};
 }
@@ -182,140 +165,164 @@ optional<queue_projection_res> database_access_layer::get_queue_state_for_accoun
     {
         auto license_information = _db.get_license_information(id);
         if (license_information.valid())
+            return calculate_queue_state(_db, *account, *license_information);
+    }
+    return {};
+}
+
+total_cycles_res calculate_total_cycles(const database& db, const license_information_object& license_information)
+{
+    total_cycles_res result;
+    for (auto itr = license_information.history.begin(); itr != license_information.history.end(); ++itr)
+    {
+
+        //TODO: Write helper function for code below:
+        const auto* lic = db.find(itr->license);
+        if (lic != nullptr)
+          if (!(lic->kind == license_kind::locked_frequency ||
+              lic->kind == license_kind::utility ||
+              lic->kind == license_kind::package))
+            continue;
+
+        result.total_cycles += itr->amount;
+        result.total_cycles += itr->non_upgradeable_amount;
+        result.total_dascoin += db.cycles_to_dascoin(itr->amount + itr->non_upgradeable_amount, itr->frequency_lock);
+    }
+    return result;
+}
+
+queue_projection_res calculate_queue_state(const database& db, const account_object& vault,
+                                           const license_information_object& license_information)
+{
+    queue_projection_res result;
+    for (auto itr = license_information.history.begin(); itr != license_information.history.end(); ++itr)
+    {
+        const auto* lic = db.find(itr->license);
+        if (lic != nullptr)
         {
-            auto history = license_information->history;
-            queue_projection_res result;
-            for (auto itr = history.begin(); itr != history.end(); ++itr)
-            {
-                auto lic = get_license_type(itr->license);
-                if (lic.valid())
+          cycles_res tmp;
+          if (lic->kind == license_kind::chartered)//  || (lic->kind == license_kind::locked_frequency && lic->up_policy == detail::president))
+          {
+              if (itr->balance_upgrade.used < itr->balance_upgrade.max)
+              {
+                tmp.cycles = itr->amount * itr->balance_upgrade.multipliers[itr->balance_upgrade.used];
+                tmp.dascoin = db.cycles_to_dascoin(tmp.cycles, itr->frequency_lock);
+                result.auto_submit.charter = result.auto_submit.charter + tmp;
+                auto upgrades = itr->balance_upgrade.used;
+                tmp = cycles_res{0,0};
+                while(upgrades < itr->balance_upgrade.max)
                 {
-                  cycles_res tmp;
-                  if (lic->kind == license_kind::chartered)//  || (lic->kind == license_kind::locked_frequency && lic->up_policy == detail::president))
-                  {
-                      if (itr->balance_upgrade.used < itr->balance_upgrade.max)
-                      {
-                        tmp.cycles = itr->amount * itr->balance_upgrade.multipliers[itr->balance_upgrade.used];
-                        tmp.dascoin = _db.cycles_to_dascoin(tmp.cycles, itr->frequency_lock);
-                        result.auto_submit.charter = result.auto_submit.charter + tmp;
-                        auto upgrades = itr->balance_upgrade.used;
-                        tmp = cycles_res{0,0};
-                        while(upgrades < itr->balance_upgrade.max)
-                        {
-                            tmp.cycles += itr->amount * itr->balance_upgrade.multipliers[upgrades];
-                            upgrades++;
-                        }
-                        tmp.dascoin = _db.cycles_to_dascoin(tmp.cycles, itr->frequency_lock);
-                        result.auto_submit.after_all_upgrades = result.auto_submit.after_all_upgrades + tmp;
-                      }
-                  }
-                  else if (lic->kind == license_kind::locked_frequency)// && lic->up_policy != detail::president)
-                  {
-                      tmp.cycles = itr->amount;
-                      tmp.dascoin = _db.cycles_to_dascoin(tmp.cycles, itr->frequency_lock);
-
-                      cycles_res non_upgradeable{itr->non_upgradeable_amount, _db.cycles_to_dascoin(itr->non_upgradeable_amount, itr->frequency_lock)};
+                    tmp.cycles += itr->amount * itr->balance_upgrade.multipliers[upgrades];
+                    upgrades++;
+                }
+                tmp.dascoin = db.cycles_to_dascoin(tmp.cycles, itr->frequency_lock);
+                result.auto_submit.after_all_upgrades = result.auto_submit.after_all_upgrades + tmp;
+              }
+          }
+          else if (lic->kind == license_kind::locked_frequency)// && lic->up_policy != detail::president)
+          {
+              tmp.cycles = itr->amount;
+              tmp.dascoin = db.cycles_to_dascoin(tmp.cycles, itr->frequency_lock);
+
+              cycles_res non_upgradeable{itr->non_upgradeable_amount, db.cycles_to_dascoin(itr->non_upgradeable_amount, itr->frequency_lock)};
+
+              if (vault.is_tethered())
+                  result.total_locked_manual_submit.tethered = result.total_locked_manual_submit.tethered + tmp + non_upgradeable;
+              else
+                  result.total_locked_manual_submit.untethered = result.total_locked_manual_submit.untethered + tmp + non_upgradeable;
+
+              if (itr->balance_upgrade.max - itr->balance_upgrade.used == 1)
+              {
+                if (lic->up_policy == detail::president)
+                {
+                    tmp.cycles += 2 * (itr->base_amount + (itr->base_amount * itr->bonus_percent / 100));
+                    tmp.dascoin = db.cycles_to_dascoin(tmp.cycles, itr->frequency_lock);
+                }
+                else
+                {
+                    tmp = tmp + tmp;
+                }
 
-                      if (account->is_tethered())
-                          result.total_locked_manual_submit.tethered = result.total_locked_manual_submit.tethered + tmp + non_upgradeable;
-                      else
-                          result.total_locked_manual_submit.untethered = result.total_locked_manual_submit.untethered + tmp + non_upgradeable;
-
-                      if (itr->balance_upgrade.max - itr->balance_upgrade.used == 1)
-                      {
-                        if (lic->up_policy == detail::president)
-                        {
-                            tmp.cycles += 2 * (itr->base_amount + (itr->base_amount * itr->bonus_percent / 100));
-                            tmp.dascoin = _db.cycles_to_dascoin(tmp.cycles, itr->frequency_lock);
-                        }
-                        else
-                        {
-                            tmp = tmp + tmp;
-                        }
-
-                        if (account->is_tethered())
-                              result.next_upgrade_last_locked_manual_submit.tethered = result.next_upgrade_last_locked_manual_submit.tethered + tmp + non_upgradeable;
-                          else
-                              result.next_upgrade_last_locked_manual_submit.untethered = result.next_upgrade_last_locked_manual_submit.untethered + tmp + non_upgradeable;
-                      }
-
-                      if (itr->balance_upgrade.max > itr->balance_upgrade.used)
-                      {
-                          auto upgrades = itr->balance_upgrade.used;
-                          auto amount = itr->amount;
-                          while(upgrades < itr->balance_upgrade.max)
-                          {
-                              if (lic->up_policy != detail::president)
-                                amount *= itr->balance_upgrade.multipliers[upgrades];
-                              else
-                                amount += (itr->base_amount + (itr->base_amount * itr->bonus_percent / 100)) * itr->balance_upgrade.multipliers[upgrades];
-                              upgrades++;
-                          }
-                          tmp.cycles = amount;
-                          tmp.dascoin = _db.cycles_to_dascoin(tmp.cycles, itr->frequency_lock);
-                          result.after_all_upgrades_manual_submit = result.after_all_upgrades_manual_submit + tmp + non_upgradeable;
-                      }
+                if (vault.is_tethered())
+                      result.next_upgrade_last_locked_manual_submit.tethered = result.next_upgrade_last_locked_manual_submit.tethered + tmp + non_upgradeable;
+                  else
+                      result.next_upgrade_last_locked_manual_submit.untethered = result.next_upgrade_last_locked_manual_submit.untethered + tmp + non_upgradeable;
+              }
+
+              if (itr->balance_upgrade.max > itr->balance_upgrade.used)
+              {
+                  auto upgrades = itr->balance_upgrade.used;
+                  auto amount = itr->amount;
+                  while(upgrades < itr->balance_upgrade.max)
+                  {
+                      if (lic->up_policy != detail::president)
+                        amount *= itr->balance_upgrade.multipliers[upgrades];
                       else
-                      {
-                          result.after_all_upgrades_manual_submit = result.after_all_upgrades_manual_submit + tmp + non_upgradeable;
-                      }
+                        amount += (itr->base_amount + (itr->base_amount * itr->bonus_percent / 100)) * itr->balance_upgrade.multipliers[upgrades];
+                      upgrades++;
                   }
-                  else if (lic->kind == license_kind::utility)
+                  tmp.cycles = amount;
+                  tmp.dascoin = db.cycles_to_dascoin(tmp.cycles, itr->frequency_lock);
+                  result.after_all_upgrades_manual_submit = result.after_all_upgrades_manual_submit + tmp + non_upgradeable;
+              }
+              else
+              {
+                  result.after_all_upgrades_manual_submit = result.after_all_upgrades_manual_submit + tmp + non_upgradeable;
+              }
+          }
+          else if (lic->kind == license_kind::utility)
+          {
+              if (itr->balance_upgrade.used < itr->balance_upgrade.max)
+              {
+                  tmp.cycles = itr->base_amount * itr->balance_upgrade.multipliers[itr->balance_upgrade.used];
+                  tmp.dascoin = db.cycles_to_dascoin(tmp.cycles, itr->frequency_lock);
+                  result.auto_submit.utility = result.auto_submit.utility + tmp;
+                  auto upgrades = itr->balance_upgrade.used;
+                  tmp.cycles = 0;
+                  while (upgrades < itr->balance_upgrade.max)
                   {
-                      if (itr->balance_upgrade.used < itr->balance_upgrade.max)
-                      {
-                          tmp.cycles = itr->base_amount * itr->balance_upgrade.multipliers[itr->balance_upgrade.used];
-                          tmp.dascoin = _db.cycles_to_dascoin(tmp.cycles, itr->frequency_lock);
-                          result.auto_submit.utility = result.auto_submit.utility + tmp;
-                          auto upgrades = itr->balance_upgrade.used;
-                          tmp.cycles = 0;
-                          while (upgrades < itr->balance_upgrade.max)
-                          {
-                            tmp.cycles += itr->base_amount * itr->balance_upgrade.multipliers[upgrades];
-                            upgrades++;
-                          }
-                          tmp.dascoin = _db.cycles_to_dascoin(tmp.cycles, itr->frequency_lock);
-                          result.auto_submit.after_all_upgrades = result.auto_submit.after_all_upgrades + tmp;
-                      }
-                      tmp.cycles = itr->amount;
-                      tmp.dascoin = _db.cycles_to_dascoin(tmp.cycles, itr->frequency_lock);
-                      if (account->is_tethered())
-                          result.utility_manual_submit.tethered = result.utility_manual_submit.tethered + tmp;
-                      else
-                          result.utility_manual_submit.untethered = result.utility_manual_submit.untethered + tmp;
-                      result.after_all_upgrades_manual_submit = result.after_all_upgrades_manual_submit + tmp;
+                    tmp.cycles += itr->base_amount * itr->balance_upgrade.multipliers[upgrades];
+                    upgrades++;
                   }
-                  else if (lic->kind == license_kind::package)
+                  tmp.dascoin = db.cycles_to_dascoin(tmp.cycles, itr->frequency_lock);
+                  result.auto_submit.after_all_upgrades = result.auto_submit.after_all_upgrades + tmp;
+              }
+              tmp.cycles = itr->amount;
+              tmp.dascoin = db.cycles_to_dascoin(tmp.cycles, itr->frequency_lock);
+              if (vault.is_tethered())
+                  result.utility_manual_submit.tethered = result.utility_manual_submit.tethered + tmp;
+              else
+                  result.utility_manual_submit.untethered = result.utility_manual_submit.untethered + tmp;
+              result.after_all_upgrades_manual_submit = result.after_all_upgrades_manual_submit + tmp;
+          }
+          else if (lic->kind == license_kind::package)
+          {
+              if (itr->balance_upgrade.used < itr->balance_upgrade.max)
+              {
+                  tmp.cycles = itr->base_amount * itr->balance_upgrade.multipliers[itr->balance_upgrade.used];
+                  tmp.dascoin = db.cycles_to_dascoin(tmp.cycles, itr->frequency_lock);
+                  result.auto_submit.package = result.auto_submit.package + tmp;
+                  auto upgrades = itr->balance_upgrade.used;
+                  tmp.cycles = 0;
+                  while (upgrades < itr->balance_upgrade.max)
                   {
-                      if (itr->balance_upgrade.used < itr->balance_upgrade.max)
-                      {
-                          tmp.cycles = itr->base_amount * itr->balance_upgrade.multipliers[itr->balance_upgrade.used];
-                          tmp.dascoin = _db.cycles_to_dascoin(tmp.cycles, itr->frequency_lock);
-                          result.auto_submit.package = result.auto_submit.package + tmp;
-                          auto upgrades = itr->balance_upgrade.used;
-                          tmp.cycles = 0;
-                          while (upgrades < itr->balance_upgrade.max)
-                          {
-                            tmp.cycles += itr->base_amount * itr->balance_upgrade.multipliers[upgrades];
-                            upgrades++;
-                          }
-                          tmp.dascoin = _db.cycles_to_dascoin(tmp.cycles, itr->frequency_lock);
-                          result.auto_submit.after_all_upgrades = result.auto_submit.after_all_upgrades + tmp;
-                      }
-                      tmp.cycles = itr->amount;
-                      tmp.dascoin = _db.cycles_to_dascoin(tmp.cycles, itr->frequency_lock);
-                      if (account->is_tethered())
-                          result.package_manual_submit.tethered = result.package_manual_submit.tethered + tmp;
-                      else
-                          result.package_manual_submit.untethered = result.package_manual_submit.untethered + tmp;
-                      result.after_all_upgrades_manual_submit = result.after_all_upgrades_manual_submit + tmp;
+                    tmp.cycles += itr->base_amount * itr->balance_upgrade.multipliers[upgrades];
+                    upgrades++;
                   }
-                }
-            }
-            return result;
+                  tmp.dascoin = db.cycles_to_dascoin(tmp.cycles, itr->frequency_lock);
+                  result.auto_submit.after_all_upgrades = result.auto_submit.after_all_upgrades + tmp;
+              }
+              tmp.cycles = itr->amount;
+              tmp.dascoin = db.cycles_to_dascoin(tmp.cycles, itr->frequency_lock);
+              if (vault.is_tethered())
+                  result.package_manual_submit.tethered = result.package_manual_submit.tethered + tmp;
+              else
+                  result.package_manual_submit.untethered = result.package_manual_submit.untethered + tmp;
+              result.after_all_upgrades_manual_submit = result.after_all_upgrades_manual_submit + tmp;
+          }
         }
     }
-    return {};
+    return result;
 }
 
 // License:
@@ -373,7 +380,7 @@ vector<reward_queue_object> database_access_layer::get_reward_queue() const
 
 vector<reward_queue_object> database_access_layer::get_reward_queue_by_page(uint32_t from, uint32_t amount) const
 {
-    return get_range<reward_queue_index, by_time>(from, amount);
+    return get_ranked_range<reward_queue_index, by_time>(from, amount);
 }
 
 vector<frequency_history_record_object> database_access_layer::get_frequency_history() const
@@ -399,7 +406,7 @@ acc_id_queue_subs_w_pos_res database_access_layer::get_queue_submissions_with_po
 
     const auto& range = account_idx.equal_range(account_id);
     for (auto it = range.first; it != range.second; ++it) {
-        uint32_t pos = distance(time_idx.begin(), queue_multi_idx.project<by_time>(it));
+        uint32_t pos = time_idx.rank(queue_multi_idx.project<by_time>(it));
         result.emplace_back(pos, *it);
     }
 
@@ -267,4 +267,152 @@ void account_referrer_index::object_modified( const object& after  )
 {
 }
 
+void account_vault_index::object_inserted( const object& obj )
+{
+   assert( dynamic_cast<const account_object*>(&obj) ); // for debug only
+   const account_object& a = static_cast<const account_object&>(obj);
+   if( a.is_vault() )
+      vaults.insert( a.id );
+}
+
+void account_vault_index::object_removed( const object& obj )
+{
+   assert( dynamic_cast<const account_object*>(&obj) ); // for debug only
+   const account_object& a = static_cast<const account_object&>(obj);
+   if( a.is_vault() )
+      vaults.erase( a.id );
+}
+
+void dasc_holder_index::object_inserted( const object& obj )
+{
+   assert( dynamic_cast<const account_object*>(&obj) ); // for debug only
+   collect_affected( static_cast<const account_object&>(obj) );
+   update_affected();
+}
+
+void dasc_holder_index::object_removed( const object& obj )
+{
+   assert( dynamic_cast<const account_object*>(&obj) ); // for debug only
+   const account_object& a = static_cast<const account_object&>(obj);
+   collect_affected( a );
+   _affected.erase( a.id );
+   update_affected();
+
+   // The account is still in the database at this point, drop it explicitly:
+   auto itr = _amounts.find( a.id );
+   if( itr != _amounts.end() )
+   {
+      _ranking.erase( holding{ itr->second, a.id } );
+      _amounts.erase( itr );
+   }
+}
+
+void dasc_holder_index::about_to_modify( const object& before )
+{
+   assert( dynamic_cast<const account_object*>(&before) ); // for debug only
+   collect_affected( static_cast<const account_object&>(before) );
+}
+
+void dasc_holder_index::object_modified( const object& after )
+{
+   assert( dynamic_cast<const account_object*>(&after) ); // for debug only
+   collect_affected( static_cast<const account_object&>(after) );
+   update_affected();
+}
+
+void dasc_holder_index::balance_changed( account_id_type owner, optional<object_id_type> removed )
+{
+   _affected.insert( owner );
+   const account_object* a = _db.find( owner );
+   if( a != nullptr )
+      _affected.insert( a->parents.begin(), a->parents.end() );
+   _removed_balance = removed;
+   update_affected();
+   _removed_balance.reset();
+}
+
+void dasc_holder_index::collect_affected( const account_object& a )
+{
+   _affected.insert( a.id );
+   _affected.insert( a.vault.begin(), a.vault.end() );
+   _affected.insert( a.parents.begin(), a.parents.end() );
+}
+
+void dasc_holder_index::update_affected()
+{
+   for( const auto& id : _affected )
+      update( id );
+   _affected.clear();
+}
+
+void dasc_holder_index::update( account_id_type holder )
+{
+   const auto& balance_idx = _db.get_index_type<account_balance_index>().indices().get<by_account_asset>();
+   const auto dasc_id = asset_id_type( DASCOIN_DASCOIN_INDEX );
+   const auto& get_balance = [&]( account_id_type id, bool with_reserved ) -> share_type {
+      auto itr = balance_idx.find( boost::make_tuple( id, dasc_id ) );
+      if( itr == balance_idx.end() || ( _removed_balance.valid() && itr->id == *_removed_balance ) )
+         return 0;
+      return with_reserved ? itr->balance + itr->reserved : itr->balance;
+   };
+
+   optional<share_type> amount;
+   const account_object* a = _db.find( holder );
+   if( a != nullptr )
+   {
+      if( a->is_wallet() )
+      {
+         amount = get_balance( holder, true );
+         for( const auto& vault_id : a->vault )
+            *amount += get_balance( vault_id, false );
+      }
+      else if( a->is_custodian() || ( a->is_vault() && a->parents.empty() ) )
+         amount = get_balance( holder, false );
+   }
+
+   auto itr = _amounts.find( holder );
+   if( itr != _amounts.end() )
+   {
+      if( amount.valid() && *amount == itr->second )
+         return;
+      _ranking.erase( holding{ itr->second, holder } );
+      if( !amount.valid() )
+      {
+         _amounts.erase( itr );
+         return;
+      }
+      itr->second = *amount;
+   }
+   else if( amount.valid() )
+      _amounts.emplace( holder, *amount );
+   else
+      return;
+
+   _ranking.insert( holding{ *amount, holder } );
+}
+
+void dasc_holder_balance_index::object_inserted( const object& obj )
+{
+   assert( dynamic_cast<const account_balance_object*>(&obj) ); // for debug only
+   const account_balance_object& b = static_cast<const account_balance_object&>(obj);
+   if( b.asset_type == asset_id_type( DASCOIN_DASCOIN_INDEX ) )
+      _holders.balance_changed( b.owner );
+}
+
+void dasc_holder_balance_index::object_removed( const object& obj )
+{
+   assert( dynamic_cast<const account_balance_object*>(&obj) ); // for debug only
+   const account_balance_object& b = static_cast<const account_balance_object&>(obj);
+   if( b.asset_type == asset_id_type( DASCOIN_DASCOIN_INDEX ) )
+      _holders.balance_changed( b.owner, b.id );
+}
+
+void dasc_holder_balance_index::object_modified( const object& after )
+{
+   assert( dynamic_cast<const account_balance_object*>(&after) ); // for debug only
+   const account_balance_object& b = static_cast<const account_balance_object&>(after);
+   if( b.asset_type == asset_id_type( DASCOIN_DASCOIN_INDEX ) )
+      _holders.balance_changed( b.owner );
+}
+
 } } // graphene::chain
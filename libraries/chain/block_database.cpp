@@ -23,7 +23,11 @@
  */
 #include <graphene/chain/block_database.hpp>
 #include <graphene/chain/protocol/fee_schedule.hpp>
+#include <fc/interprocess/file_mapping.hpp>
 #include <fc/io/raw.hpp>
+#include <algorithm>
+#include <cstring>
+#include <thread>
 
 namespace graphene { namespace chain {
 
@@ -38,22 +42,49 @@ FC_REFLECT( graphene::chain::index_entry, (block_pos)(block_size)(block_id) );
 
 namespace graphene { namespace chain {
 
+namespace {
+   /// Mappings grow by at least this much, so a file which keeps growing is not remapped on every append.
+   const uint64_t minimum_mapping_growth = 64 * 1024 * 1024;
+}
+
+/**
+ * A mapping may reach past the end of the file, so the file can grow into it without being remapped. Only the
+ * first @ref available bytes exist in the file and may be read, touching the rest of the mapping is undefined.
+ */
+struct block_database::mapped_file
+{
+   mapped_file( const fc::path& filename, uint64_t capacity, uint64_t file_size )
+      : mapping( filename.generic_string().c_str(), fc::read_only ),
+        region( mapping, fc::read_only, 0, capacity ),
+        available( file_size ) {}
+
+   const char* data()const { return (const char*)region.get_address(); }
+   uint64_t capacity()const { return region.get_size(); }
+
+   fc::file_mapping  mapping;
+   fc::mapped_region region;
+   /// guarded by block_database::_map_mutex
+   mutable uint64_t  available;
+};
+
 void block_database::open( const fc::path& dbdir )
 { try {
+   unmap();
    fc::create_directories(dbdir);
    _block_num_to_pos.exceptions(std::ios_base::failbit | std::ios_base::badbit);
    _blocks.exceptions(std::ios_base::failbit | std::ios_base::badbit);
 
    _index_filename = dbdir / "index";
+   _blocks_filename = dbdir / "blocks";
    if( !fc::exists( _index_filename ) )
    {
      _block_num_to_pos.open( _index_filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out | std::fstream::trunc);
-     _blocks.open( (dbdir/"blocks").generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out | std::fstream::trunc);
+     _blocks.open( _blocks_filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out | std::fstream::trunc);
    }
    else
    {
      _block_num_to_pos.open( _index_filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out );
-     _blocks.open( (dbdir/"blocks").generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out );
+     _blocks.open( _blocks_filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out );
    }
 } FC_CAPTURE_AND_RETHROW( (dbdir) ) }
 
@@ -64,6 +95,7 @@ bool block_database::is_open()const
 
 void block_database::close()
 {
+  unmap();
   _blocks.close();
   _block_num_to_pos.close();
 }
@@ -74,6 +106,76 @@ void block_database::flush()
   _block_num_to_pos.flush();
 }
 
+void block_database::unmap()const
+{
+   std::lock_guard<std::mutex> guard( _map_mutex );
+   _index_map.reset();
+   _blocks_map.reset();
+}
+
+block_database::mapped_file_ptr block_database::map_file( mapped_file_ptr& current, const fc::path& filename,
+                                                          uint64_t min_size )const
+{
+   std::lock_guard<std::mutex> guard( _map_mutex );
+   if( current && current->available >= min_size )
+      return current;
+
+   // The mapping only ever exposes bytes already flushed to the file, anything beyond it is not ours to read:
+   const uint64_t file_size = fc::exists( filename ) ? fc::file_size( filename ) : 0;
+   if( file_size == 0 || file_size < min_size )
+      return mapped_file_ptr();
+
+   if( current && current->capacity() >= file_size )
+   {
+      current->available = file_size;
+      return current;
+   }
+
+   // Grow the mapping geometrically, appending a block must not remap the whole file each time:
+   uint64_t capacity = std::max( file_size, current ? 2 * current->capacity() : uint64_t(0) );
+   capacity = ( capacity + minimum_mapping_growth - 1 ) / minimum_mapping_growth * minimum_mapping_growth;
+   current = std::make_shared<const mapped_file>( filename, capacity, file_size );
+   return current;
+}
+
+void block_database::truncate_index( uint64_t size )const
+{
+   std::lock_guard<std::mutex> guard( _map_mutex );
+   // Touching pages of a mapping which the file was shrunk under raises SIGBUS. Readers which still hold the index
+   // mapping finish their lookup without the mutex, while new ones wait for it and map the shortened file afterwards:
+   std::weak_ptr<const mapped_file> index_map = _index_map;
+   _index_map.reset();
+   while( !index_map.expired() )
+      std::this_thread::yield();
+   fc::resize_file( _index_filename, size );
+}
+
+optional<index_entry> block_database::read_index_entry( uint32_t block_num )const
+{
+   const uint64_t index_pos = sizeof(index_entry) * uint64_t(block_num);
+   const auto index = map_file( _index_map, _index_filename, index_pos + sizeof(index_entry) );
+   if( !index )
+      return optional<index_entry>();
+
+   index_entry e;
+   std::memcpy( (char*)&e, index->data() + index_pos, sizeof(e) );
+   return e;
+}
+
+signed_block block_database::read_block( const index_entry& e )const
+{
+   const auto blocks = map_file( _blocks_map, _blocks_filename, e.block_pos + e.block_size );
+   FC_ASSERT( blocks,
+              "Block ${id} lies beyond the end of the blocks file", ("id", e.block_id) );
+
+   // Unpack straight from the mapping, the bytes are never copied into an intermediate buffer:
+   fc::datastream<const char*> ds( blocks->data() + e.block_pos, e.block_size );
+   signed_block result;
+   fc::raw::unpack( ds, result );
+   FC_ASSERT( result.id() == e.block_id );
+   return result;
+}
+
 void block_database::store( const block_id_type& _id, const signed_block& b )
 {
    block_id_type id = _id;
@@ -89,26 +191,25 @@ void block_database::store( const block_id_type& _id, const signed_block& b )
    e.block_pos  = _blocks.tellp();
    e.block_size = vec.size();
    e.block_id   = id;
+   // Readers go through the mappings, so the block must reach the file before the index entry pointing at it:
    _blocks.write( vec.data(), vec.size() );
+   _blocks.flush();
    _block_num_to_pos.write( (char*)&e, sizeof(e) );
+   _block_num_to_pos.flush();
 }
 
 void block_database::remove( const block_id_type& id )
 { try {
-   index_entry e;
-   int64_t index_pos = sizeof(e) * int64_t(block_header::num_from_id(id));
-   _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-   if ( _block_num_to_pos.tellg() <= index_pos )
+   optional<index_entry> e = read_index_entry( block_header::num_from_id(id) );
+   if( !e.valid() )
       FC_THROW_EXCEPTION(fc::key_not_found_exception, "Block ${id} not contained in block database", ("id", id));
 
-   _block_num_to_pos.seekg( index_pos );
-   _block_num_to_pos.read( (char*)&e, sizeof(e) );
-
-   if( e.block_id == id )
+   if( e->block_id == id )
    {
-      e.block_size = 0;
-      _block_num_to_pos.seekp( sizeof(e) * int64_t(block_header::num_from_id(id)) );
-      _block_num_to_pos.write( (char*)&e, sizeof(e) );
+      e->block_size = 0;
+      _block_num_to_pos.seekp( sizeof(*e) * int64_t(block_header::num_from_id(id)) );
+      _block_num_to_pos.write( (char*)&*e, sizeof(*e) );
+      _block_num_to_pos.flush();
    }
 } FC_CAPTURE_AND_RETHROW( (id) ) }
 
@@ -117,55 +218,29 @@ bool block_database::contains( const block_id_type& id )const
    if( id == block_id_type() )
       return false;
 
-   index_entry e;
-   int64_t index_pos = sizeof(e) * int64_t(block_header::num_from_id(id));
-   _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-   if ( _block_num_to_pos.tellg() < int64_t(index_pos + sizeof(e)) )
-      return false;
-   _block_num_to_pos.seekg( index_pos );
-   _block_num_to_pos.read( (char*)&e, sizeof(e) );
-
-   return e.block_id == id && e.block_size > 0;
+   optional<index_entry> e = read_index_entry( block_header::num_from_id(id) );
+   return e.valid() && e->block_id == id && e->block_size > 0;
 }
 
 block_id_type block_database::fetch_block_id( uint32_t block_num )const
 {
    assert( block_num != 0 );
-   index_entry e;
-   int64_t index_pos = sizeof(e) * int64_t(block_num);
-   _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-   if ( _block_num_to_pos.tellg() <= index_pos )
+   optional<index_entry> e = read_index_entry( block_num );
+   if( !e.valid() )
       FC_THROW_EXCEPTION(fc::key_not_found_exception, "Block number ${block_num} not contained in block database", ("block_num", block_num));
 
-   _block_num_to_pos.seekg( index_pos );
-   _block_num_to_pos.read( (char*)&e, sizeof(e) );
-
-   FC_ASSERT( e.block_id != block_id_type(), "Empty block_id in block_database (maybe corrupt on disk?)" );
-   return e.block_id;
+   FC_ASSERT( e->block_id != block_id_type(), "Empty block_id in block_database (maybe corrupt on disk?)" );
+   return e->block_id;
 }
 
 optional<signed_block> block_database::fetch_optional( const block_id_type& id )const
 {
    try
    {
-      index_entry e;
-      int64_t index_pos = sizeof(e) * int64_t(block_header::num_from_id(id));
-      _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-      if ( _block_num_to_pos.tellg() <= index_pos )
-         return {};
-
-      _block_num_to_pos.seekg( index_pos );
-      _block_num_to_pos.read( (char*)&e, sizeof(e) );
-
-      if( e.block_id != id ) return optional<signed_block>();
-
-      vector<char> data( e.block_size );
-      _blocks.seekg( e.block_pos );
-      if (e.block_size)
-         _blocks.read( data.data(), e.block_size );
-      auto result = fc::raw::unpack<signed_block>(data);
-      FC_ASSERT( result.id() == e.block_id );
-      return result;
+      optional<index_entry> e = read_index_entry( block_header::num_from_id(id) );
+      if( !e.valid() || e->block_id != id ) return optional<signed_block>();
+
+      return read_block( *e );
    }
    catch (const fc::exception&)
    {
@@ -180,21 +255,10 @@ optional<signed_block> block_database::fetch_by_number( uint32_t block_num )cons
 {
    try
    {
-      index_entry e;
-      int64_t index_pos = sizeof(e) * int64_t(block_num);
-      _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-      if ( _block_num_to_pos.tellg() <= index_pos )
-         return {};
-
-      _block_num_to_pos.seekg( index_pos, _block_num_to_pos.beg );
-      _block_num_to_pos.read( (char*)&e, sizeof(e) );
-
-      vector<char> data( e.block_size );
-      _blocks.seekg( e.block_pos );
-      _blocks.read( data.data(), e.block_size );
-      auto result = fc::raw::unpack<signed_block>(data);
-      FC_ASSERT( result.id() == e.block_id );
-      return result;
+      optional<index_entry> e = read_index_entry( block_num );
+      if( !e.valid() ) return optional<signed_block>();
+
+      return read_block( *e );
    }
    catch (const fc::exception& e)
    {
@@ -209,35 +273,21 @@ optional<signed_block> block_database::fetch_by_number( uint32_t block_num )cons
 optional<index_entry> block_database::last_index_entry()const {
    try
    {
-      index_entry e;
-
-      _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-      std::streampos pos = _block_num_to_pos.tellg();
-      if( pos < long(sizeof(index_entry)) )
-         return optional<index_entry>();
+      optional<index_entry> result;
+      optional<uint64_t> truncate_at;
 
+      uint64_t pos = fc::exists( _index_filename ) ? fc::file_size( _index_filename ) : 0;
       pos -= pos % sizeof(index_entry);
-
-      _blocks.seekg( 0, _block_num_to_pos.end );
-      const std::streampos blocks_size = _blocks.tellg();
       while( pos > 0 )
       {
          pos -= sizeof(index_entry);
-         _block_num_to_pos.seekg( pos );
-         _block_num_to_pos.read( (char*)&e, sizeof(e) );
-         if( _block_num_to_pos.gcount() == sizeof(e) && e.block_size > 0
-                && int64_t(e.block_pos + e.block_size) <= blocks_size )
+         optional<index_entry> e = read_index_entry( pos / sizeof(index_entry) );
+         if( e.valid() && e->block_size > 0 )
             try
             {
-               vector<char> data( e.block_size );
-               _blocks.seekg( e.block_pos );
-               _blocks.read( data.data(), e.block_size );
-               if( _blocks.gcount() == long(e.block_size) )
-               {
-                  const signed_block block = fc::raw::unpack<signed_block>(data);
-                  if( block.id() == e.block_id )
-                     return e;
-               }
+               read_block( *e );
+               result = e;
+               break;
             }
             catch (const fc::exception&)
             {
@@ -245,8 +295,12 @@ optional<index_entry> block_database::last_index_entry()const {
             catch (const std::exception&)
             {
             }
-         fc::resize_file( _index_filename, pos );
+         truncate_at = pos;
       }
+
+      if( truncate_at.valid() )
+         truncate_index( *truncate_at );
+      return result;
    }
    catch (const fc::exception&)
    {
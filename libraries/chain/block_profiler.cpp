@@ -0,0 +1,253 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <graphene/chain/block_profiler.hpp>
+
+#include <graphene/chain/protocol/operations.hpp>
+
+#include <algorithm>
+#include <sstream>
+
+namespace graphene { namespace chain {
+
+namespace {
+
+const char* const stage_names[block_stage_count] = {
+   "transactions",
+   "global_dynamic_data",
+   "maintenance",
+   "upgrades",
+   "das33_distributions",
+   "expirations",
+   "witness_schedule",
+   "spending_limits",
+   "dascoin_rewards",
+   "daspay_clearing",
+   "delayed_operations",
+   "notify_applied_block",
+   "notify_changed_objects"
+};
+
+struct operation_name_visitor
+{
+   typedef std::string result_type;
+
+   template<typename T>
+   std::string operator()(const T&) const
+   {
+      std::string name = fc::get_typename<T>::name();
+      auto pos = name.rfind(':');
+      return pos == std::string::npos ? name : name.substr(pos + 1);
+   }
+};
+
+std::string operation_name(int which)
+{
+   operation op;
+   op.set_which(which);
+   return op.visit(operation_name_visitor());
+}
+
+void write_histogram(std::ostream& out, const std::string& metric, const std::string& labels,
+                     const latency_histogram& h)
+{
+   const auto& bounds = latency_histogram::bucket_bounds();
+   const std::string separator = labels.empty() ? "" : ",";
+   uint64_t cumulative = 0;
+   for (size_t i = 0; i < bounds.size(); ++i)
+   {
+      cumulative += h.buckets[i];
+      out << metric << "_bucket{" << labels << separator << "le=\"" << bounds[i] / 1000000.0 << "\"} "
+          << cumulative << "\n";
+   }
+   out << metric << "_bucket{" << labels << separator << "le=\"+Inf\"} " << h.count << "\n";
+   out << metric << "_sum" << (labels.empty() ? "" : "{" + labels + "}") << " " << h.sum_us / 1000000.0 << "\n";
+   out << metric << "_count" << (labels.empty() ? "" : "{" + labels + "}") << " " << h.count << "\n";
+}
+
+} // anonymous namespace
+
+const std::vector<uint64_t>& latency_histogram::bucket_bounds()
+{
+   static const std::vector<uint64_t> bounds{ 10, 50, 100, 500, 1000, 5000, 10000, 50000, 100000, 500000, 1000000 };
+   return bounds;
+}
+
+void latency_histogram::record(uint64_t us)
+{
+   const auto& bounds = bucket_bounds();
+   auto bucket = std::lower_bound(bounds.begin(), bounds.end(), us) - bounds.begin();
+   ++buckets[bucket];
+   ++count;
+   sum_us += us;
+   if (us > max_us)
+      max_us = us;
+}
+
+block_profiler::block_profiler()
+{
+   reset();
+}
+
+block_profiler::scoped_stage::scoped_stage(block_profiler& profiler, block_stage stage)
+   : _profiler(profiler), _stage(stage)
+{
+   if (_profiler.enabled())
+      _start = fc::time_point::now();
+}
+
+block_profiler::scoped_stage::~scoped_stage()
+{
+   if (_profiler.enabled() && _start != fc::time_point())
+      _profiler.record_stage(_stage, (fc::time_point::now() - _start).count());
+}
+
+block_profiler::scoped_operation::scoped_operation(block_profiler& profiler, int which)
+   : _profiler(profiler), _which(which)
+{
+   if (_profiler.enabled())
+      _start = fc::time_point::now();
+}
+
+block_profiler::scoped_operation::~scoped_operation()
+{
+   if (_profiler.enabled() && _start != fc::time_point())
+      _profiler.record_operation(_which, (fc::time_point::now() - _start).count(), !_succeeded);
+}
+
+void block_profiler::enable(bool enabled)
+{
+   if (enabled && !_enabled)
+      reset();
+   _enabled = enabled;
+}
+
+void block_profiler::record_stage(block_stage stage, uint64_t us)
+{
+   _stages[stage].record(us);
+}
+
+void block_profiler::record_operation(int which, uint64_t us, bool failed)
+{
+   if (which < 0 || static_cast<size_t>(which) >= _operations.size())
+      return;
+   _operations[which].record(us);
+   if (failed)
+      ++_failed_operations[which];
+}
+
+void block_profiler::record_block(uint64_t us)
+{
+   ++_blocks;
+   _block_latency.record(us);
+}
+
+void block_profiler::record_production(uint64_t us)
+{
+   _production_latency.record(us);
+}
+
+block_profile block_profiler::get_profile() const
+{
+   block_profile result;
+   result.enabled = _enabled;
+   result.blocks = _blocks;
+   result.since = _since;
+   result.block_latency = _block_latency;
+   result.production_latency = _production_latency;
+
+   result.stages.reserve(block_stage_count);
+   for (int i = 0; i < block_stage_count; ++i)
+   {
+      stage_profile stage;
+      stage.name = stage_names[i];
+      stage.latency = _stages[i];
+      result.stages.push_back(std::move(stage));
+   }
+
+   for (size_t i = 0; i < _operations.size(); ++i)
+   {
+      if (_operations[i].count == 0)
+         continue;
+      operation_profile op;
+      op.name = operation_name(i);
+      op.failed = _failed_operations[i];
+      op.latency = _operations[i];
+      result.operations.push_back(std::move(op));
+   }
+
+   return result;
+}
+
+std::string block_profiler::to_prometheus() const
+{
+   std::ostringstream out;
+
+   out << "# HELP graphene_blocks_applied_total Number of blocks applied since the profiler was reset.\n"
+       << "# TYPE graphene_blocks_applied_total counter\n"
+       << "graphene_blocks_applied_total " << _blocks << "\n";
+
+   out << "# HELP graphene_block_apply_seconds Time spent applying a block.\n"
+       << "# TYPE graphene_block_apply_seconds histogram\n";
+   write_histogram(out, "graphene_block_apply_seconds", "", _block_latency);
+
+   out << "# HELP graphene_block_production_seconds Time spent generating a block produced by this node.\n"
+       << "# TYPE graphene_block_production_seconds histogram\n";
+   write_histogram(out, "graphene_block_production_seconds", "", _production_latency);
+
+   out << "# HELP graphene_block_stage_seconds Time spent in each stage of applying a block.\n"
+       << "# TYPE graphene_block_stage_seconds histogram\n";
+   for (int i = 0; i < block_stage_count; ++i)
+      write_histogram(out, "graphene_block_stage_seconds", std::string("stage=\"") + stage_names[i] + "\"",
+                      _stages[i]);
+
+   out << "# HELP graphene_operation_seconds Time spent evaluating an operation, by operation type.\n"
+       << "# TYPE graphene_operation_seconds histogram\n";
+   for (size_t i = 0; i < _operations.size(); ++i)
+      if (_operations[i].count > 0)
+         write_histogram(out, "graphene_operation_seconds", "operation=\"" + operation_name(i) + "\"",
+                         _operations[i]);
+
+   out << "# HELP graphene_operation_failures_total Number of operations which failed to evaluate, by operation type.\n"
+       << "# TYPE graphene_operation_failures_total counter\n";
+   for (size_t i = 0; i < _operations.size(); ++i)
+      if (_operations[i].count > 0)
+         out << "graphene_operation_failures_total{operation=\"" << operation_name(i) << "\"} "
+             << _failed_operations[i] << "\n";
+
+   return out.str();
+}
+
+void block_profiler::reset()
+{
+   _blocks = 0;
+   _since = fc::time_point::now();
+   _block_latency = latency_histogram();
+   _production_latency = latency_histogram();
+   _stages.assign(block_stage_count, latency_histogram());
+   _operations.assign(operation::count(), latency_histogram());
+   _failed_operations.assign(operation::count(), 0);
+}
+
+} } // graphene::chain
@@ -25,6 +25,7 @@
 #include <graphene/chain/das33_evaluator.hpp>
 #include <graphene/chain/database.hpp>
 #include <boost/multiprecision/cpp_int.hpp>
+#include <graphene/chain/hardfork.hpp>
 #include <graphene/chain/market_object.hpp>
 
 namespace graphene { namespace chain {
@@ -499,8 +500,30 @@ namespace graphene { namespace chain {
 
     auto& d = db();
 
-    std::vector<object_id_type> pledges_to_remove;
+    das33_pending_distribution distribution;
+    distribution.phase_number = op.phase_number;
+    distribution.to_escrow = op.to_escrow;
+    distribution.base_to_pledger = op.base_to_pledger;
+    distribution.bonus_to_pledger = op.bonus_to_pledger;
+    distribution.timestamp = d.head_block_time();
+
     const auto& index = d.get_index_type<das33_pledge_holder_index>().indices().get<by_project>().equal_range(op.project);
+
+    // After the hardfork pledges are distributed over several blocks, see database::process_das33_distributions():
+    if(d.head_block_time() >= HARDFORK_DAS33_SPREAD_DISTRIBUTION_TIME)
+    {
+       if(index.first == index.second)
+          return {};
+
+       distribution.next_pledge = index.first->id;
+       distribution.last_pledge = std::prev(index.second)->id;
+       d.modify(op.project(d), [&](das33_project_object& p){
+          p.pending_distributions.push_back(distribution);
+       });
+       return {};
+    }
+
+    std::vector<object_id_type> pledges_to_remove;
     auto itr = index.first;
 
     while(itr != index.second)
@@ -512,51 +535,8 @@ namespace graphene { namespace chain {
 
        const das33_pledge_holder_object& pho = *itr;
 
-       // calc amount of token and asset that will be exchanged
-       share_type base = std::round(static_cast<double>(pho.base_expected.amount.value) * op.base_to_pledger.value / BONUS_PRECISION / 100);
-                  base = (base < pho.base_remaining.amount) ? base : pho.base_remaining.amount;
-       share_type bonus = std::round(static_cast<double>(pho.bonus_expected.amount.value) * op.bonus_to_pledger.value / BONUS_PRECISION / 100);
-                  bonus = (bonus < pho.bonus_remaining.amount) ? bonus : pho.bonus_remaining.amount;
-       share_type pledge = std::round(static_cast<double>(pho.pledged.amount.value) * op.to_escrow.value / BONUS_PRECISION / 100);
-                  pledge = (pledge < pho.pledge_remaining.amount) ? pledge : pho.pledge_remaining.amount;
-
-       // make virtual op for history traking
-       das33_pledge_result_operation pledge_result;
-          pledge_result.funders_account = pho.account_id;
-          pledge_result.account_to_fund = _pro_owner;
-          pledge_result.completed = true;
-          pledge_result.pledged = pledge;
-          pledge_result.received = base + bonus;
-          pledge_result.project_id = op.project;
-          pledge_result.timestamp = d.head_block_time();
-       d.push_applied_operation(pledge_result);
-
-       d.adjust_balance(_pro_owner, asset{pledge, pho.pledged.asset_id}, 0 /*reserved_delta*/);
-
-       // issue balance object if it does not exists
-       if(!d.check_if_balance_object_exists(pho.account_id,pho.base_expected.asset_id))
-       {
-          d.create<account_balance_object>([&pho](account_balance_object& abo){
-             abo.owner = pho.account_id;
-             abo.asset_type = pho.base_expected.asset_id;
-             abo.balance = 0;
-             abo.reserved = 0;
-          });
-       }
-
-       // issue token asset
-       auto& balance1_obj = d.get_balance_object(pho.account_id, pho.base_expected.asset_id);
-       d.issue_asset(balance1_obj, base + bonus, 0);
-
-       // update pledge holder object
-       d.modify(pho, [&](das33_pledge_holder_object& p){
-          p.pledge_remaining.amount -= pledge;
-          p.base_remaining.amount -= base;
-          p.bonus_remaining.amount -= bonus;
-       });
-
        // if everything is distributed remove object
-       if(pho.pledge_remaining.amount + pho.base_remaining.amount + pho.bonus_remaining.amount <= 0)
+       if(d.distribute_das33_pledge(pho, distribution, _pro_owner))
        {
           pledges_to_remove.push_back(pho.id);
        }
@@ -583,6 +563,7 @@ namespace graphene { namespace chain {
      auto& pro_index = d.get_index_type<das33_project_index>().indices().get<by_id>();
      auto pro_itr = pro_index.find(op.project);
      FC_ASSERT(pro_itr != pro_index.end(), "Missing project object with this project_id!");
+     FC_ASSERT(!pro_itr->has_pending_distributions(), "Project pledges are being distributed, can't be rejected!");
 
      auto& index = d.get_index_type<das33_pledge_holder_index>().indices().get<by_project>();
      auto itr = index.lower_bound(op.project);
@@ -654,6 +635,9 @@ namespace graphene { namespace chain {
      account_id_type pro_owner;
      FC_ASSERT(pro_itr != pro_index.end(), "Missing project object with this project_id!");
 
+     FC_ASSERT(!pro_itr->has_pending_distribution_for(itr->id, itr->phase_number),
+               "Pledge is being distributed to by its project, can't be distributed separately!");
+
      _pro_owner = pro_itr->owner;
      _pledge_holder_ptr = &(*itr);
 
@@ -667,51 +651,14 @@ namespace graphene { namespace chain {
      auto& d = db();
      const das33_pledge_holder_object& pho = *_pledge_holder_ptr;
 
-     // calc amount of token and asset that will be exchanged
-     share_type base = std::round(static_cast<double>(pho.base_expected.amount.value) * op.base_to_pledger.value / BONUS_PRECISION / 100);
-                base = (base < pho.base_remaining.amount) ? base : pho.base_remaining.amount;
-     share_type bonus = std::round(static_cast<double>(pho.bonus_expected.amount.value) * op.bonus_to_pledger.value / BONUS_PRECISION / 100);
-                bonus = (bonus < pho.bonus_remaining.amount) ? bonus : pho.bonus_remaining.amount;
-     share_type pledge = std::round(static_cast<double>(pho.pledged.amount.value) * op.to_escrow.value / BONUS_PRECISION / 100);
-                pledge = (pledge < pho.pledge_remaining.amount) ? pledge : pho.pledge_remaining.amount;
-
-     // make virtual op for history traking
-     das33_pledge_result_operation pledge_result;
-        pledge_result.funders_account = pho.account_id;
-        pledge_result.account_to_fund = _pro_owner;
-        pledge_result.completed = true;
-        pledge_result.pledged = pledge;
-        pledge_result.received = base + bonus;
-        pledge_result.project_id = pho.project_id;
-        pledge_result.timestamp = d.head_block_time();
-     d.push_applied_operation(pledge_result);
-
-     d.adjust_balance(_pro_owner, asset{pledge, pho.pledged.asset_id}, 0 /*reserved_delta*/);
-
-     // issue balance object if it does not exists
-     if(!d.check_if_balance_object_exists(pho.account_id,pho.base_expected.asset_id))
-     {
-        d.create<account_balance_object>([&pho](account_balance_object& abo){
-           abo.owner = pho.account_id;
-           abo.asset_type = pho.base_expected.asset_id;
-           abo.balance = 0;
-           abo.reserved = 0;
-        });
-     }
-
-     // issue token asset
-     auto& balance1_obj = d.get_balance_object(pho.account_id, pho.base_expected.asset_id);
-     d.issue_asset(balance1_obj, base + bonus, 0);
-
-     // update pledge holder object
-     d.modify(pho, [&](das33_pledge_holder_object& p){
-        p.pledge_remaining.amount -= pledge;
-        p.base_remaining.amount -= base;
-        p.bonus_remaining.amount -= bonus;
-     });
+     das33_pending_distribution distribution;
+     distribution.to_escrow = op.to_escrow;
+     distribution.base_to_pledger = op.base_to_pledger;
+     distribution.bonus_to_pledger = op.bonus_to_pledger;
+     distribution.timestamp = d.head_block_time();
 
      // if everything is distributed remove object
-     if(pho.pledge_remaining.amount + pho.base_remaining.amount + pho.bonus_remaining.amount <= 0)
+     if(d.distribute_das33_pledge(pho, distribution, _pro_owner))
      {
         d.remove(pho);
      }
@@ -742,6 +689,8 @@ namespace graphene { namespace chain {
            && pho.bonus_expected.amount == pho.bonus_remaining.amount
            && pho.pledged.amount == pho.pledge_remaining.amount,
            "Project already accepted, can't be rejected!");
+     FC_ASSERT(!pro_itr->has_pending_distribution_for(pho.id, pho.phase_number),
+               "Pledge is being distributed, can't be rejected!");
 
     return {};
 
@@ -0,0 +1,119 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <graphene/chain/das33_pledge_aggregate_index.hpp>
+
+#include <graphene/chain/das33_object.hpp>
+
+namespace graphene { namespace chain {
+
+namespace {
+
+/// Adds the pledge to the totals and returns true if no pledges are left in them.
+bool add_to_totals(das33_pledge_totals& totals, const das33_pledge_holder_object& pledge, int64_t sign)
+{
+    auto& pledged = totals.pledged[pledge.pledged.asset_id];
+    pledged.amount += sign * pledge.pledged.amount.value;
+    pledged.count += sign;
+    if (pledged.count == 0)
+        totals.pledged.erase(pledge.pledged.asset_id);
+
+    totals.base_expected += sign * pledge.base_expected.amount.value;
+    totals.bonus_expected += sign * pledge.bonus_expected.amount.value;
+    totals.count += sign;
+    return totals.count == 0;
+}
+
+template<typename Map>
+void update(Map& totals, const typename Map::key_type& key, const das33_pledge_holder_object& pledge, int64_t sign)
+{
+    if (add_to_totals(totals[key], pledge, sign))
+        totals.erase(key);
+}
+
+template<typename Map>
+const typename Map::mapped_type* find_totals(const Map& totals, const typename Map::key_type& key)
+{
+    auto it = totals.find(key);
+    return it == totals.end() ? nullptr : &it->second;
+}
+
+} // anonymous namespace
+
+void das33_pledge_aggregate_index::object_inserted(const object& obj)
+{
+    assert( dynamic_cast<const das33_pledge_holder_object*>(&obj) ); // for debug only
+    add(static_cast<const das33_pledge_holder_object&>(obj), 1);
+}
+
+void das33_pledge_aggregate_index::object_removed(const object& obj)
+{
+    assert( dynamic_cast<const das33_pledge_holder_object*>(&obj) ); // for debug only
+    add(static_cast<const das33_pledge_holder_object&>(obj), -1);
+}
+
+void das33_pledge_aggregate_index::about_to_modify(const object& before)
+{
+    assert( dynamic_cast<const das33_pledge_holder_object*>(&before) ); // for debug only
+    add(static_cast<const das33_pledge_holder_object&>(before), -1);
+}
+
+void das33_pledge_aggregate_index::object_modified(const object& after)
+{
+    assert( dynamic_cast<const das33_pledge_holder_object*>(&after) ); // for debug only
+    add(static_cast<const das33_pledge_holder_object&>(after), 1);
+}
+
+const das33_pledge_totals* das33_pledge_aggregate_index::get_project_totals(das33_project_id_type project) const
+{
+    return find_totals(_projects, project);
+}
+
+const das33_pledge_totals* das33_pledge_aggregate_index::get_phase_totals(das33_project_id_type project, share_type phase) const
+{
+    return find_totals(_phases, std::make_pair(project, phase));
+}
+
+const das33_pledge_aggregate_index::phase_totals_type*
+das33_pledge_aggregate_index::get_account_totals(account_id_type account) const
+{
+    return find_totals(_accounts, account);
+}
+
+void das33_pledge_aggregate_index::add(const das33_pledge_holder_object& pledge, int64_t sign)
+{
+    auto& account_totals = _accounts[pledge.account_id];
+    update(account_totals, std::make_pair(pledge.project_id, pledge.phase_number), pledge, sign);
+    if (account_totals.empty())
+        _accounts.erase(pledge.account_id);
+
+    // The null pledge holder created at genesis is not counted towards any project:
+    if (pledge.id == das33_pledge_holder_id_type())
+        return;
+
+    update(_projects, pledge.project_id, pledge, sign);
+    update(_phases, std::make_pair(pledge.project_id, pledge.phase_number), pledge, sign);
+}
+
+} }  // namespace graphene::chain
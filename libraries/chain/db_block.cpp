@@ -36,6 +36,9 @@
 #include <graphene/chain/exceptions.hpp>
 #include <graphene/chain/evaluator.hpp>
 
+#include <limits>
+#include <numeric>
+
 namespace graphene { namespace chain {
 
 bool database::is_known_block( const block_id_type& id )const
@@ -78,32 +81,31 @@ optional<signed_block> database::fetch_block_by_number( uint32_t num )const
 
 optional<signed_block_with_virtual_operations> database::fetch_block_with_virtual_operations_by_number( uint32_t block_num, std::vector<uint16_t> virtual_op_id_vec)const
 {
-   auto results = _fork_db.fetch_block_by_number(block_num);
-   optional<signed_block> ret;
-   if( results.size() == 1 )
-      ret = results[0]->data;
-   else
-      ret = _block_id_to_block.fetch_by_number(block_num);
+   std::vector<bool> virtual_op_filter( operation::count() );
+   for( auto vop_id : virtual_op_id_vec )
+      if( vop_id < virtual_op_filter.size() )
+         virtual_op_filter[vop_id] = true;
+   return fetch_block_with_virtual_operations_by_number( block_num, virtual_op_filter );
+}
+
+optional<signed_block_with_virtual_operations> database::fetch_block_with_virtual_operations_by_number( uint32_t block_num, const std::vector<bool>& virtual_op_filter)const
+{
+   auto ret = fetch_block_by_number( block_num );
+   if( !ret )
+      return {};
 
    signed_block_with_virtual_operations ret_v(*ret);
 
-   const auto& hist_idx = get_index_type<operation_history_index>();
-   const auto& by_blnum_idx = hist_idx.indices().get<by_blnum>();
-   auto itr = by_blnum_idx.lower_bound( block_num );
-   auto end = by_blnum_idx.upper_bound( block_num );
+   // Only the virtual operations of the block are visited, in the order they were applied
+   const auto& by_virtual_blnum_idx = get_index_type<operation_history_index>().indices().get<by_virtual_blnum>();
+   auto itr = by_virtual_blnum_idx.lower_bound( boost::make_tuple( true, block_num ) );
+   auto end = by_virtual_blnum_idx.upper_bound( boost::make_tuple( true, block_num ) );
 
-   while ( itr != end )
+   for( ; itr != end; ++itr )
    {
-      int jk = itr->op.which();
-      for(auto vop_id : virtual_op_id_vec)
-      {
-
-         if( jk == vop_id)
-         {
-            ret_v.virtual_operations.push_back(itr->op);
-         }
-      }
-      itr++;
+      const auto which = static_cast<size_t>( itr->op.which() );
+      if( which < virtual_op_filter.size() && virtual_op_filter[which] )
+         ret_v.virtual_operations.push_back(itr->op);
    }
 
    return ret_v;
@@ -159,6 +161,17 @@ bool database::push_block(const signed_block& new_block, uint32_t skip)
 bool database::_push_block(const signed_block& new_block)
 { try {
    uint32_t skip = get_node_properties().skip_flags;
+
+   // If this is the block generated by _generate_block(), its transactions were already applied on top of the head
+   // block. Any other block is applied to the state of the head block.
+   optional<undo_database::session> generated_session;
+   if( _generated_block_session.valid() )
+   {
+      if( _generated_block_id == new_block.id() )
+         generated_session = std::move( _generated_block_session );
+      _generated_block_session.reset();
+   }
+
    if( !(skip&skip_fork_db) )
    {
       /// TODO: if the block is greater than the head block and before the next maitenance interval
@@ -173,6 +186,7 @@ bool database::_push_block(const signed_block& new_block)
          if( new_head->data.block_num() > head_block_num() )
          {
             wlog( "Switching to fork: ${id}", ("id",new_head->data.id()) );
+            generated_session.reset();
             auto branches = _fork_db.fetch_branch_from(new_head->data.id(), head_block_id());
 
             // pop blocks until we hit the forked block
@@ -233,8 +247,9 @@ bool database::_push_block(const signed_block& new_block)
    }
 
    try {
-      auto session = _undo_db.start_undo_session();
-      apply_block(new_block, skip);
+      const bool transactions_applied = generated_session.valid();
+      auto session = transactions_applied ? std::move( *generated_session ) : _undo_db.start_undo_session();
+      apply_block(new_block, skip, transactions_applied);
       _block_id_to_block.store(new_block.id(), new_block);
       session.commit();
    } catch ( const fc::exception& e ) {
@@ -265,12 +280,29 @@ processed_transaction database::push_transaction( const signed_transaction& trx,
    return result;
 } FC_CAPTURE_AND_RETHROW( (trx) ) }
 
-processed_transaction database::_push_transaction( const signed_transaction& trx )
+processed_transaction database::push_transaction( const signed_transaction& trx, const precomputed_transaction_data& data,
+                                                   uint32_t skip )
+{ try {
+   processed_transaction result;
+   detail::with_skip_flags( *this, skip, [&]()
+   {
+      result = _push_transaction( trx, &data );
+   } );
+   return result;
+} FC_CAPTURE_AND_RETHROW( (trx) ) }
+
+processed_transaction database::_push_transaction( const signed_transaction& trx, const precomputed_transaction_data* data )
 {
    // If this is the first transaction pushed after applying a block, start a new undo session.
    // This allows us to quickly rewind to the clean state of the head block, in case a new block arrives.
    if( !_pending_tx_session.valid() )
+   {
       _pending_tx_session = _undo_db.start_undo_session();
+      // Pending transactions are applied as the transactions of the next block, so that a block generated from
+      // them does not need to apply them again, see _generate_block().
+      start_block_transactions();
+      _pending_tx_head = head_block_id();
+   }
 
    // Create a temporary undo session as a child of _pending_tx_session.
    // The temporary session will be discarded by the destructor if
@@ -278,8 +310,20 @@ processed_transaction database::_push_transaction( const signed_transaction& trx
    // apply the changes.
 
    auto temp_session = _undo_db.start_undo_session();
-   auto processed_trx = _apply_transaction( trx );
+   _current_trx_in_block = _pending_tx.size();
+   const size_t applied_ops = _applied_ops.size();
+   processed_transaction processed_trx;
+   try
+   {
+      processed_trx = _apply_transaction( trx, data );
+   }
+   catch( ... )
+   {
+      _applied_ops.resize( applied_ops );
+      throw;
+   }
    _pending_tx.push_back(processed_trx);
+   _pending_tx_sizes.push_back( fc::raw::pack_size( processed_trx ) );
 
    // notify_changed_objects();
    // The transaction applied successfully. Merge its changes into the pending block session.
@@ -293,7 +337,20 @@ processed_transaction database::_push_transaction( const signed_transaction& trx
 processed_transaction database::validate_transaction( const signed_transaction& trx )
 {
    auto session = _undo_db.start_undo_session();
-   return _apply_transaction( trx );
+   // Operations of the validated transaction must not end up among the operations of the pending transactions
+   const size_t applied_ops = _applied_ops.size();
+   processed_transaction result;
+   try
+   {
+      result = _apply_transaction( trx );
+   }
+   catch( ... )
+   {
+      _applied_ops.resize( applied_ops );
+      throw;
+   }
+   _applied_ops.resize( applied_ops );
+   return result;
 }
 
 processed_transaction database::push_proposal(const proposal_object& proposal)
@@ -366,6 +423,8 @@ signed_block database::_generate_block(
    if( !(skip & skip_witness_signature) )
       FC_ASSERT( witness_obj.signing_key == block_signing_private_key.get_public_key() );
 
+   const auto production_start = _block_profiler.enabled() ? fc::time_point::now() : fc::time_point();
+
    static const size_t max_block_header_size = fc::raw::pack_size( signed_block_header() ) + 4;
    auto maximum_block_size = get_global_properties().parameters.maximum_block_size;
    size_t total_block_size = max_block_header_size;
@@ -373,63 +432,68 @@ signed_block database::_generate_block(
    signed_block pending_block;
 
    //
-   // The following code throws away existing pending_tx_session and
-   // rebuilds it by re-applying pending transactions.
-   //
-   // This rebuild is necessary because pending transactions' validity
-   // and semantics may have changed since they were received, because
-   // time-based semantics are evaluated based on the current block
-   // time.  These changes can only be reflected in the database when
-   // the value of the "when" variable is known, which means we need to
-   // re-apply pending transactions in this method.
+   // Pending transactions are applied in order on top of the head block, as the transactions of the next block,
+   // see _push_transaction(). If all of them fit into the block, the pending state already is the state after
+   // applying them in the block and the block is generated from it.
    //
-   _pending_tx_session.reset();
-   _pending_tx_session = _undo_db.start_undo_session();
-
-   uint64_t postponed_tx_count = 0;
-   // pop pending state (reset to head block state)
-   for( const processed_transaction& tx : _pending_tx )
+   const size_t pending_size = std::accumulate( _pending_tx_sizes.begin(), _pending_tx_sizes.end(), size_t(0) );
+   if( _pending_tx_session.valid() && _pending_tx_head == head_block_id()
+       && total_block_size + pending_size < maximum_block_size )
+   {
+      pending_block.transactions.assign( _pending_tx.begin(), _pending_tx.end() );
+      total_block_size += pending_size;
+   }
+   else
    {
-      size_t new_total_size = total_block_size + fc::raw::pack_size( tx );
+      //
+      // Otherwise the pending state is thrown away and rebuilt by re-applying the pending transactions, postponing
+      // those which would make the block too big.
+      //
+      _pending_tx_session.reset();
+      _pending_tx_session = _undo_db.start_undo_session();
+      start_block_transactions();
 
-      // postpone transaction if it would make block too big
-      if( new_total_size >= maximum_block_size )
+      block_profiler::scoped_stage timer( _block_profiler, block_stage_transactions );
+      uint64_t postponed_tx_count = 0;
+      for( size_t i = 0; i < _pending_tx.size(); ++i )
       {
-         postponed_tx_count++;
-         continue;
-      }
+         const processed_transaction& tx = _pending_tx[i];
+         size_t new_total_size = total_block_size + _pending_tx_sizes[i];
 
-      try
-      {
-         auto temp_session = _undo_db.start_undo_session();
-         processed_transaction ptx = _apply_transaction( tx );
-         temp_session.merge();
-
-         // We have to recompute pack_size(ptx) because it may be different
-         // than pack_size(tx) (i.e. if one or more results increased
-         // their size)
-         total_block_size += fc::raw::pack_size( ptx );
-         pending_block.transactions.push_back( ptx );
+         // postpone transaction if it would make block too big
+         if( new_total_size >= maximum_block_size )
+         {
+            postponed_tx_count++;
+            continue;
+         }
+
+         const size_t applied_ops = _applied_ops.size();
+         try
+         {
+            auto temp_session = _undo_db.start_undo_session();
+            _current_trx_in_block = pending_block.transactions.size();
+            processed_transaction ptx = _apply_transaction( tx );
+            temp_session.merge();
+
+            // We have to recompute pack_size(ptx) because it may be different
+            // than pack_size(tx) (i.e. if one or more results increased
+            // their size)
+            total_block_size += fc::raw::pack_size( ptx );
+            pending_block.transactions.push_back( ptx );
+         }
+         catch ( const fc::exception& e )
+         {
+            _applied_ops.resize( applied_ops );
+            // Do nothing, transaction will not be re-applied
+            wlog( "Transaction was not processed while generating block due to ${e}", ("e", e) );
+            wlog( "The transaction was ${t}", ("t", tx) );
+         }
       }
-      catch ( const fc::exception& e )
+      if( postponed_tx_count > 0 )
       {
-         // Do nothing, transaction will not be re-applied
-         wlog( "Transaction was not processed while generating block due to ${e}", ("e", e) );
-         wlog( "The transaction was ${t}", ("t", tx) );
+         wlog( "Postponed ${n} transactions due to block size limit", ("n", postponed_tx_count) );
       }
    }
-   if( postponed_tx_count > 0 )
-   {
-      wlog( "Postponed ${n} transactions due to block size limit", ("n", postponed_tx_count) );
-   }
-
-   _pending_tx_session.reset();
-
-   // We have temporarily broken the invariant that
-   // _pending_tx_session is the result of applying _pending_tx, as
-   // _pending_tx now consists of the set of postponed transactions.
-   // However, the push_block() call below will re-create the
-   // _pending_tx_session.
 
    pending_block.previous = head_block_id();
    pending_block.timestamp = when;
@@ -445,8 +509,17 @@ signed_block database::_generate_block(
       FC_ASSERT( fc::raw::pack_size(pending_block) <= get_global_properties().parameters.maximum_block_size );
    }
 
+   // The state with the block's transactions applied is handed over to _push_block(), which applies the rest of the
+   // block on top of it. The push_block() call below re-creates the _pending_tx_session for postponed transactions.
+   _generated_block_id = pending_block.id();
+   _generated_block_session = std::move( _pending_tx_session );
+   _pending_tx_session.reset();
+
    push_block( pending_block, skip );
 
+   if( _block_profiler.enabled() && production_start != fc::time_point() )
+      _block_profiler.record_production( (fc::time_point::now() - production_start).count() );
+
    return pending_block;
 } FC_CAPTURE_AND_RETHROW( (witness_id) ) }
 
@@ -472,6 +545,7 @@ void database::clear_pending()
 { try {
    assert( (_pending_tx.size() == 0) || _pending_tx_session.valid() );
    _pending_tx.clear();
+   _pending_tx_sizes.clear();
    _pending_tx_session.reset();
 } FC_CAPTURE_AND_RETHROW() }
 
@@ -504,6 +578,11 @@ const vector<optional< operation_history_object > >& database::get_applied_opera
 //////////////////// private methods ////////////////////
 
 void database::apply_block( const signed_block& next_block, uint32_t skip )
+{
+   apply_block( next_block, skip, false );
+}
+
+void database::apply_block( const signed_block& next_block, uint32_t skip, bool transactions_applied )
 {
    auto block_num = next_block.block_num();
    if( _checkpoints.size() && _checkpoints.rbegin()->second != block_id_type() )
@@ -518,29 +597,25 @@ void database::apply_block( const signed_block& next_block, uint32_t skip )
 
    detail::with_skip_flags( *this, skip, [&]()
    {
-      _apply_block( next_block );
+      _apply_block( next_block, transactions_applied );
    } );
    return;
 }
 
 void database::applied_ops_to_virtual_ops( )
 {
+   if( _collected_virtual_ops.empty() )
+      _collected_virtual_ops.resize( std::numeric_limits<uint16_t>::max() + 1 );
+
    for(auto& ooho : _applied_ops)
    {
       if(ooho.valid())
       {
          operation_history_object& oho = *ooho;
-         if( operation_type_limits::is_virtual_operation(oho.op) )
+         if( operation_type_limits::is_virtual_operation(oho.op) && !_collected_virtual_ops[oho.virtual_op] )
          {
-            vector<optional< operation_history_object > >::iterator it = std::find_if(_virtual_ops.begin(),_virtual_ops.end(),
-                  [&oho](optional<operation_history_object > const& e){
-                     return e->virtual_op == oho.virtual_op;
-            });
-
-            if(it == _virtual_ops.end())
-            {
-               _virtual_ops.push_back(ooho);
-            }
+            _collected_virtual_ops[oho.virtual_op] = true;
+            _virtual_ops.push_back(ooho);
          }
       }
    }
@@ -550,15 +625,26 @@ vector<optional< operation_history_object > > database::get_virtual_ops_and_clea
 {
    vector<optional< operation_history_object > > ret;
    std::swap(ret, _virtual_ops);
-   return std::move(ret);
+   for( const auto& ooho : ret )
+      _collected_virtual_ops[ooho->virtual_op] = false;
+   return ret;
+}
+
+void database::start_block_transactions()
+{
+   applied_ops_to_virtual_ops();
+   _applied_ops.clear();
+   _current_block_num    = head_block_num() + 1;
+   _current_trx_in_block = 0;
+   _undo_db.reset_stats();
 }
 
-void database::_apply_block( const signed_block& next_block )
+void database::_apply_block( const signed_block& next_block, bool transactions_applied )
 { try {
    uint32_t next_block_num = next_block.block_num();
    uint32_t skip = get_node_properties().skip_flags;
-   applied_ops_to_virtual_ops();
-   _applied_ops.clear();
+   if( !transactions_applied )
+      start_block_transactions();
 
    FC_ASSERT( (skip & skip_merkle_check) || next_block.transaction_merkle_root == next_block.calculate_merkle_root(), "", ("next_block.transaction_merkle_root",next_block.transaction_merkle_root)("calc",next_block.calculate_merkle_root())("next_block",next_block)("id",next_block.id()) );
 
@@ -567,64 +653,118 @@ void database::_apply_block( const signed_block& next_block )
    const auto& dynamic_global_props = get<dynamic_global_property_object>(dynamic_global_property_id_type());
    bool maint_needed = (dynamic_global_props.next_maintenance_time <= next_block.timestamp);
 
+   const auto block_start = _block_profiler.enabled() ? fc::time_point::now() : fc::time_point();
    _current_block_num    = next_block_num;
-   _current_trx_in_block = 0;
 
-   for( const auto& trx : next_block.transactions )
+   // Transactions of a block generated by this node were applied while generating it
+   if( transactions_applied )
+      _current_trx_in_block = next_block.transactions.size();
+   else
    {
-      /* We do not need to push the undo state for each transaction
-       * because they either all apply and are valid or the
-       * entire block fails to apply.  We only need an "undo" state
-       * for transactions when validating broadcast transactions or
-       * when building a block.
-       */
-      apply_transaction( trx, skip | skip_transaction_signatures );
-      ++_current_trx_in_block;
+      block_profiler::scoped_stage timer( _block_profiler, block_stage_transactions );
+      for( const auto& trx : next_block.transactions )
+      {
+         /* We do not need to push the undo state for each transaction
+          * because they either all apply and are valid or the
+          * entire block fails to apply.  We only need an "undo" state
+          * for transactions when validating broadcast transactions or
+          * when building a block.
+          */
+         apply_transaction( trx, skip | skip_transaction_signatures );
+         ++_current_trx_in_block;
+      }
    }
 
-   update_global_dynamic_data(next_block);
-   update_signing_witness(signing_witness, next_block);
-   update_last_irreversible_block();
+   {
+      block_profiler::scoped_stage timer( _block_profiler, block_stage_global_dynamic_data );
+      update_global_dynamic_data(next_block);
+      update_signing_witness(signing_witness, next_block);
+      update_last_irreversible_block();
+   }
 
    // Are we at the maintenance interval?
    if( maint_needed )
+   {
+      block_profiler::scoped_stage timer( _block_profiler, block_stage_maintenance );
       perform_chain_maintenance(next_block, global_props);
+   }
 
-   create_block_summary(next_block);
-   clear_expired_transactions();
-   clear_expired_proposals();
-   clear_expired_orders();
-   update_expired_feeds();
-   update_withdraw_permissions();
+   // Upgrade events started by a maintenance are executed over the following blocks:
+   {
+      block_profiler::scoped_stage timer( _block_profiler, block_stage_upgrades );
+      continue_upgrades();
+   }
+
+   // Pledge distributions of das33 projects are executed over several blocks as well:
+   {
+      block_profiler::scoped_stage timer( _block_profiler, block_stage_das33_distributions );
+      process_das33_distributions();
+   }
+
+   {
+      block_profiler::scoped_stage timer( _block_profiler, block_stage_expirations );
+      create_block_summary(next_block);
+      clear_expired_transactions();
+      clear_expired_proposals();
+      clear_expired_orders();
+      update_expired_feeds();
+      update_withdraw_permissions();
+   }
 
-   // n.b., update_maintenance_flag() happens this late
-   // because get_slot_time() / get_slot_at_time() is needed above
-   // TODO:  figure out if we could collapse this function into
-   // update_global_dynamic_data() as perhaps these methods only need
-   // to be called for header validation?
-   update_maintenance_flag( maint_needed );
-   update_witnesses();
-   update_witness_schedule();
+   {
+      block_profiler::scoped_stage timer( _block_profiler, block_stage_witness_schedule );
+      // n.b., update_maintenance_flag() happens this late
+      // because get_slot_time() / get_slot_at_time() is needed above
+      // TODO:  figure out if we could collapse this function into
+      // update_global_dynamic_data() as perhaps these methods only need
+      // to be called for header validation?
+      update_maintenance_flag( maint_needed );
+      update_witnesses();
+      update_witness_schedule();
+   }
 
-   reset_spending_limits();
+   {
+      block_profiler::scoped_stage timer( _block_profiler, block_stage_spending_limits );
+      reset_spending_limits();
+   }
 
    if ( global_props.parameters.enable_dascoin_queue )
+   {
+      block_profiler::scoped_stage timer( _block_profiler, block_stage_dascoin_rewards );
       mint_dascoin_rewards();
+   }
 
    if ( global_props.daspay_parameters.clearing_enabled )
+   {
+     block_profiler::scoped_stage timer( _block_profiler, block_stage_daspay_clearing );
      daspay_clearing_start();
+   }
 
    if ( global_props.delayed_operations_resolver_enabled )
+   {
+     block_profiler::scoped_stage timer( _block_profiler, block_stage_delayed_operations );
      resolve_delayed_operations();
+   }
 
    if( !_node_property_object.debug_updates.empty() )
       apply_debug_updates();
 
    // notify observers that the block has been applied
-   notify_applied_block( next_block ); //emit
+   {
+      block_profiler::scoped_stage timer( _block_profiler, block_stage_notify_applied_block );
+      notify_applied_block( next_block ); //emit
+   }
    _applied_ops.clear();
 
-   notify_changed_objects();
+   {
+      block_profiler::scoped_stage timer( _block_profiler, block_stage_notify_changed_objects );
+      notify_changed_objects();
+   }
+
+   _last_block_undo_stats = _undo_db.stats();
+
+   if( _block_profiler.enabled() && block_start != fc::time_point() )
+      _block_profiler.record_block( (fc::time_point::now() - block_start).count() );
 } FC_CAPTURE_AND_RETHROW( (next_block.block_num()) )  }
 
 processed_transaction database::apply_transaction(const signed_transaction& trx, uint32_t skip)
@@ -637,27 +777,51 @@ processed_transaction database::apply_transaction(const signed_transaction& trx,
    return result;
 }
 
-processed_transaction database::_apply_transaction(const signed_transaction& trx)
+void database::verify_tapos( const signed_transaction& trx )const
+{
+   const auto& tapos_block_summary = block_summary_id_type( trx.ref_block_num )(*this);
+
+   //Verify TaPoS block summary has correct ID prefix, and that this block's time is not past the expiration
+   FC_ASSERT( trx.ref_block_prefix == tapos_block_summary.block_id._hash[1] );
+}
+
+void database::verify_expiration( const signed_transaction& trx )const
+{
+   fc::time_point_sec now = head_block_time();
+   const chain_parameters& chain_parameters = get_global_properties().parameters;
+
+   FC_ASSERT( trx.expiration <= now + chain_parameters.maximum_time_until_expiration, "",
+              ("trx.expiration",trx.expiration)("now",now)("max_til_exp",chain_parameters.maximum_time_until_expiration));
+   FC_ASSERT( now <= trx.expiration, "", ("now",now)("trx.exp",trx.expiration) );
+}
+
+processed_transaction database::_apply_transaction(const signed_transaction& trx, const precomputed_transaction_data* data)
 { try {
    uint32_t skip = get_node_properties().skip_flags;
 
-   if( true || !(skip&skip_validate) )   /* issue #505 explains why this skip_flag is disabled */
+   // Precomputed data was produced by trx.validate(), so validation is not repeated
+   if( !data && ( true || !(skip&skip_validate) ) )   /* issue #505 explains why this skip_flag is disabled */
       trx.validate();
 
    auto& trx_idx = get_mutable_index_type<transaction_index>();
    const chain_id_type& chain_id = get_chain_id();
-   auto trx_id = trx.id();
-   FC_ASSERT( (skip & skip_transaction_dupe_check) ||
+   // The id is only needed for the dupe check, so replay does not pay for hashing every transaction
+   const bool check_dupes = !(skip & skip_transaction_dupe_check);
+   const transaction_id_type trx_id = data ? data->id : check_dupes ? trx.id() : transaction_id_type();
+   FC_ASSERT( !check_dupes ||
               trx_idx.indices().get<by_trx_id>().find(trx_id) == trx_idx.indices().get<by_trx_id>().end() );
    transaction_evaluation_state eval_state(this);
-   const chain_parameters& chain_parameters = get_global_properties().parameters;
    eval_state._trx = &trx;
 
    if( !(skip & (skip_transaction_signatures | skip_authority_check) ) )
    {
       auto get_active = [&]( account_id_type id ) { return &id(*this).active; };
       auto get_owner  = [&]( account_id_type id ) { return &id(*this).owner;  };
-      trx.verify_authority( chain_id, get_active, get_owner, get_global_properties().parameters.max_authority_depth );
+      if( data )
+         graphene::chain::verify_authority( trx.operations, data->signature_keys, get_active, get_owner,
+                                            get_global_properties().parameters.max_authority_depth );
+      else
+         trx.verify_authority( chain_id, get_active, get_owner, get_global_properties().parameters.max_authority_depth );
    }
 
    //Skip all manner of expiration and TaPoS checking if we're on block 1; It's impossible that the transaction is
@@ -665,22 +829,13 @@ processed_transaction database::_apply_transaction(const signed_transaction& trx
    if( BOOST_LIKELY(head_block_num() > 0) )
    {
       if( !(skip & skip_tapos_check) )
-      {
-         const auto& tapos_block_summary = block_summary_id_type( trx.ref_block_num )(*this);
-
-         //Verify TaPoS block summary has correct ID prefix, and that this block's time is not past the expiration
-         FC_ASSERT( trx.ref_block_prefix == tapos_block_summary.block_id._hash[1] );
-      }
-
-      fc::time_point_sec now = head_block_time();
+         verify_tapos( trx );
 
-      FC_ASSERT( trx.expiration <= now + chain_parameters.maximum_time_until_expiration, "",
-                 ("trx.expiration",trx.expiration)("now",now)("max_til_exp",chain_parameters.maximum_time_until_expiration));
-      FC_ASSERT( now <= trx.expiration, "", ("now",now)("trx.exp",trx.expiration) );
+      verify_expiration( trx );
    }
 
    //Insert transaction into unique transactions database.
-   if( !(skip & skip_transaction_dupe_check) )
+   if( check_dupes )
    {
       create<transaction_object>([&](transaction_object& transaction) {
          transaction.trx_id = trx_id;
@@ -719,9 +874,11 @@ operation_result database::apply_operation(transaction_evaluation_state& eval_st
    unique_ptr<op_evaluator>& eval = _operation_evaluators[ u_which ];
    if( !eval )
       assert( "No registered evaluator for this operation" && false );
+   block_profiler::scoped_operation timer( _block_profiler, i_which );
    auto op_id = push_applied_operation( op );
    auto result = eval->evaluate( eval_state, op, true );
    set_applied_operation_result( op_id, result );
+   timer.succeeded();
    return result;
 } FC_CAPTURE_AND_RETHROW(  ) }
 
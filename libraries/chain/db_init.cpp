@@ -39,10 +39,12 @@
 #include <graphene/chain/global_property_object.hpp>
 #include <graphene/chain/issued_asset_record_object.hpp>
 #include <graphene/chain/license_objects.hpp>
+#include <graphene/chain/limit_order_price_level_index.hpp>
 #include <graphene/chain/market_object.hpp>
 #include <graphene/chain/operation_history_object.hpp>
 #include <graphene/chain/proposal_object.hpp>
 #include <graphene/chain/queue_objects.hpp>
+#include <graphene/chain/queue_projection_index.hpp>
 #include <graphene/chain/special_authority_object.hpp>
 #include <graphene/chain/transaction_object.hpp>
 #include <graphene/chain/vesting_balance_object.hpp>
@@ -56,6 +58,7 @@
 #include <graphene/chain/worker_object.hpp>
 #include <graphene/chain/daspay_object.hpp>
 #include <graphene/chain/das33_object.hpp>
+#include <graphene/chain/das33_pledge_aggregate_index.hpp>
 
 #include <graphene/chain/account_evaluator.hpp>
 #include <graphene/chain/asset_evaluator.hpp>
@@ -318,10 +321,14 @@ void database::initialize_indexes()
    auto acnt_index = add_index< primary_index<account_index> >();
    acnt_index->add_secondary_index<account_member_index>();
    acnt_index->add_secondary_index<account_referrer_index>();
+   acnt_index->add_secondary_index<account_vault_index>();
+   auto dasc_holders = acnt_index->add_secondary_index<dasc_holder_index>( this );
+   auto queue_projection = acnt_index->add_secondary_index<queue_projection_index>( this );
 
    add_index< primary_index<committee_member_index> >();
    add_index< primary_index<witness_index> >();
-   add_index< primary_index<limit_order_index > >();
+   auto limit_order_idx = add_index< primary_index<limit_order_index > >();
+   limit_order_idx->add_secondary_index<limit_order_price_level_index>( this );
    add_index< primary_index<last_price_index > >();
    add_index< primary_index<external_price_index > >();
    add_index< primary_index<call_order_index > >();
@@ -337,7 +344,8 @@ void database::initialize_indexes()
 
    //Implementation object indexes
    add_index< primary_index<transaction_index                             > >();
-   add_index< primary_index<account_balance_index                         > >();
+   auto balance_index = add_index< primary_index<account_balance_index> >();
+   balance_index->add_secondary_index<dasc_holder_balance_index>( dasc_holders );
    add_index< primary_index<asset_bitasset_data_index                     > >();
    add_index< primary_index<simple_index<global_property_object          >> >();
    add_index< primary_index<simple_index<dynamic_global_property_object  >> >();
@@ -358,7 +366,8 @@ void database::initialize_indexes()
    add_index<primary_index<issue_asset_request_index>>();
    add_index<primary_index<wire_out_holder_index>>();
    add_index<primary_index<reward_queue_index>>();
-   add_index<primary_index<license_information_index>>();
+   auto license_info_index = add_index<primary_index<license_information_index>>();
+   license_info_index->add_secondary_index<queue_projection_license_index>( queue_projection );
    add_index<primary_index<issued_asset_record_index>>();
    add_index<primary_index<frequency_history_record_index>>();
    add_index<primary_index<witness_delegate_data_index > >();
@@ -366,7 +375,8 @@ void database::initialize_indexes()
    add_index<primary_index<daspay_authority_index>>();
    add_index<primary_index<payment_service_provider_index>>();
    add_index<primary_index<das33_project_index>>();
-   add_index<primary_index<das33_pledge_holder_index>>();
+   auto das33_pledge_idx = add_index<primary_index<das33_pledge_holder_index>>();
+   das33_pledge_idx->add_secondary_index<das33_pledge_aggregate_index>();
    add_index<primary_index<delayed_operations_index>>();
    add_index<primary_index<withdrawal_limit_index>>();
 }
@@ -38,6 +38,7 @@
 #include <graphene/chain/committee_member_object.hpp>
 #include <graphene/chain/fba_object.hpp>
 #include <graphene/chain/global_property_object.hpp>
+#include <graphene/chain/license_objects.hpp>
 #include <graphene/chain/market_object.hpp>
 #include <graphene/chain/special_authority_object.hpp>
 #include <graphene/chain/upgrade_event_object.hpp>
@@ -746,6 +747,8 @@ void database::perform_upgrades(const account_object& account, const upgrade_eve
    const auto& cycle_balance_obj = get_cycle_balance_object(account.id);
    const auto& license_info_obj = (*account.license_information)(*this);
    const auto& cutoff_time = upgrade.cutoff_time.valid() ? *(upgrade.cutoff_time) : upgrade.execution_time;
+   // An execution spread over several blocks behaves as if it all happened when it started:
+   const auto upgrade_time = upgrade.in_progress() ? upgrade.execution_started : head_block_time();
 
    // Upgrade each license:
    modify(license_info_obj, [&](license_information_object& lio) {
@@ -755,6 +758,10 @@ void database::perform_upgrades(const account_object& account, const upgrade_eve
                                         [&upgrade](const pair<upgrade_event_id_type, time_point_sec>& upgrade_and_time){
                                             return upgrade_and_time.first == upgrade.id;
                                       });
+         // Licenses issued after the execution started are left for the next one:
+         if ( upgrade.in_progress() && license_history.issued_on_blockchain > upgrade_time )
+            continue;
+
          // If not upgraded by this upgrade, proceed with it:
          if ( license_history.upgrades.end() == upgrade_it && license_history.balance_upgrade.has_remaining_upgrades() )
          {
@@ -822,7 +829,7 @@ void database::perform_upgrades(const account_object& account, const upgrade_eve
                      update_balance = true;
                   }
                }
-               license_history.upgrades.emplace_back(std::make_pair(upgrade.id, head_block_time()));
+               license_history.upgrades.emplace_back(std::make_pair(upgrade.id, upgrade_time));
             }
          }
       }
@@ -871,8 +878,16 @@ void database::perform_upgrades()
      return false;
    };
 
-   optional<upgrade_event_object> last_upgrade{};
    const auto& idx = get_index_type<upgrade_event_index>().indices().get<by_id>();
+
+   // An execution still in progress must be finished before any event is executed again:
+   for ( auto it = idx.cbegin(); it != idx.cend(); ++it )
+      if ( it->in_progress() )
+         continue_upgrade(*it, std::numeric_limits<uint32_t>::max());
+
+   const bool spread = head_block_time() >= HARDFORK_SPREAD_UPGRADES_TIME;
+   const auto& license_idx = get_index_type<license_information_index>().indices().get<by_id>();
+
    for ( auto it = idx.cbegin(); it != idx.cend(); ++it )
    {
       if ( !should_execute_upgrade_event(*it) )
@@ -882,12 +897,60 @@ void database::perform_upgrades()
          obj.num_of_executions++;
       });
 
-      last_upgrade = *it;
+      // License holders are upgraded by continue_upgrades(), starting with this block:
+      if ( spread )
+      {
+         if ( !license_idx.empty() )
+            modify(*it, [&](upgrade_event_object& obj){
+               obj.execution_started = head_block_time();
+               obj.next_license_to_upgrade = license_idx.begin()->get_id();
+            });
+         continue;
+      }
+
       perform_upgrades_helper upgrades_helper(*this, *it);
       perform_helpers<account_index, by_name>(std::tie(upgrades_helper));
    }
 }
 
+uint32_t database::continue_upgrade(const upgrade_event_object& upgrade, uint32_t max_licenses)
+{
+   const auto& idx = get_index_type<license_information_index>().indices().get<by_id>();
+   const auto& cutoff_time = upgrade.cutoff_time.valid() ? *(upgrade.cutoff_time) : upgrade.execution_time;
+
+   // The walk goes by id, which issuing or upgrading licenses never changes, so every license holder is visited
+   // exactly once. Holders whose licenses were all activated after the cutoff time have nothing to upgrade:
+   auto it = idx.lower_bound(object_id_type(*upgrade.next_license_to_upgrade));
+   uint32_t visited = 0;
+   while ( it != idx.end() && visited < max_licenses )
+   {
+      const auto& license_info = *it++;
+      ++visited;
+      if ( license_info.earliest_activation() <= cutoff_time )
+         perform_upgrades(license_info.account(*this), upgrade);
+   }
+
+   if ( it == idx.end() )
+      modify(upgrade, [](upgrade_event_object& obj){
+         obj.next_license_to_upgrade.reset();
+      });
+   else
+      modify(upgrade, [&](upgrade_event_object& obj){
+         obj.next_license_to_upgrade = it->get_id();
+      });
+
+   return visited;
+}
+
+void database::continue_upgrades()
+{
+   uint32_t budget = DASCOIN_MAX_UPGRADES_PER_BLOCK;
+   const auto& idx = get_index_type<upgrade_event_index>().indices().get<by_id>();
+   for ( auto it = idx.cbegin(); it != idx.cend() && budget > 0; ++it )
+      if ( it->in_progress() )
+         budget -= continue_upgrade(*it, budget);
+}
+
 void database::perform_chain_maintenance(const signed_block& next_block, const global_property_object& global_props)
 {
    const auto& gpo = get_global_properties();
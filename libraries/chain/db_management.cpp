@@ -23,18 +23,134 @@
  */
 
 #include <graphene/chain/database.hpp>
+#include <graphene/chain/db_with.hpp>
 
 #include <graphene/chain/operation_history_object.hpp>
 #include <graphene/chain/protocol/fee_schedule.hpp>
 
 #include <fc/io/fstream.hpp>
+#include <fc/thread/thread.hpp>
 
+#include <atomic>
+#include <deque>
 #include <fstream>
 #include <functional>
 #include <iostream>
+#include <thread>
 
 namespace graphene { namespace chain {
 
+   /// Recorded in a state snapshot to tell which block the state belongs to.
+   struct snapshot_metadata
+   {
+      uint32_t               block_num = 0;
+      block_id_type          block_id;
+      chain_id_type          chain_id;
+      optional<signed_block> head_block;
+   };
+
+} }
+
+FC_REFLECT( graphene::chain::snapshot_metadata, (block_num)(block_id)(chain_id)(head_block) )
+
+namespace graphene { namespace chain {
+
+namespace {
+
+   /// A block read ahead of the apply loop, together with the stateless checks already run on it.
+   struct prefetched_block
+   {
+      optional<signed_block> block;
+      bool                   merkle_root_ok = false;
+   };
+
+   /**
+    *  Reads, unpacks and checks upcoming blocks on a small pool of threads so the apply loop only has to apply them.
+    *  At most window_size blocks are in flight; each one is handed out in block number order.
+    */
+   class block_prefetcher
+   {
+      public:
+         block_prefetcher( const block_database& blocks, uint32_t first, uint32_t last )
+            : _blocks( blocks ), _next( first ), _last( last )
+         {
+            const uint32_t thread_count = std::max( 1u, std::min( 4u, std::thread::hardware_concurrency() ) );
+            for( uint32_t i = 0; i < thread_count; ++i )
+               _threads.emplace_back( new fc::thread( "reindex_prefetch_" + std::to_string(i) ) );
+            _window_size = thread_count * 64;
+         }
+
+         ~block_prefetcher()
+         {
+            drain();
+         }
+
+         prefetched_block next()
+         {
+            fill();
+            FC_ASSERT( !_in_flight.empty() );
+            auto f = _in_flight.front();
+            _in_flight.pop_front();
+            auto wait_start = fc::time_point::now();
+            prefetched_block result = f.wait();
+            _stalled += fc::time_point::now() - wait_start;
+            fill();
+            return result;
+         }
+
+         /// Waits for all scheduled reads to finish, e.g. before the block files are modified.
+         void drain()
+         {
+            for( auto& f : _in_flight )
+               try { f.wait(); } catch( const fc::exception& ) {}
+            _in_flight.clear();
+         }
+
+         /// Time the prefetch threads spent reading and checking blocks, summed over all threads.
+         fc::microseconds busy_time()const { return fc::microseconds( _busy_us.load() ); }
+         /// Time the apply loop spent waiting for a block that was not ready yet.
+         fc::microseconds stalled_time()const { return _stalled; }
+
+      private:
+         void fill()
+         {
+            while( _in_flight.size() < _window_size && _next <= _last )
+            {
+               const uint32_t block_num = _next++;
+               auto& t = *_threads[ block_num % _threads.size() ];
+               _in_flight.push_back( t.async( [this, block_num]() { return prefetch( block_num ); },
+                                              "reindex_prefetch" ) );
+            }
+         }
+
+         prefetched_block prefetch( uint32_t block_num )
+         {
+            auto start = fc::time_point::now();
+            prefetched_block result;
+            result.block = _blocks.fetch_by_number( block_num );
+            if( result.block.valid() )
+               result.merkle_root_ok = ( result.block->transaction_merkle_root == result.block->calculate_merkle_root() );
+            _busy_us += ( fc::time_point::now() - start ).count();
+            return result;
+         }
+
+         const block_database&                  _blocks;
+         uint32_t                               _next;
+         const uint32_t                         _last;
+         size_t                                 _window_size;
+         std::vector<std::unique_ptr<fc::thread>> _threads;
+         std::deque<fc::future<prefetched_block>> _in_flight;
+         std::atomic<int64_t>                   _busy_us{0};
+         fc::microseconds                       _stalled;
+   };
+
+   double blocks_per_second( uint32_t blocks, const fc::microseconds& elapsed )
+   {
+      return elapsed.count() > 0 ? blocks * 1000000.0 / elapsed.count() : 0.0;
+   }
+
+} // anonymous namespace
+
 database::database()
 {
    initialize_indexes();
@@ -71,19 +187,37 @@ void database::reindex(fc::path data_dir)
    }
    else
       _undo_db.disable();
-   for( uint32_t i = head_block_num() + 1; i <= last_block_num; ++i )
+   const uint32_t first_block_num = head_block_num() + 1;
+   const uint32_t skip = skip_witness_signature |
+                         skip_transaction_signatures |
+                         skip_transaction_dupe_check |
+                         skip_tapos_check |
+                         skip_witness_schedule_check |
+                         skip_authority_check;
+   block_prefetcher prefetcher( _block_id_to_block, first_block_num, last_block_num );
+   fc::microseconds apply_time;
+   for( uint32_t i = first_block_num; i <= last_block_num; ++i )
    {
-      if( i % 10000 == 0 ) std::cerr << "   " << double(i*100)/last_block_num << "%   "<<i << " of " <<last_block_num<<"   \n";
+      if( i % 10000 == 0 )
+      {
+         const uint32_t replayed = i - first_block_num;
+         std::cerr << "   " << double(i*100)/last_block_num << "%   "<<i << " of " <<last_block_num
+                   << "   read " << blocks_per_second( replayed, prefetcher.busy_time() ) << " blocks/s per thread"
+                   << ", apply " << blocks_per_second( replayed, apply_time ) << " blocks/s"
+                   << ", apply waited " << double(prefetcher.stalled_time().count())/1000000.0 << " sec   \n";
+      }
       if( i == flush_point )
       {
          ilog( "Writing database to disk at block ${i}", ("i",i) );
          flush();
          ilog( "Done" );
       }
-      fc::optional< signed_block > block = _block_id_to_block.fetch_by_number(i);
+      prefetched_block prefetched = prefetcher.next();
+      const fc::optional< signed_block >& block = prefetched.block;
       if( !block.valid() )
       {
          wlog( "Reindexing terminated due to gap:  Block ${i} does not exist!", ("i", i) );
+         prefetcher.drain();
          uint32_t dropped_count = 0;
          while( true )
          {
@@ -103,23 +237,17 @@ void database::reindex(fc::path data_dir)
          wlog( "Dropped ${n} blocks from after the gap", ("n", dropped_count) );
          break;
       }
+      // A mismatching merkle root is left for _apply_block to report
+      const uint32_t block_skip = skip | ( prefetched.merkle_root_ok ? skip_merkle_check : 0 );
+      auto apply_start = fc::time_point::now();
       if( i < undo_point )
-         apply_block(*block, skip_witness_signature |
-                             skip_transaction_signatures |
-                             skip_transaction_dupe_check |
-                             skip_tapos_check |
-                             skip_witness_schedule_check |
-                             skip_authority_check);
+         apply_block(*block, block_skip);
       else
       {
          _undo_db.enable();
-         push_block(*block, skip_witness_signature |
-                            skip_transaction_signatures |
-                            skip_transaction_dupe_check |
-                            skip_tapos_check |
-                            skip_witness_schedule_check |
-                            skip_authority_check);
+         push_block(*block, block_skip);
       }
+      apply_time += fc::time_point::now() - apply_start;
    }
    _undo_db.enable();
    auto end = fc::time_point::now();
@@ -179,6 +307,74 @@ void database::open(
    FC_CAPTURE_LOG_AND_RETHROW( (data_dir) )
 }
 
+void database::open_from_snapshot(
+   const fc::path& data_dir,
+   const fc::path& snapshot_file,
+   std::function<genesis_state_type()> genesis_loader,
+   const std::string& db_version)
+{
+   try
+   {
+      // check the chain before the existing state is wiped
+      const chain_id_type chain_id = genesis_loader().compute_chain_id();
+      const auto metadata = fc::raw::unpack<snapshot_metadata>( read_snapshot_metadata( snapshot_file ) );
+      FC_ASSERT( metadata.chain_id == chain_id, "Snapshot ${f} is of chain ${s}, this node is configured for chain ${c}",
+                 ("f", snapshot_file)("s", metadata.chain_id)("c", chain_id) );
+
+      ilog( "Loading chain state from snapshot ${f}", ("f", snapshot_file) );
+      auto start = fc::time_point::now();
+
+      object_database::wipe( data_dir );
+      object_database::open( data_dir );
+      import_snapshot( snapshot_file );
+      FC_ASSERT( metadata.block_id == head_block_id() && metadata.chain_id == get_chain_id(),
+                 "Snapshot metadata does not match the state it holds",
+                 ("block_id", metadata.block_id)("head_block_id", head_block_id()) );
+
+      // the state now matches this build, so a later open() must not wipe it
+      std::ofstream version_file( (data_dir / "db_version").generic_string().c_str(),
+                                  std::ios::out | std::ios::binary | std::ios::trunc );
+      version_file.write( db_version.c_str(), db_version.size() );
+      version_file.close();
+
+      _block_id_to_block.open( data_dir / "database" / "block_num_to_block" );
+      if( metadata.head_block.valid() )
+      {
+         const auto stored = _block_id_to_block.fetch_by_number( metadata.block_num );
+         FC_ASSERT( !stored.valid() || stored->id() == metadata.block_id,
+                    "The block log holds a different block ${n} than the snapshot", ("n", metadata.block_num) );
+         // replay and the fork database expect to find the head block in the block log
+         if( !stored.valid() )
+            _block_id_to_block.store( metadata.block_id, *metadata.head_block );
+      }
+
+      ilog( "Loaded snapshot at block ${n} in ${t} sec",
+            ("n", metadata.block_num)("t", double((fc::time_point::now() - start).count()) / 1000000.0) );
+
+      fc::optional<block_id_type> last_block = _block_id_to_block.last_id();
+      if( last_block.valid() && block_header::num_from_id( *last_block ) > head_block_num() )
+         reindex( data_dir );
+   }
+   FC_CAPTURE_LOG_AND_RETHROW( (data_dir)(snapshot_file) )
+}
+
+void database::export_snapshot( const fc::path& snapshot_file )
+{ try {
+   detail::without_pending_transactions( *this, std::move(_pending_tx), [&]()
+   {
+      snapshot_metadata metadata;
+      metadata.block_num = head_block_num();
+      metadata.block_id = head_block_id();
+      metadata.chain_id = get_chain_id();
+      if( head_block_num() > 0 )
+         metadata.head_block = fetch_block_by_id( head_block_id() );
+
+      ilog( "Writing snapshot of block ${n} to ${f}", ("n", metadata.block_num)("f", snapshot_file) );
+      object_database::export_snapshot( snapshot_file, fc::raw::pack( metadata ) );
+      ilog( "Done" );
+   });
+} FC_CAPTURE_AND_RETHROW( (snapshot_file) ) }
+
 void database::close(bool rewind)
 {
    // TODO:  Save pending tx's on close()
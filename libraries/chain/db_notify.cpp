@@ -18,6 +18,8 @@
 #include <graphene/chain/witness_object.hpp>
 #include <graphene/chain/impacted.hpp>
 
+#include <algorithm>
+
 using namespace fc;
 using namespace graphene::chain;
 
@@ -796,57 +798,73 @@ void database::notify_on_pending_transaction( const signed_transaction& tx )
    GRAPHENE_TRY_NOTIFY( on_pending_transaction, tx )
 }
 
+void database::require_impacted_accounts()
+{
+   ++_impacted_accounts_subscribers;
+}
+
+void database::release_impacted_accounts()
+{
+   FC_ASSERT( _impacted_accounts_subscribers > 0 );
+   --_impacted_accounts_subscribers;
+}
+
 void database::notify_changed_objects()
 { try {
    if ( _undo_db.enabled() )
    {
       const auto& head_undo = _undo_db.head();
-      
+      const bool impacted_accounts_needed = _impacted_accounts_subscribers > 0;
+
       // New:
       if( !new_objects.empty() )
       {
-         vector<object_id_type> new_ids;  new_ids.reserve(head_undo.new_ids.size());
-         flat_set<account_id_type> new_accounts_impacted;
+         _notified_ids.clear();
+         _notified_accounts.clear();
          for( const auto& item : head_undo.new_ids )
          {
-            new_ids.push_back(item);
+            _notified_ids.push_back(item);
+            if( !impacted_accounts_needed )
+               continue;
             auto obj = find_object(item);
             if(obj != nullptr)
-               get_relevant_accounts(obj, new_accounts_impacted);
+               get_relevant_accounts(obj, _notified_accounts);
          }
 
-         new_objects(new_ids, new_accounts_impacted);
+         new_objects(_notified_ids, _notified_accounts);
       }
 
       // Changed:
       if( !changed_objects.empty() )
       {
-         vector<object_id_type> changed_ids;  changed_ids.reserve(head_undo.old_values.size());
-         flat_set<account_id_type> changed_accounts_impacted;
+         _notified_ids.clear();
+         _notified_accounts.clear();
          for( const auto& item : head_undo.old_values )
          {
-            changed_ids.push_back(item.first);
-            get_relevant_accounts(item.second.get(), changed_accounts_impacted);
+            _notified_ids.push_back(item.first);
+            if( impacted_accounts_needed )
+               get_relevant_accounts(item.second.get(), _notified_accounts);
          }
 
-         changed_objects(changed_ids, changed_accounts_impacted);
+         changed_objects(_notified_ids, _notified_accounts);
       }
 
       // Removed:
       if( !removed_objects.empty() )
       {
-         vector<object_id_type> removed_ids; removed_ids.reserve( head_undo.removed.size() );
-         vector<const object*> removed; removed.reserve( head_undo.removed.size() );
-         flat_set<account_id_type> removed_accounts_impacted;
+         _notified_ids.clear();
+         _notified_removed.clear();
+         _notified_accounts.clear();
          for( const auto& item : head_undo.removed )
          {
-            removed_ids.emplace_back( item.first );
+            _notified_ids.emplace_back( item.first );
             auto obj = item.second.get();
-            removed.emplace_back( obj );
-            get_relevant_accounts(obj, removed_accounts_impacted);
+            _notified_removed.emplace_back( obj );
+            if( impacted_accounts_needed )
+               get_relevant_accounts(obj, _notified_accounts);
          }
 
-         removed_objects(removed_ids, removed, removed_accounts_impacted);
+         removed_objects(_notified_ids, _notified_removed, _notified_accounts);
       }
    }
 } FC_CAPTURE_AND_LOG( (0) ) }
@@ -26,6 +26,7 @@
 #include <graphene/chain/db_with.hpp>
 
 #include <graphene/chain/asset_object.hpp>
+#include <graphene/chain/das33_object.hpp>
 #include <graphene/chain/global_property_object.hpp>
 #include <graphene/chain/hardfork.hpp>
 #include <graphene/chain/license_objects.hpp>
@@ -510,16 +511,25 @@ void database::reset_spending_limits()
 
   if ( dgpo.next_spend_limit_reset <= head_block_time() )
   {
-    // Reset spending limit for each account:
-    const auto& account_idx = get_index_type<account_index>().indices().get<by_id>();
-    for ( const auto& account : account_idx )
+    // Reset spending limit for each vault account, only vaults have a limit:
+    const auto& dascoin_id = get_dascoin_asset_id();
+    const auto& account_idx = dynamic_cast<const primary_index<account_index>&>(get_index_type<account_index>());
+    const auto& vaults = account_idx.get_secondary_index<account_vault_index>().vaults;
+    const auto& balance_idx = get_index_type<account_balance_index>().indices().get<by_account_asset>();
+    for ( const auto& vault_id : vaults )
     {
+      const auto& account = vault_id(*this);
       // TODO: price should be a weekly average price, not the last price at the moment of sampling.
       auto dsc_limit = get_dascoin_limit(account, dgpo.last_dascoin_price);
       if ( dsc_limit.valid() )
       {
+        // Nothing to do if the limit is unchanged and nothing was spent, this spares us an undo state copy:
+        auto balance_itr = balance_idx.find(boost::make_tuple(vault_id, dascoin_id));
+        if ( balance_itr != balance_idx.end() && balance_itr->limit == *dsc_limit && balance_itr->spent == 0 )
+          continue;
+
         // Set the limit on the account balance object:
-        adjust_balance_limit(account, get_dascoin_asset_id(), *dsc_limit, true);
+        adjust_balance_limit(account, dascoin_id, *dsc_limit, true);
       }
     }
 
@@ -718,6 +728,101 @@ void database::daspay_clearing_start()
 
 } FC_CAPTURE_AND_RETHROW() }
 
+bool database::distribute_das33_pledge(const das33_pledge_holder_object& pho, const das33_pending_distribution& distribution,
+                                       account_id_type project_owner)
+{
+  // calc amount of token and asset that will be exchanged
+  share_type base = std::round(static_cast<double>(pho.base_expected.amount.value) * distribution.base_to_pledger.value / BONUS_PRECISION / 100);
+             base = (base < pho.base_remaining.amount) ? base : pho.base_remaining.amount;
+  share_type bonus = std::round(static_cast<double>(pho.bonus_expected.amount.value) * distribution.bonus_to_pledger.value / BONUS_PRECISION / 100);
+             bonus = (bonus < pho.bonus_remaining.amount) ? bonus : pho.bonus_remaining.amount;
+  share_type pledge = std::round(static_cast<double>(pho.pledged.amount.value) * distribution.to_escrow.value / BONUS_PRECISION / 100);
+             pledge = (pledge < pho.pledge_remaining.amount) ? pledge : pho.pledge_remaining.amount;
+
+  // make virtual op for history traking
+  das33_pledge_result_operation pledge_result;
+     pledge_result.funders_account = pho.account_id;
+     pledge_result.account_to_fund = project_owner;
+     pledge_result.completed = true;
+     pledge_result.pledged = pledge;
+     pledge_result.received = base + bonus;
+     pledge_result.project_id = pho.project_id;
+     pledge_result.timestamp = distribution.timestamp;
+  push_applied_operation(pledge_result);
+
+  adjust_balance(project_owner, asset{pledge, pho.pledged.asset_id}, 0 /*reserved_delta*/);
+
+  // issue balance object if it does not exists
+  if(!check_if_balance_object_exists(pho.account_id, pho.base_expected.asset_id))
+  {
+     create<account_balance_object>([&pho](account_balance_object& abo){
+        abo.owner = pho.account_id;
+        abo.asset_type = pho.base_expected.asset_id;
+        abo.balance = 0;
+        abo.reserved = 0;
+     });
+  }
+
+  // issue token asset
+  auto& balance1_obj = get_balance_object(pho.account_id, pho.base_expected.asset_id);
+  issue_asset(balance1_obj, base + bonus, 0);
+
+  // update pledge holder object
+  modify(pho, [&](das33_pledge_holder_object& p){
+     p.pledge_remaining.amount -= pledge;
+     p.base_remaining.amount -= base;
+     p.bonus_remaining.amount -= bonus;
+  });
+
+  return pho.pledge_remaining.amount + pho.base_remaining.amount + pho.bonus_remaining.amount <= 0;
+}
+
+void database::process_das33_distributions()
+{ try {
+
+  uint32_t budget = DASCOIN_MAX_DAS33_PLEDGES_PER_BLOCK;
+  const auto& projects = get_index_type<das33_project_index>().indices().get<by_pending_distribution>();
+  const auto& pledges = get_index_type<das33_pledge_holder_index>().indices().get<by_project>();
+
+  // Distributions are executed one after another, in the order they were requested:
+  while ( budget > 0 )
+  {
+    auto pro_itr = projects.lower_bound(boost::make_tuple(true));
+    if ( pro_itr == projects.end() )
+      break;
+
+    const das33_project_object& project = *pro_itr;
+    const das33_project_id_type project_id = project.get_id();
+    const das33_pending_distribution distribution = project.pending_distributions.front();
+
+    // Pledge holders which were created after the distribution was requested are not part of it:
+    auto itr = pledges.lower_bound(boost::make_tuple(project_id, distribution.next_pledge));
+    const auto in_range = [&]() {
+      return itr != pledges.end() && itr->project_id == project_id && itr->id <= distribution.last_pledge;
+    };
+    for ( ; in_range() && budget > 0; --budget )
+    {
+      const das33_pledge_holder_object& pho = *itr++;
+      if ( distribution.phase_number.valid() && pho.phase_number != *distribution.phase_number )
+        continue;
+
+      // if everything is distributed remove object
+      if ( distribute_das33_pledge(pho, distribution, project.owner) )
+        remove(pho);
+    }
+
+    const bool done = !in_range();
+    const object_id_type next_pledge = done ? object_id_type() : itr->id;
+    modify(project, [&](das33_project_object& p){
+      if ( done )
+        p.pending_distributions.erase(p.pending_distributions.begin());
+      else
+        p.pending_distributions.front().next_pledge = next_pledge;
+    });
+  }
+
+} FC_CAPTURE_AND_RETHROW() }
+
 void database::resolve_delayed_operations()
 { try {
   const auto& params = get_global_properties();
@@ -726,19 +831,40 @@ void database::resolve_delayed_operations()
   if ( dgpo.next_delayed_operations_resolver_time > head_block_time() )
     return;
 
-  const auto& idx = get_index_type<delayed_operations_index>().indices().get<by_account>();
-  for (auto it = idx.cbegin(); it != idx.cend(); ++it)
+  // Only operations that are due are visited, in order of their due time:
+  const auto& idx = get_index_type<delayed_operations_index>().indices().get<by_due_time>();
+  const auto due_end = idx.upper_bound(boost::make_tuple(head_block_time()));
+  const bool capped = head_block_time() >= HARDFORK_DELAYED_OPERATIONS_CAP_TIME;
+
+  vector<const delayed_operation_object*> due;
+  bool carry_over = false;
+  for (auto it = idx.cbegin(); it != due_end; ++it)
   {
-    if (it->issued_time + it->skip <= head_block_time())
+    if (capped && due.size() == DASCOIN_MAX_DELAYED_OPERATIONS_PER_BLOCK)
     {
-      it->op.visit(op_visitor(*this));
-      remove(*it);
+      carry_over = true;
+      break;
     }
+    due.push_back(&*it);
   }
 
-  modify(dgpo, [&](dynamic_global_property_object& dgpo){
-    dgpo.next_delayed_operations_resolver_time = head_block_time() + params.delayed_operations_resolver_interval_time_seconds;
-  });
+  // Before the cap all due operations are resolved in account order, as they always were:
+  if (!capped)
+    std::sort(due.begin(), due.end(), [](const delayed_operation_object* a, const delayed_operation_object* b) {
+      return std::tie(a->account, a->id) < std::tie(b->account, b->id);
+    });
+
+  for (const auto* op : due)
+  {
+    op->op.visit(op_visitor(*this));
+    remove(*op);
+  }
+
+  // Whatever did not fit into this block is resolved in the next one:
+  if (!carry_over)
+    modify(dgpo, [&](dynamic_global_property_object& dgpo){
+      dgpo.next_delayed_operations_resolver_time = head_block_time() + params.delayed_operations_resolver_interval_time_seconds;
+    });
 
 } FC_CAPTURE_AND_RETHROW() }
 
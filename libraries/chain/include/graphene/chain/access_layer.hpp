@@ -71,6 +71,16 @@ struct total_cycles_res {
     {
     }
 
+    total_cycles_res operator+ (total_cycles_res const &obj)
+    {
+        return total_cycles_res{total_cycles + obj.total_cycles, total_dascoin + obj.total_dascoin};
+    }
+
+    total_cycles_res operator- (total_cycles_res const &obj)
+    {
+        return total_cycles_res{total_cycles - obj.total_cycles, total_dascoin - obj.total_dascoin};
+    }
+
     share_type total_cycles = 0;
     share_type total_dascoin = 0;
 };
@@ -88,6 +98,11 @@ struct cycles_res {
         return cycles_res{cycles + obj.cycles, dascoin + obj.dascoin};
     }
 
+    cycles_res operator- (cycles_res const &obj)
+    {
+        return cycles_res{cycles - obj.cycles, dascoin - obj.dascoin};
+    }
+
     share_type cycles = 0;
     share_type dascoin = 0;
 };
@@ -108,6 +123,11 @@ struct autosubmit_res {
         return autosubmit_res{charter + obj.charter, utility + obj.utility, package + obj.package, after_all_upgrades + obj.after_all_upgrades};
     }
 
+    autosubmit_res operator- (autosubmit_res const &obj)
+    {
+        return autosubmit_res{charter - obj.charter, utility - obj.utility, package - obj.package, after_all_upgrades - obj.after_all_upgrades};
+    }
+
     cycles_res total;
     cycles_res charter;
     cycles_res utility;
@@ -128,6 +148,11 @@ struct manual_submit_res {
         return manual_submit_res{tethered + obj.tethered, untethered + obj.untethered};
     }
 
+    manual_submit_res operator- (manual_submit_res const &obj)
+    {
+        return manual_submit_res{tethered - obj.tethered, untethered - obj.untethered};
+    }
+
     cycles_res tethered;
     cycles_res untethered;
 };
@@ -152,6 +177,14 @@ struct queue_projection_res {
                                     after_all_upgrades_manual_submit + obj.after_all_upgrades_manual_submit);
     }
 
+    queue_projection_res operator- (queue_projection_res const &obj)
+    {
+        return queue_projection_res(auto_submit - obj.auto_submit, total_locked_manual_submit - obj.total_locked_manual_submit,
+                                    next_upgrade_last_locked_manual_submit - obj.next_upgrade_last_locked_manual_submit,
+                                    utility_manual_submit - obj.utility_manual_submit, package_manual_submit - obj.package_manual_submit,
+                                    after_all_upgrades_manual_submit - obj.after_all_upgrades_manual_submit);
+    }
+
     autosubmit_res auto_submit;
     manual_submit_res total_locked_manual_submit;
     manual_submit_res next_upgrade_last_locked_manual_submit;
@@ -349,6 +382,11 @@ class reward_queue_object;
 using fc::optional;
 using fc::string;
 
+// Per vault cycle totals and queue projection, computed from the vault's license information:
+total_cycles_res calculate_total_cycles(const database& db, const license_information_object& license_information);
+queue_projection_res calculate_queue_state(const database& db, const account_object& vault,
+                                           const license_information_object& license_information);
+
 class database_access_layer {
   public:
     explicit database_access_layer(const database& db)
@@ -454,6 +492,17 @@ class database_access_layer {
         return vector<typename IndexType::object_type>(start, end);
     }
 
+    // Same as get_range, but for ranked indices, where the page is located in logarithmic time:
+    template <typename IndexType, typename IndexBy, int MAX_ELEMENTS = 100>
+    vector<typename IndexType::object_type> get_ranked_range(uint32_t from, uint32_t amount) const
+    {
+        const auto& idx = _db.get_index_type<IndexType>().indices().template get<IndexBy>();
+        FC_ASSERT(idx.size() > from, "Index out of bounds, index: ${from}, size: ${size}", ("from", from)("size", idx.size()));
+        FC_ASSERT(idx.size() - from >= amount, "Index out of bounds, amount: ${amount}, size: ${size}", ("amount", amount)("size", idx.size()));
+        FC_ASSERT(amount <= MAX_ELEMENTS, "Cannot retrieve more than ${max} elements in one page", ("max", MAX_ELEMENTS));
+        return vector<typename IndexType::object_type>(idx.nth(from), idx.nth(from + amount));
+    }
+
     template <typename ReturnType>
     vector<ReturnType> get_balance(const vector<account_id_type>& ids, const std::function<ReturnType(account_id_type)>& getter) const
     {
@@ -27,6 +27,8 @@
 #include <graphene/chain/upgrade_type.hpp>
 #include <graphene/db/generic_index.hpp>
 #include <boost/multi_index/composite_key.hpp>
+#include <boost/multi_index/identity.hpp>
+#include <boost/multi_index/ranked_index.hpp>
 
 namespace graphene { namespace chain {
    class database;
@@ -468,6 +470,95 @@ namespace graphene { namespace chain {
          map< account_id_type, set<account_id_type> > referred_by;
    };
 
+   /**
+    *  @brief This secondary index keeps the set of all vault accounts, so that work which only concerns vaults (like
+    *  the periodic spending limit reset) does not have to walk the whole account index.
+    *
+    *  An account's kind is set at creation and never changes, so only insertions and removals need to be tracked.
+    */
+   class account_vault_index : public secondary_index
+   {
+      public:
+         virtual void object_inserted( const object& obj ) override;
+         virtual void object_removed( const object& obj ) override;
+
+         /** all vault accounts, ordered by id */
+         set< account_id_type > vaults;
+   };
+
+   /**
+    *  @brief This secondary index keeps DASC holdings aggregated per holder and ordered by amount, so the top holders
+    *  can be read without scanning all accounts.
+    *
+    *  A holder is a wallet (its own balance and reserved DASC plus the balances of its tethered vaults), a custodian,
+    *  or a vault that is not tethered to any wallet. The index is attached to the account index and is also fed by
+    *  @ref dasc_holder_balance_index, which watches the account balance index. Every change recomputes the affected
+    *  holders from the current database state, so the index converges no matter in which order undo restores
+    *  accounts and balances.
+    */
+   class dasc_holder_index : public secondary_index
+   {
+      public:
+         struct holding
+         {
+            share_type       amount;
+            account_id_type  holder;
+
+            bool operator<( const holding& o )const
+            {
+               return amount > o.amount || ( amount == o.amount && holder < o.holder );
+            }
+         };
+
+         /** holders ordered by amount (descending), then by id, ranked so a page is found in logarithmic time */
+         typedef multi_index_container<
+            holding,
+            indexed_by< ranked_unique< identity<holding> > >
+         > ranking_type;
+
+         dasc_holder_index( const database* db ) : _db(*db) {}
+
+         virtual void object_inserted( const object& obj ) override;
+         virtual void object_removed( const object& obj ) override;
+         virtual void about_to_modify( const object& before ) override;
+         virtual void object_modified( const object& after  ) override;
+
+         /**
+          * Called by @ref dasc_holder_balance_index whenever a DASC balance of the owner changes.
+          * @param removed set if the balance object is about to be removed and must not be counted anymore
+          */
+         void balance_changed( account_id_type owner, optional<object_id_type> removed = {} );
+
+         const ranking_type& get_ranking()const { return _ranking; }
+
+      private:
+         void collect_affected( const account_object& a );
+         void update_affected();
+         void update( account_id_type holder );
+
+         const database&                      _db;
+         map< account_id_type, share_type >   _amounts;
+         ranking_type                         _ranking;
+         flat_set< account_id_type >          _affected;
+         optional< object_id_type >           _removed_balance;
+   };
+
+   /**
+    *  @brief Forwards DASC balance changes to the @ref dasc_holder_index.
+    */
+   class dasc_holder_balance_index : public secondary_index
+   {
+      public:
+         dasc_holder_balance_index( dasc_holder_index* holders ) : _holders(*holders) {}
+
+         virtual void object_inserted( const object& obj ) override;
+         virtual void object_removed( const object& obj ) override;
+         virtual void object_modified( const object& after  ) override;
+
+      private:
+         dasc_holder_index& _holders;
+   };
+
    struct by_account_asset;
    struct by_asset_balance;
    /**
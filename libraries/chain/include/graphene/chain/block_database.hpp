@@ -23,11 +23,18 @@
  */
 #pragma once
 #include <fstream>
+#include <memory>
+#include <mutex>
 #include <graphene/chain/protocol/block.hpp>
 
 namespace graphene { namespace chain {
    struct index_entry;
 
+   /**
+    *  Blocks are appended to the blocks file through a stream, while all lookups read both files through
+    *  read-only memory mappings. Index lookups are pointer arithmetic and blocks are unpacked in place, so
+    *  readers share no stream state and may run concurrently with each other and with the writer.
+    */
    class block_database
    {
       public:
@@ -46,9 +53,27 @@ namespace graphene { namespace chain {
          optional<signed_block> last()const;
          optional<block_id_type> last_id()const;
       private:
+         struct mapped_file;
+         typedef std::shared_ptr<const mapped_file> mapped_file_ptr;
+
          optional<index_entry> last_index_entry()const;
+         optional<index_entry> read_index_entry( uint32_t block_num )const;
+         signed_block read_block( const index_entry& e )const;
+         /**
+          * Returns a mapping whose first min_size bytes can be read, or a null pointer if the file is shorter. The
+          * mapping is replaced by a geometrically larger one only when the file outgrows it.
+          */
+         mapped_file_ptr map_file( mapped_file_ptr& current, const fc::path& filename, uint64_t min_size )const;
+         void unmap()const;
+         /// Cuts the index file down to @p size bytes once no reader uses the index mapping anymore.
+         void truncate_index( uint64_t size )const;
+
          fc::path _index_filename;
+         fc::path _blocks_filename;
          mutable std::fstream _blocks;
          mutable std::fstream _block_num_to_pos;
+         mutable std::mutex _map_mutex;
+         mutable mapped_file_ptr _index_map;
+         mutable mapped_file_ptr _blocks_map;
    };
 } }
@@ -0,0 +1,169 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <fc/reflect/reflect.hpp>
+#include <fc/time.hpp>
+
+#include <string>
+#include <vector>
+
+namespace graphene { namespace chain {
+
+/**
+ * Stages of database::_apply_block() which are timed separately.
+ */
+enum block_stage
+{
+   block_stage_transactions,
+   block_stage_global_dynamic_data,
+   block_stage_maintenance,
+   block_stage_upgrades,
+   block_stage_das33_distributions,
+   block_stage_expirations,
+   block_stage_witness_schedule,
+   block_stage_spending_limits,
+   block_stage_dascoin_rewards,
+   block_stage_daspay_clearing,
+   block_stage_delayed_operations,
+   block_stage_notify_applied_block,
+   block_stage_notify_changed_objects,
+   block_stage_count
+};
+
+/**
+ * Latency histogram with fixed, cumulative buckets (in microseconds), as expected by Prometheus.
+ */
+struct latency_histogram
+{
+   /// Upper bounds of the buckets, the last bucket is unbounded.
+   static const std::vector<uint64_t>& bucket_bounds();
+
+   latency_histogram() : buckets(bucket_bounds().size() + 1) {}
+
+   std::vector<uint64_t> buckets;
+   uint64_t count = 0;
+   uint64_t sum_us = 0;
+   uint64_t max_us = 0;
+
+   void record(uint64_t us);
+};
+
+struct stage_profile
+{
+   std::string name;
+   latency_histogram latency;
+};
+
+struct operation_profile
+{
+   std::string name;
+   uint64_t failed = 0;
+   latency_histogram latency;
+};
+
+struct block_profile
+{
+   bool enabled = false;
+   uint64_t blocks = 0;
+   fc::time_point since;
+   latency_histogram block_latency;
+   /// Time spent generating a block, including pushing it, for blocks produced by this node.
+   latency_histogram production_latency;
+   std::vector<stage_profile> stages;
+   /// Only operation types which have been applied at least once are reported.
+   std::vector<operation_profile> operations;
+};
+
+/**
+ * @brief Collects per-stage timings of applied blocks and per-operation-type evaluation latencies.
+ *
+ * Operations are timed in database::apply_operation(), so operations evaluated when pushing transactions, generating
+ * blocks or inside proposals are counted as well. When disabled, timers cost a single branch.
+ */
+class block_profiler
+{
+   public:
+      block_profiler();
+
+      /// Times a stage of the block which is being applied, for the lifetime of the object.
+      class scoped_stage
+      {
+         public:
+            scoped_stage(block_profiler& profiler, block_stage stage);
+            ~scoped_stage();
+
+         private:
+            block_profiler& _profiler;
+            block_stage _stage;
+            fc::time_point _start;
+      };
+
+      /// Times evaluation of a single operation, which is considered failed unless @ref succeeded is called.
+      class scoped_operation
+      {
+         public:
+            scoped_operation(block_profiler& profiler, int which);
+            ~scoped_operation();
+
+            void succeeded() { _succeeded = true; }
+
+         private:
+            block_profiler& _profiler;
+            int _which;
+            fc::time_point _start;
+            bool _succeeded = false;
+      };
+
+      bool enabled() const { return _enabled; }
+      void enable(bool enabled);
+
+      void record_stage(block_stage stage, uint64_t us);
+      void record_operation(int which, uint64_t us, bool failed);
+      void record_block(uint64_t us);
+      void record_production(uint64_t us);
+
+      block_profile get_profile() const;
+      /// Returns the collected metrics in the Prometheus text exposition format.
+      std::string to_prometheus() const;
+      void reset();
+
+   private:
+      bool                                _enabled = true;
+      uint64_t                            _blocks = 0;
+      fc::time_point                      _since;
+      latency_histogram                   _block_latency;
+      latency_histogram                   _production_latency;
+      std::vector<latency_histogram>      _stages;
+      std::vector<latency_histogram>      _operations;
+      std::vector<uint64_t>               _failed_operations;
+};
+
+} } // graphene::chain
+
+FC_REFLECT( graphene::chain::latency_histogram, (buckets)(count)(sum_us)(max_us) )
+FC_REFLECT( graphene::chain::stage_profile, (name)(latency) )
+FC_REFLECT( graphene::chain::operation_profile, (name)(failed)(latency) )
+FC_REFLECT( graphene::chain::block_profile, (enabled)(blocks)(since)(block_latency)(production_latency)(stages)(operations) )
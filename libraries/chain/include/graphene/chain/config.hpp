@@ -144,7 +144,7 @@
 #define GRAPHENE_RECENTLY_MISSED_COUNT_INCREMENT             4
 #define GRAPHENE_RECENTLY_MISSED_COUNT_DECREMENT             3
 
-#define GRAPHENE_CURRENT_DB_VERSION                          "GPH2.5"
+#define GRAPHENE_CURRENT_DB_VERSION                          "GPH2.8"
 
 #define GRAPHENE_IRREVERSIBLE_THRESHOLD                      (70 * GRAPHENE_1_PERCENT)
 
@@ -214,6 +214,16 @@
  */
 #define DASCOIN_DEFAULT_UPGRADE_EVENT_INTERVAL_DAYS (108)
 
+/**
+ * Number of license holders upgraded per block after HARDFORK_SPREAD_UPGRADES_TIME:
+ */
+#define DASCOIN_MAX_UPGRADES_PER_BLOCK (1000)
+
+/**
+ * Number of das33 pledge holders visited per block by pledge distributions after HARDFORK_DAS33_SPREAD_DISTRIBUTION_TIME:
+ */
+#define DASCOIN_MAX_DAS33_PLEDGES_PER_BLOCK (1000)
+
 #define DASCOIN_DEFAULT_REWARD_INTERVAL_TIME_SECONDS (10*60)
 #define DASCOIN_DEFAULT_DASCOIN_REWARD_AMOUNT (2000 * DASCOIN_DEFAULT_ASSET_PRECISION)
 
@@ -334,6 +344,7 @@
 ///@{
 #define DASCOIN_DEFAULT_DELAYED_OPERATIONS_RESOLVER_ENABLED  (false) ///< by default off
 #define DASCOIN_DEFAULT_DELAYED_OPERATIONS_RESOLVER_INTERVAL_TIME_SECONDS (30)  ///< in seconds
+#define DASCOIN_MAX_DELAYED_OPERATIONS_PER_BLOCK (1000) ///< resolved per block after HARDFORK_DELAYED_OPERATIONS_CAP_TIME, the rest in following blocks
 ///@}
 
 #define ORDER_BOOK_QUERY_PRECISION (static_cast<uint64_t>(1000000))
@@ -29,6 +29,7 @@
 #include <graphene/db/generic_index.hpp>
 #include <graphene/db/object.hpp>
 #include <boost/multi_index/composite_key.hpp>
+#include <algorithm>
 
 namespace graphene { namespace chain {
 
@@ -38,6 +39,26 @@ namespace graphene { namespace chain {
   // OBJECTS:                  //
   ///////////////////////////////
 
+  /**
+   * Pledge distribution of a project which is executed over several blocks.
+   */
+  struct das33_pending_distribution
+  {
+    optional<share_type>           phase_number;
+    share_type                     to_escrow;
+    share_type                     base_to_pledger;
+    share_type                     bonus_to_pledger;
+    time_point_sec                 timestamp;      ///< when the distribution was requested
+    object_id_type                 next_pledge;    ///< next pledge holder to distribute to
+    object_id_type                 last_pledge;    ///< last pledge holder which existed when the distribution was requested
+
+    /// true if the pledge holder of this phase is yet to be distributed to
+    bool covers(const object_id_type& pledge, share_type pledge_phase) const
+    {
+      return next_pledge <= pledge && pledge <= last_pledge && (!phase_number.valid() || *phase_number == pledge_phase);
+    }
+  };
+
   class das33_project_object : public graphene::db::abstract_object<das33_project_object>
   {
   public:
@@ -59,6 +80,7 @@ namespace graphene { namespace chain {
     share_type                     phase_limit;
     time_point_sec                 phase_end;
     vector<string>                 report;
+    vector<das33_pending_distribution> pending_distributions;
 
     das33_project_object() = default;
     explicit das33_project_object(string name, account_id_type owner, asset_id_type token, share_type goal_amount_eur,
@@ -76,6 +98,15 @@ namespace graphene { namespace chain {
                status(das33_project_status::inactive),
                phase_number (0),
                phase_limit(0) {}
+
+    bool has_pending_distributions() const { return !pending_distributions.empty(); }
+
+    /// Pledges covered by a pending distribution must be neither rejected nor distributed to on their own.
+    bool has_pending_distribution_for(const object_id_type& pledge, share_type pledge_phase) const
+    {
+      return std::any_of(pending_distributions.begin(), pending_distributions.end(),
+                         [&](const das33_pending_distribution& d){ return d.covers(pledge, pledge_phase); });
+    }
   };
 
   class das33_pledge_holder_object : public abstract_object<das33_pledge_holder_object>
@@ -131,6 +162,7 @@ namespace graphene { namespace chain {
   using boost::multi_index::tag;
   using boost::multi_index::member;
   using boost::multi_index::composite_key;
+  using boost::multi_index::const_mem_fun;
 
   struct by_user;
   struct by_project;
@@ -165,6 +197,7 @@ namespace graphene { namespace chain {
   using das33_pledge_holder_index = generic_index<das33_pledge_holder_object, das33_pledge_holder_multi_index_type>;
 
   struct by_project_name;
+  struct by_pending_distribution;
   typedef multi_index_container<
       das33_project_object,
       indexed_by<
@@ -175,6 +208,14 @@ namespace graphene { namespace chain {
         ordered_unique<
           tag<by_project_name>,
           member<das33_project_object, string, &das33_project_object::name>
+        >,
+        ordered_unique<
+          tag<by_pending_distribution>,
+          composite_key<
+            das33_project_object,
+            const_mem_fun<das33_project_object, bool, &das33_project_object::has_pending_distributions>,
+            member<object, object_id_type, &object::id>
+          >
         >
      >
   > das33_project_multi_index_type;
@@ -187,6 +228,16 @@ namespace graphene { namespace chain {
 // REFLECTIONS:              //
 ///////////////////////////////
 
+FC_REFLECT( graphene::chain::das33_pending_distribution,
+            (phase_number)
+            (to_escrow)
+            (base_to_pledger)
+            (bonus_to_pledger)
+            (timestamp)
+            (next_pledge)
+            (last_pledge)
+          )
+
 FC_REFLECT_DERIVED( graphene::chain::das33_pledge_holder_object, (graphene::db::object),
                     (account_id)
                     (project_id)
@@ -216,4 +267,5 @@ FC_REFLECT_DERIVED( graphene::chain::das33_project_object, (graphene::db::object
                     (phase_limit)
                     (phase_end)
                     (report)
+                    (pending_distributions)
                   )
@@ -0,0 +1,87 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <graphene/chain/protocol/types.hpp>
+#include <graphene/db/index.hpp>
+
+#include <map>
+
+namespace graphene { namespace chain {
+
+class das33_pledge_holder_object;
+
+/**
+ * Running totals of a set of das33 pledges.
+ */
+struct das33_pledge_totals
+{
+   struct pledged_amount
+   {
+      share_type amount;
+      uint32_t   count = 0;
+   };
+
+   flat_map<asset_id_type, pledged_amount> pledged;
+   share_type                               base_expected;
+   share_type                               bonus_expected;
+   uint32_t                                 count = 0;
+};
+
+/**
+ * @brief Keeps running totals of das33 pledges per project, per project phase and per account.
+ *
+ * Totals are updated whenever a pledge holder is created, changed or removed, which covers pledging, rejecting and
+ * distributing pledges. The das33 queries of the database API read them instead of walking the pledge holders.
+ *
+ * This index is attached to the das33 pledge holder index.
+ */
+class das33_pledge_aggregate_index : public secondary_index
+{
+  public:
+    typedef std::pair<das33_project_id_type, share_type> project_phase;
+    typedef std::map<project_phase, das33_pledge_totals> phase_totals_type;
+
+    virtual void object_inserted(const object& obj) override;
+    virtual void object_removed(const object& obj) override;
+    virtual void about_to_modify(const object& before) override;
+    virtual void object_modified(const object& after) override;
+
+    /// Returns totals of all pledges to @p project, or nullptr if there are none.
+    const das33_pledge_totals* get_project_totals(das33_project_id_type project) const;
+    /// Returns totals of pledges to @p project made in @p phase, or nullptr if there are none.
+    const das33_pledge_totals* get_phase_totals(das33_project_id_type project, share_type phase) const;
+    /// Returns totals of pledges of @p account by project and phase, or nullptr if there are none.
+    const phase_totals_type* get_account_totals(account_id_type account) const;
+
+  private:
+    void add(const das33_pledge_holder_object& pledge, int64_t sign);
+
+    std::map<das33_project_id_type, das33_pledge_totals>   _projects;
+    phase_totals_type                                      _phases;
+    std::map<account_id_type, phase_totals_type>           _accounts;
+};
+
+} }  // namespace graphene::chain
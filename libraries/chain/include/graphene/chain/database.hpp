@@ -28,6 +28,7 @@
 #include <graphene/chain/asset_object.hpp>
 #include <graphene/chain/fork_database.hpp>
 #include <graphene/chain/block_database.hpp>
+#include <graphene/chain/block_profiler.hpp>
 #include <graphene/chain/genesis_state.hpp>
 #include <graphene/chain/evaluator.hpp>
 #include <graphene/chain/license_objects.hpp>
@@ -51,6 +52,18 @@ namespace graphene { namespace chain {
    class transaction_evaluation_state;
 
    struct budget_record;
+   struct das33_pending_distribution;
+   class das33_pledge_holder_object;
+
+   /**
+    * Results of the transaction checks which do not depend on the chain state, computed before the transaction is
+    * pushed. See database::push_transaction().
+    */
+   struct precomputed_transaction_data
+   {
+      transaction_id_type        id;
+      flat_set<public_key_type>  signature_keys;
+   };
 
    /**
     *   @class database
@@ -98,6 +111,26 @@ namespace graphene { namespace chain {
              std::function<genesis_state_type()> genesis_loader,
              const std::string& db_version );
 
+         /**
+          * @brief Open a database whose object graph is loaded from a state snapshot
+          *
+          * Any existing object database is wiped and replaced by the snapshot state; blocks in the block log past the
+          * snapshot are replayed. Nothing before the snapshot is replayed, so the block log may start at its head block.
+          *
+          * @param snapshot_file A snapshot written by @ref export_snapshot by a build with the same object layout
+          * @param genesis_loader Returns the genesis state the node is configured with, the snapshot must be of its chain
+          */
+         void open_from_snapshot(
+            const fc::path& data_dir,
+            const fc::path& snapshot_file,
+            std::function<genesis_state_type()> genesis_loader,
+            const std::string& db_version );
+
+         /**
+          * @brief Write the current chain state, without pending transactions, to a snapshot file
+          */
+         void export_snapshot( const fc::path& snapshot_file );
+
          /**
           * @brief Rebuild object graph from block history and open detabase
           *
@@ -127,6 +160,8 @@ namespace graphene { namespace chain {
          optional<signed_block>                          fetch_block_by_id( const block_id_type& id )const;
          optional<signed_block>                          fetch_block_by_number( uint32_t num )const;
          optional<signed_block_with_virtual_operations>  fetch_block_with_virtual_operations_by_number( uint32_t num, std::vector<uint16_t> virtual_op_id_vec)const;
+         /// @param virtual_op_filter flags of the operation types to return, indexed by operation::which()
+         optional<signed_block_with_virtual_operations>  fetch_block_with_virtual_operations_by_number( uint32_t num, const std::vector<bool>& virtual_op_filter)const;
          const signed_transaction&                       get_recent_transaction( const transaction_id_type& trx_id )const;
          std::vector<block_id_type>                      get_block_ids_on_fork(block_id_type head_of_fork) const;
 
@@ -142,8 +177,16 @@ namespace graphene { namespace chain {
 
          bool push_block( const signed_block& b, uint32_t skip = skip_nothing );
          processed_transaction push_transaction( const signed_transaction& trx, uint32_t skip = skip_nothing );
+         /// Pushes a transaction which was validated with trx.validate() and whose signatures were recovered in advance.
+         processed_transaction push_transaction( const signed_transaction& trx, const precomputed_transaction_data& data,
+                                                 uint32_t skip = skip_nothing );
          bool _push_block( const signed_block& b );
-         processed_transaction _push_transaction( const signed_transaction& trx );
+         processed_transaction _push_transaction( const signed_transaction& trx, const precomputed_transaction_data* data = nullptr );
+
+         /// @throws fc::exception if the transaction references an unknown block or a block from another fork.
+         void verify_tapos( const signed_transaction& trx )const;
+         /// @throws fc::exception if the transaction is expired or expires too far in the future.
+         void verify_expiration( const signed_transaction& trx )const;
 
          ///@throws fc::exception if the proposed transaction fails to apply.
          processed_transaction push_proposal( const proposal_object& proposal );
@@ -216,6 +259,14 @@ namespace graphene { namespace chain {
           */
          fc::signal<void(const vector<object_id_type>&, const vector<const object*>&, const flat_set<account_id_type>&)>  removed_objects;
 
+         /**
+          * The accounts impacted by changed objects, passed to the three signals above, are only computed while a
+          * subscriber needs them. Subscribers which filter by account require them, and release them when they no
+          * longer need them.
+          */
+         void require_impacted_accounts();
+         void release_impacted_accounts();
+
          //////////////////// db_witness_schedule.cpp ////////////////////
 
          /**
@@ -287,6 +338,13 @@ namespace graphene { namespace chain {
 
          node_property_object& node_properties();
 
+         /// Per-stage block apply timings and per-operation-type latencies.
+         block_profiler& get_block_profiler() { return _block_profiler; }
+         const block_profiler& get_block_profiler()const { return _block_profiler; }
+
+         /// Undo state usage of the last applied block, counted from the start of its transactions.
+         const undo_stats& get_last_block_undo_stats()const { return _last_block_undo_stats; }
+
          uint32_t last_non_undoable_block_num() const;
 
          account_id_type get_account_id(const string& name);
@@ -558,6 +616,10 @@ namespace graphene { namespace chain {
          void get_groups_of_limit_order_prices(const asset_id_type& a, const asset_id_type& b,
                                                flat_set<share_type>& prices, bool ascending, uint32_t max_prices) const;
 
+         // helper to distribute a das33 pledge, returns true if nothing is left to distribute to the pledger
+         bool distribute_das33_pledge(const das33_pledge_holder_object& pledge, const das33_pending_distribution& distribution,
+                                      account_id_type project_owner);
+
          ///@}
          /**
           *  This method validates transactions without adding it to the pending state.
@@ -614,6 +676,13 @@ namespace graphene { namespace chain {
 
       private:
          optional<undo_database::session>       _pending_tx_session;
+         /// The head block the pending transactions were applied on
+         block_id_type                          _pending_tx_head;
+         /// Packed sizes of the processed pending transactions
+         vector<size_t>                         _pending_tx_sizes;
+         /// State with the transactions of the block being generated applied, consumed by _push_block()
+         optional<undo_database::session>       _generated_block_session;
+         block_id_type                          _generated_block_id;
          vector< unique_ptr<op_evaluator> >     _operation_evaluators;
 
          template<class Index>
@@ -627,8 +696,11 @@ namespace graphene { namespace chain {
          processed_transaction apply_transaction( const signed_transaction& trx, uint32_t skip = skip_nothing );
          operation_result      apply_operation( transaction_evaluation_state& eval_state, const operation& op );
       private:
-         void                  _apply_block( const signed_block& next_block );
-         processed_transaction _apply_transaction( const signed_transaction& trx );
+         void                  apply_block( const signed_block& next_block, uint32_t skip, bool transactions_applied );
+         void                  _apply_block( const signed_block& next_block, bool transactions_applied = false );
+         /// Prepares applying the transactions of the block following the head block
+         void                  start_block_transactions();
+         processed_transaction _apply_transaction( const signed_transaction& trx, const precomputed_transaction_data* data = nullptr );
 
          ///Steps involved in applying a new block
          ///@{
@@ -654,6 +726,7 @@ namespace graphene { namespace chain {
          void reset_spending_limits();
          void daspay_clearing_start();
          void resolve_delayed_operations();
+         void process_das33_distributions();
 private:
 
          ///Steps performed only at maintenance intervals
@@ -669,6 +742,8 @@ private:
          void update_active_committee_members();
          void perform_upgrades(const account_object& account, const upgrade_event_object& upgrade);
          void perform_upgrades();
+         uint32_t continue_upgrade(const upgrade_event_object& upgrade, uint32_t max_licenses);
+         void continue_upgrades();
          void update_worker_votes();
 
          template<typename IndexType, typename IndexBy, class... HelperTypes>
@@ -718,6 +793,8 @@ private:
           * order they occur and is cleared after account history plugin is updated
           */
          vector<optional<operation_history_object> >  _virtual_ops;
+         /// Flags of the virtual_op numbers of the operations in _virtual_ops, so that each is collected once
+         std::vector<bool>                             _collected_virtual_ops;
 
          uint32_t                          _current_block_num    = 0;
          uint16_t                          _current_trx_in_block = 0;
@@ -733,6 +810,16 @@ private:
 
          node_property_object              _node_property_object;
 
+         block_profiler                    _block_profiler;
+         undo_stats                        _last_block_undo_stats;
+
+         /// Number of subscribers which need impacted accounts
+         uint32_t                          _impacted_accounts_subscribers = 0;
+         /// Reused by notify_changed_objects() from one block to the next
+         vector<object_id_type>            _notified_ids;
+         vector<const object*>             _notified_removed;
+         flat_set<account_id_type>         _notified_accounts;
+
          transaction_evaluation_state      _genesis_eval_state;
 
    };
@@ -145,7 +145,17 @@ namespace graphene { namespace chain {
       upgrade_type requeue_upgrade;
       upgrade_type return_upgrade;
 
-      bool is_manual_submit()
+      time_point_sec earliest_activation() const
+      {
+        // Licenses without any history never qualify for an upgrade:
+        time_point_sec result = time_point_sec::maximum();
+        for (const auto& record : history)
+          if (record.activated_at < result)
+            result = record.activated_at;
+        return result;
+      }
+
+      bool is_manual_submit() const
       {
         return (vault_license_kind == license_kind::locked_frequency || vault_license_kind == license_kind::utility || vault_license_kind == license_kind::package);
       }
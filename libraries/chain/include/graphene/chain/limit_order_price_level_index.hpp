@@ -0,0 +1,85 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <graphene/chain/protocol/types.hpp>
+#include <graphene/db/index.hpp>
+
+#include <map>
+
+namespace graphene { namespace chain {
+
+class database;
+class limit_order_object;
+
+/**
+ * Limit orders of one side of a market with the same price, at ORDER_BOOK_QUERY_PRECISION.
+ */
+struct limit_order_price_level
+{
+   share_type base_volume;
+   share_type quote_volume;
+   share_type count;
+};
+
+/**
+ * @brief Keeps the limit orders of every market aggregated into price levels.
+ *
+ * Orders selling asset A for asset B are kept twice: keyed by the price of A in B (ascending, used when A is the base
+ * of an order book query) and by the price of B in A (descending, used when B is the base). Keys and volumes are
+ * computed exactly as the grouped order book queries of the database API compute them, so those queries can return
+ * the requested levels without walking the orders.
+ *
+ * This index is attached to the limit order index.
+ */
+class limit_order_price_level_index : public secondary_index
+{
+  public:
+    typedef std::map<share_type, limit_order_price_level> levels_type;
+
+    limit_order_price_level_index(const database* db) : _db(*db) {}
+
+    virtual void object_inserted(const object& obj) override;
+    virtual void object_removed(const object& obj) override;
+    virtual void about_to_modify(const object& before) override;
+    virtual void object_modified(const object& after) override;
+
+    /// Returns the price levels of orders selling @p sell for @p receive, or nullptr if there are none.
+    const levels_type* get_levels(asset_id_type sell, asset_id_type receive, bool ascending) const;
+
+  private:
+    struct book
+    {
+      levels_type ascending;
+      levels_type descending;
+    };
+
+    void add(const limit_order_object& order, int64_t sign);
+
+    const database&                                       _db;
+    std::map<std::pair<asset_id_type, asset_id_type>, book> _books;
+};
+
+} }  // namespace graphene::chain
@@ -25,6 +25,7 @@
 #include <graphene/chain/protocol/operations.hpp>
 #include <graphene/db/object.hpp>
 #include <boost/multi_index/composite_key.hpp>
+#include <boost/multi_index/mem_fun.hpp>
 
 namespace graphene { namespace chain {
 
@@ -64,14 +65,24 @@ namespace graphene { namespace chain {
          uint16_t          op_in_trx = 0;
          /** any virtual operations implied by operation in block */
          uint16_t          virtual_op = 0;
+
+         bool is_virtual()const { return operation_type_limits::is_virtual_operation( op ); }
    };
 
    struct by_blnum;
+   struct by_virtual_blnum;
    typedef multi_index_container<
       operation_history_object,
       indexed_by<
          ordered_unique< tag<by_id>, member< object, object_id_type, &object::id > >,
-         ordered_non_unique< tag<by_blnum>, member<operation_history_object, uint32_t, &operation_history_object::block_num> >
+         ordered_non_unique< tag<by_blnum>, member<operation_history_object, uint32_t, &operation_history_object::block_num> >,
+         ordered_unique< tag<by_virtual_blnum>,
+            composite_key< operation_history_object,
+               const_mem_fun< operation_history_object, bool, &operation_history_object::is_virtual >,
+               member< operation_history_object, uint32_t, &operation_history_object::block_num >,
+               member< object, object_id_type, &object::id >
+            >
+         >
       >
    > operation_history_multi_index_type;
 
@@ -29,6 +29,7 @@
 #include <graphene/db/object.hpp>
 
 #include <boost/multi_index/composite_key.hpp>
+#include <boost/multi_index/ranked_index.hpp>
 
 namespace graphene { namespace chain {
 
@@ -76,7 +77,8 @@ namespace graphene { namespace chain {
       ordered_unique< tag<by_id>,
         member<object, object_id_type, &object::id>
       >,
-      ordered_unique< tag<by_time>,
+      // Ranked, so the position of a submission in the queue can be found in logarithmic time:
+      ranked_unique< tag<by_time>,
         composite_key< reward_queue_object,
           member< reward_queue_object, time_point_sec, &reward_queue_object::time>,
           member< object, object_id_type, &object::id>
@@ -0,0 +1,98 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <graphene/chain/access_layer.hpp>
+#include <graphene/db/index.hpp>
+
+namespace graphene { namespace chain {
+
+class database;
+
+/**
+ * @brief Keeps the chain wide cycle totals and queue projection up to date.
+ *
+ * Every vault with license information contributes the result of @ref calculate_total_cycles and
+ * @ref calculate_queue_state to the totals. A vault's contribution is recomputed whenever its license information
+ * changes (issue, upgrade, submit, update) or whenever its tethered state changes, so reading the totals is O(1).
+ *
+ * This index is attached to the account index. License information changes are forwarded to it by
+ * @ref queue_projection_license_index.
+ */
+class queue_projection_index : public secondary_index
+{
+  public:
+    queue_projection_index(const database* db) : _db(*db) {}
+
+    virtual void object_inserted(const object& obj) override;
+    virtual void object_removed(const object& obj) override;
+    virtual void about_to_modify(const object& before) override;
+    virtual void object_modified(const object& after) override;
+
+    /// Called when license information of a vault is created or changed.
+    void license_information_changed(const license_information_object& license_information);
+    /// Called when license information of a vault is about to be removed.
+    void license_information_removed(const license_information_object& license_information);
+
+    const total_cycles_res& get_total_cycles() const { return _total_cycles; }
+    const queue_projection_res& get_queue_projection() const { return _queue_projection; }
+    /// Vaults whose projection could not be calculated and which are missing from the totals.
+    const flat_set<account_id_type>& get_excluded_vaults() const { return _excluded_vaults; }
+
+  private:
+    struct contribution
+    {
+      total_cycles_res cycles;
+      queue_projection_res queue;
+    };
+
+    void update(account_id_type vault_id, const license_information_object* license_information);
+    void remove(account_id_type vault_id);
+
+    const database&                       _db;
+    map<account_id_type, contribution>    _contributions;
+    total_cycles_res                      _total_cycles;
+    queue_projection_res                  _queue_projection;
+    flat_set<account_id_type>             _excluded_vaults;
+    bool                                  _was_tethered = false;
+};
+
+/**
+ * @brief Forwards license information changes to the @ref queue_projection_index.
+ */
+class queue_projection_license_index : public secondary_index
+{
+  public:
+    queue_projection_license_index(queue_projection_index* projection) : _projection(*projection) {}
+
+    virtual void object_inserted(const object& obj) override;
+    virtual void object_removed(const object& obj) override;
+    virtual void object_modified(const object& after) override;
+
+  private:
+    queue_projection_index& _projection;
+};
+
+} }  // namespace graphene::chain
@@ -51,6 +51,11 @@ namespace graphene { namespace chain {
       bool historic = false;
       uint16_t num_of_executions = 0;
 
+      /// Start of the execution which is currently being spread over several blocks:
+      time_point_sec execution_started;
+      /// Next license holder to upgrade in id order, set only while an execution is in progress:
+      optional<license_information_id_type> next_license_to_upgrade;
+
       extensions_type extensions;
 
       upgrade_event_object() = default;
@@ -66,6 +71,11 @@ namespace graphene { namespace chain {
       {
         return num_of_executions >= subsequent_execution_times.size() + 1;
       }
+
+      bool in_progress() const
+      {
+        return next_license_to_upgrade.valid();
+      }
   };
 
   ///////////////////////////////
@@ -103,5 +113,7 @@ FC_REFLECT_DERIVED( graphene::chain::upgrade_event_object, (graphene::db::object
                     (subsequent_execution_times)
                     (comment)
                     (num_of_executions)
+                    (execution_started)
+                    (next_license_to_upgrade)
                     (extensions)
                   )
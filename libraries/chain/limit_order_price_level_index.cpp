@@ -0,0 +1,97 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <graphene/chain/limit_order_price_level_index.hpp>
+
+#include <graphene/chain/asset_object.hpp>
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/market_object.hpp>
+
+#include <cmath>
+
+namespace graphene { namespace chain {
+
+void limit_order_price_level_index::object_inserted(const object& obj)
+{
+    assert( dynamic_cast<const limit_order_object*>(&obj) ); // for debug only
+    add(static_cast<const limit_order_object&>(obj), 1);
+}
+
+void limit_order_price_level_index::object_removed(const object& obj)
+{
+    assert( dynamic_cast<const limit_order_object*>(&obj) ); // for debug only
+    add(static_cast<const limit_order_object&>(obj), -1);
+}
+
+void limit_order_price_level_index::about_to_modify(const object& before)
+{
+    assert( dynamic_cast<const limit_order_object*>(&before) ); // for debug only
+    add(static_cast<const limit_order_object&>(before), -1);
+}
+
+void limit_order_price_level_index::object_modified(const object& after)
+{
+    assert( dynamic_cast<const limit_order_object*>(&after) ); // for debug only
+    add(static_cast<const limit_order_object&>(after), 1);
+}
+
+const limit_order_price_level_index::levels_type*
+limit_order_price_level_index::get_levels(asset_id_type sell, asset_id_type receive, bool ascending) const
+{
+    auto it = _books.find(std::make_pair(sell, receive));
+    if (it == _books.end())
+        return nullptr;
+    return ascending ? &it->second.ascending : &it->second.descending;
+}
+
+void limit_order_price_level_index::add(const limit_order_object& order, int64_t sign)
+{
+    const auto sell = order.sell_price.base.asset_id;
+    const auto receive = order.sell_price.quote.asset_id;
+    const auto market = std::make_pair(sell, receive);
+    auto& b = _books[market];
+
+    // Keys and volumes must match database_api_impl::get_limit_orders_grouped_by_price() to the last bit:
+    const double coef = asset::scaled_precision(_db.get(sell).precision).value * 1.0
+                        / asset::scaled_precision(_db.get(receive).precision).value;
+    const auto update = [&](levels_type& levels, bool ascending) {
+        const double price = ascending ? 1 / order.sell_price.to_real() : order.sell_price.to_real();
+        const share_type key = static_cast<share_type>(round((ascending ? price * coef : price / coef) * ORDER_BOOK_QUERY_PRECISION));
+        const share_type quote = static_cast<int64_t>(round(ascending ? order.for_sale.value * price : order.for_sale.value / price));
+
+        auto& level = levels[key];
+        level.base_volume += sign * order.for_sale.value;
+        level.quote_volume += sign * quote.value;
+        level.count += sign;
+        if (level.count == 0)
+            levels.erase(key);
+    };
+    update(b.ascending, true);
+    update(b.descending, false);
+
+    if (b.ascending.empty() && b.descending.empty())
+        _books.erase(market);
+}
+
+} }  // namespace graphene::chain
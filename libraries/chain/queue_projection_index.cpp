@@ -0,0 +1,131 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <graphene/chain/queue_projection_index.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/license_objects.hpp>
+
+namespace graphene { namespace chain {
+
+void queue_projection_index::object_inserted(const object& obj)
+{
+    assert( dynamic_cast<const account_object*>(&obj) ); // for debug only
+    const account_object& a = static_cast<const account_object&>(obj);
+    if (!a.is_vault())
+        return;
+
+    const auto& idx = _db.get_index_type<license_information_index>().indices().get<by_account_id>();
+    auto it = idx.find(a.id);
+    update(a.id, it != idx.end() ? &*it : nullptr);
+}
+
+void queue_projection_index::object_removed(const object& obj)
+{
+    remove(obj.id);
+}
+
+void queue_projection_index::about_to_modify(const object& before)
+{
+    assert( dynamic_cast<const account_object*>(&before) ); // for debug only
+    _was_tethered = static_cast<const account_object&>(before).is_tethered();
+}
+
+void queue_projection_index::object_modified(const object& after)
+{
+    assert( dynamic_cast<const account_object*>(&after) ); // for debug only
+    const account_object& a = static_cast<const account_object&>(after);
+    // Only the tethered state of a vault has an effect on the projection:
+    if (a.is_vault() && a.is_tethered() != _was_tethered)
+        object_inserted(a);
+}
+
+void queue_projection_index::license_information_changed(const license_information_object& license_information)
+{
+    update(license_information.account, &license_information);
+}
+
+void queue_projection_index::license_information_removed(const license_information_object& license_information)
+{
+    remove(license_information.account);
+}
+
+void queue_projection_index::update(account_id_type vault_id, const license_information_object* license_information)
+{
+    remove(vault_id);
+
+    const account_object* vault = _db.find(vault_id);
+    if (vault == nullptr || !vault->is_vault() || license_information == nullptr)
+        return;
+
+    contribution c;
+    try {
+        if (license_information->is_manual_submit())
+            c.cycles = calculate_total_cycles(_db, *license_information);
+        c.queue = calculate_queue_state(_db, *vault, *license_information);
+    } catch (const fc::exception& e) {
+        // Never let a projection failure interfere with applying the chain, the vault is left out instead and the
+        // totals are reported as incomplete until it can be calculated again:
+        wlog("Unable to calculate queue projection for vault ${v}: ${e}", ("v", vault_id)("e", e.to_detail_string()));
+        _excluded_vaults.insert(vault_id);
+        return;
+    }
+
+    _total_cycles = _total_cycles + c.cycles;
+    _queue_projection = _queue_projection + c.queue;
+    _contributions.emplace(vault_id, std::move(c));
+}
+
+void queue_projection_index::remove(account_id_type vault_id)
+{
+    _excluded_vaults.erase(vault_id);
+
+    auto it = _contributions.find(vault_id);
+    if (it == _contributions.end())
+        return;
+
+    _total_cycles = _total_cycles - it->second.cycles;
+    _queue_projection = _queue_projection - it->second.queue;
+    _contributions.erase(it);
+}
+
+void queue_projection_license_index::object_inserted(const object& obj)
+{
+    assert( dynamic_cast<const license_information_object*>(&obj) ); // for debug only
+    _projection.license_information_changed(static_cast<const license_information_object&>(obj));
+}
+
+void queue_projection_license_index::object_removed(const object& obj)
+{
+    assert( dynamic_cast<const license_information_object*>(&obj) ); // for debug only
+    _projection.license_information_removed(static_cast<const license_information_object&>(obj));
+}
+
+void queue_projection_license_index::object_modified(const object& after)
+{
+    assert( dynamic_cast<const license_information_object*>(&after) ); // for debug only
+    _projection.license_information_changed(static_cast<const license_information_object&>(after));
+}
+
+} }  // namespace graphene::chain
@@ -96,6 +96,22 @@ namespace graphene { namespace db {
          virtual void open( const fc::path& db ) = 0;
          virtual void save( const fc::path& db ) = 0;
 
+         /**
+          *  Writes the next id and every object in the format read by open(), used for object files and snapshots
+          */
+         virtual void save( std::ostream& out )const = 0;
+         /**
+          *  Unpacks objects written by save() without touching the index, so it may run on any thread
+          */
+         virtual vector<unique_ptr<object>> decode( const char* data, size_t size, object_id_type& next_id )const = 0;
+         /**
+          *  Inserts objects returned by decode() the way open() loads them: secondary indexes are notified,
+          *  undo history and observers are not
+          */
+         virtual void restore( vector<unique_ptr<object>>&& objects, const object_id_type& next_id ) = 0;
+         virtual std::string        object_type_name()const = 0;
+         virtual fc::sha256         object_version()const = 0;
+
 
 
          /** @return the object with id or nullptr if not found */
@@ -191,6 +207,21 @@ namespace graphene { namespace db {
    };
 
 
+   namespace detail {
+      /// appends the name of every reflected member, base class members first, to names
+      struct object_member_names_visitor
+      {
+         std::string& names;
+
+         template<typename Member, class Class, Member (Class::*member)>
+         void operator()( const char* name )const
+         {
+            names += ',';
+            names += name;
+         }
+      };
+   }
+
    /**
     * @class primary_index
     * @brief  Wraps a derived index to intercept calls to create, modify, and remove so that
@@ -217,10 +248,15 @@ namespace graphene { namespace db {
          virtual void           use_next_id()override                    { ++_next_id.number;  }
          virtual void           set_next_id( object_id_type id )override { _next_id = id;      }
 
+         /// hash of the type name and its reflected members, so adding, removing or renaming a field changes it
          fc::sha256 get_object_version()const
          {
-            std::string desc = "1.0";//get_type_description<object_type>();
-            return fc::sha256::hash(desc);
+            static const fc::sha256 version = []() {
+               std::string desc = fc::get_typename<object_type>::name();
+               fc::reflector<object_type>::visit( detail::object_member_names_visitor{ desc } );
+               return fc::sha256::hash( desc );
+            }();
+            return version;
          }
 
          virtual void open( const path& db )override
@@ -228,20 +264,9 @@ namespace graphene { namespace db {
             if( !fc::exists( db ) ) return;
             fc::file_mapping fm( db.generic_string().c_str(), fc::read_only );
             fc::mapped_region mr( fm, fc::read_only, 0, fc::file_size(db) );
-            fc::datastream<const char*> ds( (const char*)mr.get_address(), mr.get_size() );
-            fc::sha256 open_ver;
-
-            fc::raw::unpack(ds, _next_id);
-            fc::raw::unpack(ds, open_ver);
-            FC_ASSERT( open_ver == get_object_version(), "Incompatible Version, the serialization of objects in this index has changed" );
-            try {
-               vector<char> tmp;
-               while( true ) 
-               {
-                  fc::raw::unpack( ds, tmp );
-                  load( tmp );
-               }
-            } catch ( const fc::exception&  ){}
+            object_id_type next_id;
+            auto objects = decode( (const char*)mr.get_address(), mr.get_size(), next_id );
+            restore( std::move(objects), next_id );
          }
 
          virtual void save( const path& db ) override 
@@ -249,6 +274,11 @@ namespace graphene { namespace db {
             std::ofstream out( db.generic_string(), 
                                std::ofstream::binary | std::ofstream::out | std::ofstream::trunc );
             FC_ASSERT( out );
+            save( out );
+         }
+
+         virtual void save( std::ostream& out )const override
+         {
             auto ver  = get_object_version();
             fc::raw::pack( out, _next_id );
             fc::raw::pack( out, ver );
@@ -259,6 +289,49 @@ namespace graphene { namespace db {
             });
          }
 
+         virtual vector<unique_ptr<object>> decode( const char* data, size_t size, object_id_type& next_id )const override
+         {
+            fc::datastream<const char*> ds( data, size );
+            fc::sha256 open_ver;
+
+            fc::raw::unpack(ds, next_id);
+            fc::raw::unpack(ds, open_ver);
+            FC_ASSERT( open_ver == get_object_version(), "Incompatible Version, the serialization of objects in this index has changed" );
+            vector<unique_ptr<object>> objects;
+            try {
+               vector<char> tmp;
+               while( ds.remaining() > 0 )
+               {
+                  fc::raw::unpack( ds, tmp );
+                  objects.emplace_back( new object_type( fc::raw::unpack<object_type>( tmp ) ) );
+               }
+            } catch ( const fc::exception&  ){}
+            return objects;
+         }
+
+         virtual void restore( vector<unique_ptr<object>>&& objects, const object_id_type& next_id )override
+         {
+            _next_id = next_id;
+            // a failed insert means the snapshot does not match this build, so it must fail the import
+            for( auto& obj : objects )
+            {
+               const auto& result = DerivedIndex::insert( std::move( *obj ) );
+               for( const auto& item : _sindex )
+                  item->object_inserted( result );
+            }
+            objects.clear();
+         }
+
+         virtual std::string object_type_name()const override
+         {
+            return fc::get_typename<object_type>::name();
+         }
+
+         virtual fc::sha256 object_version()const override
+         {
+            return get_object_version();
+         }
+
          virtual const object&  load( const std::vector<char>& data )override
          {
             const auto& result = DerivedIndex::insert( fc::raw::unpack<object_type>( data ) );
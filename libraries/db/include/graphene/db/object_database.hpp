@@ -32,6 +32,34 @@
 
 namespace graphene { namespace db {
 
+   /**
+    *  Describes one index stored in a state snapshot. The section is followed by size bytes in the format written
+    *  by index::save().
+    */
+   struct snapshot_section
+   {
+      uint8_t     space_id = 0;
+      uint8_t     type_id = 0;
+      std::string type_name;
+      fc::sha256  object_version;
+      uint64_t    object_count = 0;
+      uint64_t    size = 0;
+   };
+
+   /**
+    *  Starts a state snapshot file and is followed by section_count sections. metadata is opaque to the
+    *  object_database, the chain uses it to record which block the snapshot was taken at.
+    */
+   struct snapshot_header
+   {
+      static const uint32_t current_format = 1;
+
+      uint32_t     magic = 0x50414e53; // "SNAP"
+      uint32_t     format = current_format;
+      vector<char> metadata;
+      uint32_t     section_count = 0;
+   };
+
    /**
     *   @class object_database
     *   @brief maintains a set of indexed objects that can be modified with multi-level rollback support
@@ -53,6 +81,20 @@ namespace graphene { namespace db {
          void wipe(const fc::path& data_dir); // remove from disk
          void close();
 
+         /**
+          * Writes every index to a snapshot file. Indexes are serialized on several threads and written in
+          * space/type order as soon as each one is ready.
+          */
+         void export_snapshot( const fc::path& snapshot_file, const vector<char>& metadata )const;
+         /**
+          * Loads a snapshot written by export_snapshot() into an empty database and returns its metadata. Sections
+          * are decoded on several threads and inserted in file order, so secondary indexes see the same sequence
+          * of insertions as when opening the object files.
+          */
+         vector<char> import_snapshot( const fc::path& snapshot_file );
+         /// Returns the metadata of a snapshot file without loading any of its objects.
+         static vector<char> read_snapshot_metadata( const fc::path& snapshot_file );
+
          template<typename T, typename F>
          const T& create( F&& constructor )
          {
@@ -176,4 +218,7 @@ namespace graphene { namespace db {
 
 } } // graphene::db
 
+FC_REFLECT( graphene::db::snapshot_section, (space_id)(type_id)(type_name)(object_version)(object_count)(size) )
+FC_REFLECT( graphene::db::snapshot_header, (magic)(format)(metadata)(section_count) )
+
 
@@ -40,6 +40,18 @@ namespace graphene { namespace db {
       unordered_map<object_id_type, unique_ptr<object> > removed;
    };
 
+   /**
+    * Counts the objects saved into undo states and how many of those saves were served from
+    * storage released by earlier states instead of a fresh clone.
+    */
+   struct undo_stats
+   {
+      uint64_t objects_saved    = 0;
+      uint64_t objects_recycled = 0;
+      uint64_t states_started   = 0;
+      uint64_t states_recycled  = 0;
+   };
+
 
    /**
     * @class undo_database
@@ -132,16 +144,35 @@ namespace graphene { namespace db {
 
          const undo_state& head()const;
 
+         const undo_stats& stats()const { return _stats; }
+         void reset_stats() { _stats = undo_stats(); }
+
       private:
          void undo();
          void merge();
          void commit();
 
+         void push_state();
+         /** Returns a copy of obj, reusing a released object of the same type when one is pooled. */
+         unique_ptr<object> save( const object& obj );
+         /** Hands the containers and saved objects of a state that is about to be dropped back to the pools. */
+         void release( undo_state& state );
+
          uint32_t                _active_sessions = 0;
          bool                    _disabled = true;
          std::deque<undo_state>  _stack;
          object_database&        _db;
          size_t                  _max_size = 256;
+
+         /// released objects keyed by the id of their index, i.e. object_id_type( space, type, 0 )
+         unordered_map<object_id_type, std::vector<unique_ptr<object>>> _object_pool;
+         std::vector<undo_state> _state_pool;
+         undo_stats              _stats;
+
+         static const size_t max_pooled_states = 4;
+         static const size_t max_pooled_objects_per_type = 256;
    };
 
 } } // graphene::db
+
+FC_REFLECT( graphene::db::undo_stats, (objects_saved)(objects_recycled)(states_started)(states_recycled) )
@@ -25,10 +25,77 @@
 
 #include <fc/io/raw.hpp>
 #include <fc/container/flat.hpp>
+#include <fc/interprocess/file_mapping.hpp>
 #include <fc/uint128.hpp>
 
+#include <atomic>
+#include <fstream>
+#include <future>
+#include <sstream>
+#include <thread>
+
 namespace graphene { namespace db {
 
+namespace {
+
+   snapshot_header unpack_snapshot_header( fc::datastream<const char*>& ds, const fc::path& snapshot_file )
+   {
+      snapshot_header header;
+      fc::raw::unpack( ds, header );
+      FC_ASSERT( header.magic == snapshot_header().magic, "${f} is not a snapshot file", ("f", snapshot_file) );
+      FC_ASSERT( header.format == snapshot_header::current_format, "Unsupported snapshot format ${v}", ("v", header.format) );
+      return header;
+   }
+
+   /**
+    * Runs job(i) for every i in [0, count) on a few threads and calls consume(i) on the calling thread in order of i,
+    * each as soon as job(i) has finished. An exception from either stops the remaining work and is rethrown.
+    */
+   void ordered_parallel( size_t count, const std::function<void(size_t)>& job, const std::function<void(size_t)>& consume )
+   {
+      vector<std::promise<void>> done( count );
+      std::atomic<size_t> next( 0 );
+      auto worker = [&]() {
+         for( size_t i = next++; i < count; i = next++ )
+         {
+            try
+            {
+               job( i );
+               done[i].set_value();
+            }
+            catch( ... )
+            {
+               done[i].set_exception( std::current_exception() );
+            }
+         }
+      };
+
+      const size_t thread_count = std::max<size_t>( 1, std::min<size_t>( count, std::thread::hardware_concurrency() ) );
+      vector<std::thread> threads;
+      for( size_t t = 0; t < thread_count; ++t )
+         threads.emplace_back( worker );
+
+      try
+      {
+         for( size_t i = 0; i < count; ++i )
+         {
+            done[i].get_future().get();
+            consume( i );
+         }
+      }
+      catch( ... )
+      {
+         next = count;
+         for( auto& t : threads )
+            t.join();
+         throw;
+      }
+      for( auto& t : threads )
+         t.join();
+   }
+
+}
+
 object_database::object_database()
 :_undo_db(*this)
 {
@@ -87,6 +154,117 @@ void object_database::flush()
    fc::remove_all( _data_dir / "object_database.old" );
 }
 
+void object_database::export_snapshot( const fc::path& snapshot_file, const vector<char>& metadata )const
+{ try {
+   vector<const index*> indexes;
+   for( const auto& space : _index )
+      for( const auto& idx : space )
+         if( idx )
+            indexes.push_back( idx.get() );
+
+   const fc::path tmp_file = snapshot_file.generic_string() + ".tmp";
+   std::ofstream out( tmp_file.generic_string(), std::ofstream::binary | std::ofstream::out | std::ofstream::trunc );
+   FC_ASSERT( out, "Unable to create snapshot file ${f}", ("f", tmp_file) );
+
+   snapshot_header header;
+   header.metadata = metadata;
+   header.section_count = indexes.size();
+   fc::raw::pack( out, header );
+
+   vector<snapshot_section> sections( indexes.size() );
+   vector<std::string> bodies( indexes.size() );
+   ordered_parallel( indexes.size(),
+      [&]( size_t i ) {
+         const index& idx = *indexes[i];
+         std::ostringstream body;
+         idx.save( body );
+         bodies[i] = body.str();
+
+         snapshot_section& section = sections[i];
+         section.space_id = idx.object_space_id();
+         section.type_id = idx.object_type_id();
+         section.type_name = idx.object_type_name();
+         section.object_version = idx.object_version();
+         idx.inspect_all_objects( [&section]( const object& ) { ++section.object_count; } );
+         section.size = bodies[i].size();
+      },
+      [&]( size_t i ) {
+         fc::raw::pack( out, sections[i] );
+         out.write( bodies[i].data(), bodies[i].size() );
+         bodies[i] = std::string();
+      } );
+
+   out.close();
+   FC_ASSERT( !out.fail(), "Failed to write snapshot file ${f}", ("f", tmp_file) );
+   fc::rename( tmp_file, snapshot_file );
+} FC_CAPTURE_AND_RETHROW( (snapshot_file) ) }
+
+vector<char> object_database::read_snapshot_metadata( const fc::path& snapshot_file )
+{ try {
+   FC_ASSERT( fc::exists( snapshot_file ), "Snapshot file ${f} does not exist", ("f", snapshot_file) );
+   fc::file_mapping fm( snapshot_file.generic_string().c_str(), fc::read_only );
+   fc::mapped_region mr( fm, fc::read_only, 0, fc::file_size( snapshot_file ) );
+   fc::datastream<const char*> ds( (const char*)mr.get_address(), mr.get_size() );
+   return unpack_snapshot_header( ds, snapshot_file ).metadata;
+} FC_CAPTURE_AND_RETHROW( (snapshot_file) ) }
+
+vector<char> object_database::import_snapshot( const fc::path& snapshot_file )
+{ try {
+   FC_ASSERT( fc::exists( snapshot_file ), "Snapshot file ${f} does not exist", ("f", snapshot_file) );
+   fc::file_mapping fm( snapshot_file.generic_string().c_str(), fc::read_only );
+   fc::mapped_region mr( fm, fc::read_only, 0, fc::file_size( snapshot_file ) );
+   const char* const data = (const char*)mr.get_address();
+   fc::datastream<const char*> ds( data, mr.get_size() );
+   const snapshot_header header = unpack_snapshot_header( ds, snapshot_file );
+
+   // Sections are found up front by skipping over their bodies, the bodies are then decoded in parallel
+   vector<snapshot_section> sections( header.section_count );
+   vector<size_t> offsets( header.section_count );
+   for( uint32_t i = 0; i < header.section_count; ++i )
+   {
+      fc::raw::unpack( ds, sections[i] );
+      offsets[i] = ds.tellp();
+      FC_ASSERT( ds.remaining() >= sections[i].size, "Snapshot file ${f} is truncated", ("f", snapshot_file) );
+      ds.skip( sections[i].size );
+   }
+
+   vector<index*> indexes( sections.size(), nullptr );
+   for( size_t i = 0; i < sections.size(); ++i )
+   {
+      const auto& section = sections[i];
+      if( _index.size() <= section.space_id || _index[section.space_id].size() <= section.type_id
+          || !_index[section.space_id][section.type_id] )
+      {
+         wlog( "Skipping snapshot section ${n} (${s}.${t}), no such index is registered",
+               ("n", section.type_name)("s", section.space_id)("t", section.type_id) );
+         continue;
+      }
+      index& idx = *_index[section.space_id][section.type_id];
+      FC_ASSERT( section.type_name == idx.object_type_name() && section.object_version == idx.object_version(),
+                 "Snapshot section ${s}.${t} holds ${n}, which is not compatible with this build",
+                 ("s", section.space_id)("t", section.type_id)("n", section.type_name) );
+      FC_ASSERT( idx.get_next_id().instance() == 0, "Snapshots can only be imported into an empty database" );
+      indexes[i] = &idx;
+   }
+
+   vector<vector<unique_ptr<object>>> objects( sections.size() );
+   vector<object_id_type> next_ids( sections.size() );
+   ordered_parallel( sections.size(),
+      [&]( size_t i ) {
+         if( indexes[i] )
+            objects[i] = indexes[i]->decode( data + offsets[i], sections[i].size, next_ids[i] );
+      },
+      [&]( size_t i ) {
+         if( !indexes[i] ) return;
+         FC_ASSERT( objects[i].size() == sections[i].object_count,
+                    "Snapshot section ${n} is damaged: expected ${e} objects, decoded ${d}",
+                    ("n", sections[i].type_name)("e", sections[i].object_count)("d", objects[i].size()) );
+         indexes[i]->restore( std::move( objects[i] ), next_ids[i] );
+      } );
+
+   return header.metadata;
+} FC_CAPTURE_AND_RETHROW( (snapshot_file) ) }
+
 void object_database::wipe(const fc::path& data_dir)
 {
    close();
@@ -38,12 +38,63 @@ undo_database::session undo_database::start_undo_session( bool force_enable )
       _disabled = false;
 
    while( size() > max_size() )
+   {
+      release( _stack.front() );
       _stack.pop_front();
+   }
 
-   _stack.emplace_back();
+   push_state();
    ++_active_sessions;
    return session(*this, disable_on_exit );
 }
+void undo_database::push_state()
+{
+   ++_stats.states_started;
+   if( _state_pool.empty() )
+   {
+      _stack.emplace_back();
+      return;
+   }
+   _stack.emplace_back( std::move( _state_pool.back() ) );
+   _state_pool.pop_back();
+   ++_stats.states_recycled;
+}
+unique_ptr<object> undo_database::save( const object& obj )
+{
+   ++_stats.objects_saved;
+   auto itr = _object_pool.find( object_id_type( obj.id.space(), obj.id.type(), 0 ) );
+   if( itr == _object_pool.end() || itr->second.empty() )
+      return obj.clone();
+
+   unique_ptr<object> copy = std::move( itr->second.back() );
+   itr->second.pop_back();
+   copy->copy_from( obj );
+   ++_stats.objects_recycled;
+   return copy;
+}
+void undo_database::release( undo_state& state )
+{
+   auto recycle = [this]( unordered_map<object_id_type, unique_ptr<object> >& objects )
+   {
+      for( auto& item : objects )
+      {
+         // merge() leaves empty pointers behind for the values it moved into the previous state
+         if( !item.second ) continue;
+         auto& pool = _object_pool[ object_id_type( item.first.space(), item.first.type(), 0 ) ];
+         if( pool.size() < max_pooled_objects_per_type )
+            pool.push_back( std::move( item.second ) );
+      }
+      objects.clear();
+   };
+   recycle( state.old_values );
+   recycle( state.removed );
+   state.old_index_next_ids.clear();
+   state.new_ids.clear();
+
+   // clear() keeps the bucket arrays, so a pooled state does not allocate them again
+   if( _state_pool.size() < max_pooled_states )
+      _state_pool.push_back( std::move( state ) );
+}
 void undo_database::on_create( const object& obj )
 {
    if( _disabled ) return;
@@ -68,7 +119,7 @@ void undo_database::on_modify( const object& obj )
       return;
    auto itr =  state.old_values.find(obj.id);
    if( itr != state.old_values.end() ) return;
-   state.old_values[obj.id] = obj.clone();
+   state.old_values[obj.id] = save( obj );
 }
 void undo_database::on_remove( const object& obj )
 {
@@ -89,7 +140,7 @@ void undo_database::on_remove( const object& obj )
       return;
    }
    if( state.removed.count(obj.id) ) return;
-   state.removed[obj.id] = obj.clone();
+   state.removed[obj.id] = save( obj );
 }
 
 void undo_database::undo()
@@ -117,6 +168,7 @@ void undo_database::undo()
    for( auto& item : state.removed )
       _db.insert( std::move(*item.second) );
 
+   release( state );
    _stack.pop_back();
    enable();
    --_active_sessions;
@@ -127,6 +179,7 @@ void undo_database::merge()
    FC_ASSERT( _active_sessions > 0 );
    if( _active_sessions == 1 && _stack.size() == 1 )
    {
+      release( _stack.back() );
       _stack.pop_back();
       --_active_sessions;
       return;
@@ -239,6 +292,7 @@ void undo_database::merge()
       // nop + del(was=Y) -> del(was=Y)
       prev_state.removed[obj.second->id] = std::move(obj.second);
    }
+   release( state );
    _stack.pop_back();
    --_active_sessions;
 }
@@ -275,6 +329,7 @@ void undo_database::pop_commit()
       for( auto& item : state.removed )
          _db.insert( std::move(*item.second) );
 
+      release( state );
       _stack.pop_back();
    }
    catch ( const fc::exception& e )
@@ -22,6 +22,7 @@
  * THE SOFTWARE.
  */
 #include <graphene/net/core_messages.hpp>
+#include <graphene/net/message.hpp>
 
 
 namespace graphene { namespace net {
@@ -45,6 +46,27 @@ namespace graphene { namespace net {
   const core_message_type_enum check_firewall_reply_message::type            = core_message_type_enum::check_firewall_reply_message_type;
   const core_message_type_enum get_current_connections_request_message::type = core_message_type_enum::get_current_connections_request_message_type;
   const core_message_type_enum get_current_connections_reply_message::type   = core_message_type_enum::get_current_connections_reply_message_type;
+  const core_message_type_enum compact_block_message::type                   = core_message_type_enum::compact_block_message_type;
+  const core_message_type_enum fetch_compact_block_transactions_message::type = core_message_type_enum::fetch_compact_block_transactions_message_type;
+  const core_message_type_enum compact_block_transactions_message::type      = core_message_type_enum::compact_block_transactions_message_type;
+
+  compact_block_message::compact_block_message(const item_hash_t& block_message_hash, const signed_block& block) :
+    block_message_hash(block_message_hash),
+    header(block)
+  {
+    short_transaction_ids.reserve(block.transactions.size());
+    operation_results.reserve(block.transactions.size());
+    for (const auto& transaction : block.transactions)
+    {
+      short_transaction_ids.push_back(compact_transaction_id(message(trx_message(transaction)).id()));
+      operation_results.push_back(transaction.operation_results);
+    }
+  }
+
+  uint64_t compact_transaction_id(const item_hash_t& trx_message_hash)
+  {
+    return (uint64_t(trx_message_hash._hash[1]) << 32) | trx_message_hash._hash[0];
+  }
 
 } } // graphene::net
 
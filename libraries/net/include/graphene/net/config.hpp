@@ -84,6 +84,13 @@
 
 #define GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING      200
 
+/**
+ * During sync, when the next block we need has been requested from a peer
+ * for longer than this without arriving, it is requested from another peer
+ * as well, so one slow peer doesn't hold up applying the blocks after it.
+ */
+#define GRAPHENE_NET_SYNC_BLOCK_REQUEST_TIMEOUT_MS           2000
+
 /**
  * During normal operation, how many items will be fetched from each
  * peer at a time.  This will only come into play when the network
@@ -44,6 +44,8 @@ namespace graphene { namespace net {
   using graphene::chain::block_id_type;
   using graphene::chain::transaction_id_type;
   using graphene::chain::signed_block;
+  using graphene::chain::signed_block_header;
+  using graphene::chain::operation_result;
 
   typedef fc::ecc::public_key_data node_id_t;
   typedef fc::ripemd160 item_hash_t;
@@ -86,6 +88,9 @@ namespace graphene { namespace net {
     check_firewall_reply_message_type            = 5015,
     get_current_connections_request_message_type = 5016,
     get_current_connections_reply_message_type   = 5017,
+    compact_block_message_type                   = 5018,
+    fetch_compact_block_transactions_message_type = 5019,
+    compact_block_transactions_message_type      = 5020,
     core_message_type_last                       = 5099
   };
 
@@ -115,6 +120,57 @@ namespace graphene { namespace net {
 
    };
 
+   /**
+    * Sent instead of a block_message to peers which support it.  Transactions are identified by the
+    * short id of the trx_message they were relayed in, see compact_transaction_id(), so the receiver can
+    * rebuild the block from the transactions it has already received and fetch only the others with a
+    * fetch_compact_block_transactions_message.
+    */
+   struct compact_block_message
+   {
+      static const core_message_type_enum type;
+
+      item_hash_t                                 block_message_hash; /// hash of the block_message it stands for
+      signed_block_header                         header;
+      std::vector<uint64_t>                       short_transaction_ids;
+      std::vector<std::vector<operation_result> > operation_results;
+
+      compact_block_message() {}
+      compact_block_message(const item_hash_t& block_message_hash, const signed_block& block);
+   };
+
+   struct fetch_compact_block_transactions_message
+   {
+      static const core_message_type_enum type;
+
+      item_hash_t           block_message_hash;
+      std::vector<uint32_t> transaction_indexes;
+
+      fetch_compact_block_transactions_message() {}
+      fetch_compact_block_transactions_message(const item_hash_t& block_message_hash,
+                                               const std::vector<uint32_t>& transaction_indexes) :
+        block_message_hash(block_message_hash),
+        transaction_indexes(transaction_indexes)
+      {}
+   };
+
+   /** Reply to a fetch_compact_block_transactions_message, with the transactions in the order they were requested */
+   struct compact_block_transactions_message
+   {
+      static const core_message_type_enum type;
+
+      item_hash_t                     block_message_hash;
+      std::vector<signed_transaction> transactions;
+
+      compact_block_transactions_message() {}
+      compact_block_transactions_message(const item_hash_t& block_message_hash) :
+        block_message_hash(block_message_hash)
+      {}
+   };
+
+   /** Short id of a transaction in a compact_block_message: the first 64 bits of the hash of its trx_message */
+   uint64_t compact_transaction_id(const item_hash_t& trx_message_hash);
+
   struct item_ids_inventory_message
   {
     static const core_message_type_enum type;
@@ -424,10 +480,21 @@ FC_REFLECT_ENUM( graphene::net::core_message_type_enum,
                  (check_firewall_reply_message_type)
                  (get_current_connections_request_message_type)
                  (get_current_connections_reply_message_type)
+                 (compact_block_message_type)
+                 (fetch_compact_block_transactions_message_type)
+                 (compact_block_transactions_message_type)
                  (core_message_type_last) )
 
 FC_REFLECT( graphene::net::trx_message, (trx) )
 FC_REFLECT( graphene::net::block_message, (block)(block_id) )
+FC_REFLECT( graphene::net::compact_block_message, (block_message_hash)
+                                                  (header)
+                                                  (short_transaction_ids)
+                                                  (operation_results) )
+FC_REFLECT( graphene::net::fetch_compact_block_transactions_message, (block_message_hash)
+                                                                     (transaction_indexes) )
+FC_REFLECT( graphene::net::compact_block_transactions_message, (block_message_hash)
+                                                               (transactions) )
 
 FC_REFLECT( graphene::net::item_id, (item_type)
                                (item_hash) )
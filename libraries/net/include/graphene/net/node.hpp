@@ -54,6 +54,17 @@ namespace graphene { namespace net {
     node_id_t originating_peer;
   };
 
+  /// Counters of the compact block relay since the node was started
+  struct compact_block_relay_stats
+  {
+    uint64_t blocks_sent = 0;             ///< compact blocks sent to peers instead of full blocks
+    uint64_t blocks_received = 0;
+    uint64_t blocks_reconstructed = 0;    ///< received compact blocks rebuilt without fetching any transaction
+    uint64_t transactions_from_cache = 0; ///< transactions of received compact blocks we already had
+    uint64_t transactions_fetched = 0;
+    uint64_t fallbacks = 0;               ///< received compact blocks which did not rebuild, fetched with all their transactions
+  };
+
    /**
     *  @class node_delegate
     *  @brief used by node reports status to client or fetch data from client
@@ -292,6 +303,7 @@ namespace graphene { namespace net {
 
         void disable_peer_advertising();
         fc::variant_object get_call_statistics() const;
+        compact_block_relay_stats get_compact_block_relay_stats() const;
       private:
         std::unique_ptr<detail::node_impl, detail::node_impl_deleter> my;
    };
@@ -326,3 +338,5 @@ namespace graphene { namespace net {
 
 FC_REFLECT(graphene::net::message_propagation_data, (received_time)(validated_time)(originating_peer));
 FC_REFLECT( graphene::net::peer_status, (version)(host)(info) );
+FC_REFLECT( graphene::net::compact_block_relay_stats, (blocks_sent)(blocks_received)(blocks_reconstructed)
+                                                      (transactions_from_cache)(transactions_fetched)(fallbacks) );
@@ -254,6 +254,16 @@ namespace graphene { namespace net
       timestamped_items_set_type inventory_advertised_to_peer;
 
       item_to_time_map_type items_requested_from_peer;  /// items we've requested from this peer during normal operation.  fetch from another peer if this peer disconnects
+
+      /// a compact block received from this peer, waiting for the transactions we requested from it
+      struct partial_compact_block
+      {
+        compact_block_message compact_block;
+        std::vector<fc::optional<signed_transaction> > transactions;
+        std::vector<uint32_t> requested_transaction_indexes;
+        bool all_transactions_requested = false;
+      };
+      std::map<item_hash_t, partial_compact_block> compact_blocks_being_received; /// by hash of the block_message
       /// @}
 
       // if they're flooding us with transactions, we set this to avoid fetching for a few seconds to let the
@@ -261,6 +271,7 @@ namespace graphene { namespace net
       fc::time_point transaction_fetching_inhibited_until;
 
       uint32_t last_known_fork_block_number;
+      bool supports_compact_blocks; /// set from the hello message, we may send it compact_block_messages instead of blocks
 
       fc::future<void> accept_or_connect_task_done;
 
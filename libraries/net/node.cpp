@@ -30,6 +30,7 @@
 #include <iostream>
 #include <algorithm>
 #include <tuple>
+#include <numeric>
 #include <boost/tuple/tuple.hpp>
 #include <boost/circular_buffer.hpp>
 
@@ -132,6 +133,7 @@ namespace graphene { namespace net {
       struct message_hash_index{};
       struct message_contents_hash_index{};
       struct block_clock_index{};
+      struct short_transaction_id_index{};
       struct message_info
       {
         message_hash_type message_hash;
@@ -141,6 +143,7 @@ namespace graphene { namespace net {
         // for network performance stats
         message_propagation_data propagation_data;
         fc::uint160_t     message_contents_hash; // hash of whatever the message contains (if it's a transaction, this is the transaction id, if it's a block, it's the block_id)
+        uint64_t          short_transaction_id; // the id of a transaction in compact blocks, 0 for other messages
 
         message_info( const message_hash_type& message_hash,
                       const message&           message_body,
@@ -151,7 +154,8 @@ namespace graphene { namespace net {
           message_body( message_body ),
           block_clock_when_received( block_clock_when_received ),
           propagation_data( propagation_data ),
-          message_contents_hash( message_contents_hash )
+          message_contents_hash( message_contents_hash ),
+          short_transaction_id( message_body.msg_type == trx_message_type ? compact_transaction_id( message_hash ) : 0 )
         {}
       };
       typedef boost::multi_index_container
@@ -161,7 +165,9 @@ namespace graphene { namespace net {
                              bmi::ordered_non_unique< bmi::tag<message_contents_hash_index>,
                                                       bmi::member<message_info, fc::uint160_t, &message_info::message_contents_hash> >,
                              bmi::ordered_non_unique< bmi::tag<block_clock_index>,
-                                                      bmi::member<message_info, uint32_t, &message_info::block_clock_when_received> > >
+                                                      bmi::member<message_info, uint32_t, &message_info::block_clock_when_received> >,
+                             bmi::hashed_non_unique< bmi::tag<short_transaction_id_index>,
+                                                     bmi::member<message_info, uint64_t, &message_info::short_transaction_id> > >
         > message_cache_container;
 
       message_cache_container _message_cache;
@@ -176,6 +182,7 @@ namespace graphene { namespace net {
       void cache_message( const message& message_to_cache, const message_hash_type& hash_of_message_to_cache,
                         const message_propagation_data& propagation_data, const fc::uint160_t& message_content_hash );
       message get_message( const message_hash_type& hash_of_message_to_lookup );
+      fc::optional<signed_transaction> get_transaction( uint64_t short_transaction_id ) const;
       message_propagation_data get_message_propagation_data( const fc::uint160_t& hash_of_message_contents_to_lookup ) const;
       size_t size() const { return _message_cache.size(); }
     };
@@ -209,6 +216,15 @@ namespace graphene { namespace net {
       FC_THROW_EXCEPTION(  fc::key_not_found_exception, "Requested message not in cache" );
     }
 
+    fc::optional<signed_transaction> blockchain_tied_message_cache::get_transaction( uint64_t short_transaction_id ) const
+    {
+      auto range = _message_cache.get<short_transaction_id_index>().equal_range( short_transaction_id );
+      for( auto iter = range.first; iter != range.second; ++iter )
+        if( iter->message_body.msg_type == trx_message_type )
+          return iter->message_body.as<trx_message>().trx;
+      return fc::optional<signed_transaction>();
+    }
+
     message_propagation_data blockchain_tied_message_cache::get_message_propagation_data( const fc::uint160_t& hash_of_message_contents_to_lookup ) const
     {
       if( hash_of_message_contents_to_lookup != fc::uint160_t() )
@@ -314,7 +330,9 @@ namespace graphene { namespace net { namespace detail {
       _node_is_shutting_down(false),
       _maximum_number_of_blocks_to_handle_at_one_time(MAXIMUM_NUMBER_OF_BLOCKS_TO_HANDLE_AT_ONE_TIME),
       _maximum_number_of_sync_blocks_to_prefetch(MAXIMUM_NUMBER_OF_BLOCKS_TO_PREFETCH),
-      _maximum_blocks_per_peer_during_syncing(GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING)
+      _maximum_blocks_per_peer_during_syncing(GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING),
+      _sync_block_request_timeout_ms(GRAPHENE_NET_SYNC_BLOCK_REQUEST_TIMEOUT_MS),
+      _compact_blocks_enabled(true)
     {
       _rate_limiter.set_actual_rate_time_constant(fc::seconds(2));
       fc::rand_pseudo_bytes(&_node_id.data[0], (int)_node_id.size());
@@ -480,10 +498,9 @@ namespace graphene { namespace net { namespace detail {
     bool node_impl::have_already_received_sync_item( const item_hash_t& item_hash )
     {
       VERIFY_CORRECT_THREAD();
-      return std::find_if(_received_sync_items.begin(), _received_sync_items.end(),
-                          [&item_hash]( const graphene::net::block_message& message ) { return message.block_id == item_hash; } ) != _received_sync_items.end() ||
+      return _received_sync_items.find(item_hash) != _received_sync_items.end() ||
              std::find_if(_new_received_sync_items.begin(), _new_received_sync_items.end(),
-                          [&item_hash]( const graphene::net::block_message& message ) { return message.block_id == item_hash; } ) != _new_received_sync_items.end();                          ;
+                          [&item_hash]( const graphene::net::block_message& message ) { return message.block_id == item_hash; } ) != _new_received_sync_items.end();
     }
 
     void node_impl::request_sync_item_from_peer( const peer_connection_ptr& peer, const item_hash_t& item_to_request )
@@ -522,35 +539,55 @@ namespace graphene { namespace net { namespace detail {
         if (!_suspend_fetching_sync_blocks)
         {
           std::map<peer_connection_ptr, std::vector<item_hash_t> > sync_item_requests_to_send;
+          prune_stale_received_sync_items();
 
           {
             ASSERT_TASK_NOT_PREEMPTED();
-            std::set<item_hash_t> sync_items_to_request;
+            reassign_stalled_sync_requests();
+
+            // the blocks we've requested and the ones we've received but not yet handed to the client make up
+            // the download window, only request more blocks while it isn't full
+            size_t blocks_in_window = _active_sync_requests.size() + _received_sync_items.size() + _new_received_sync_items.size();
+            size_t window_space = blocks_in_window < _maximum_number_of_sync_blocks_to_prefetch ?
+                                    _maximum_number_of_sync_blocks_to_prefetch - blocks_in_window : 0;
 
-            // for each idle peer that we're syncing with
+            std::vector<peer_connection_ptr> sync_peers;
             for( const peer_connection_ptr& peer : _active_connections )
+              if( peer->we_need_sync_items_from_peer && !peer->inhibit_fetching_sync_blocks )
+                sync_peers.push_back(peer);
+
+            // hand out the blocks one at a time to each peer in turn, in the order they'll be applied, so the next
+            // blocks we need are spread over all the peers we're syncing with instead of queued behind one of them.
+            // Peers which still have requests in flight get more, up to _maximum_blocks_per_peer_during_syncing.
+            std::set<item_hash_t> sync_items_to_request;
+            std::vector<size_t> next_item_index(sync_peers.size(), 0);
+            bool item_scheduled_this_round = true;
+            while( window_space > 0 && item_scheduled_this_round )
             {
-              if( peer->we_need_sync_items_from_peer &&
-                  sync_item_requests_to_send.find(peer) == sync_item_requests_to_send.end() && // if we've already scheduled a request for this peer, don't consider scheduling another
-                  peer->idle() )
+              item_scheduled_this_round = false;
+              for( size_t i = 0; i < sync_peers.size() && window_space > 0; ++i )
               {
-                if (!peer->inhibit_fetching_sync_blocks)
+                const peer_connection_ptr& peer = sync_peers[i];
+                auto requests_iter = sync_item_requests_to_send.find(peer);
+                size_t requests_scheduled = requests_iter == sync_item_requests_to_send.end() ? 0 : requests_iter->second.size();
+                if( peer->sync_items_requested_from_peer.size() + requests_scheduled >= _maximum_blocks_per_peer_during_syncing )
+                  continue;
+
+                // only look as far down the peer's list as the window reaches
+                size_t& index = next_item_index[i];
+                while( index < peer->ids_of_items_to_get.size() && index < _maximum_number_of_sync_blocks_to_prefetch )
                 {
-                  // loop through the items it has that we don't yet have on our blockchain
-                  for( unsigned i = 0; i < peer->ids_of_items_to_get.size(); ++i )
+                  item_hash_t item_to_potentially_request = peer->ids_of_items_to_get[index++];
+                  if( !have_already_received_sync_item(item_to_potentially_request) && // already got it, but for some reson it's still in our list of items to fetch
+                      sync_items_to_request.find(item_to_potentially_request) == sync_items_to_request.end() &&  // we have already decided to request it from another peer during this iteration
+                      _active_sync_requests.find(item_to_potentially_request) == _active_sync_requests.end() && // we've requested it in a previous iteration and we're still waiting for it to arrive
+                      peer->sync_items_requested_from_peer.find(item_to_potentially_request) == peer->sync_items_requested_from_peer.end() ) // this peer is stalling on it, it was reassigned
                   {
-                    item_hash_t item_to_potentially_request = peer->ids_of_items_to_get[i];
-                    // if we don't already have this item in our temporary storage and we haven't requested from another syncing peer
-                    if( !have_already_received_sync_item(item_to_potentially_request) && // already got it, but for some reson it's still in our list of items to fetch
-                        sync_items_to_request.find(item_to_potentially_request) == sync_items_to_request.end() &&  // we have already decided to request it from another peer during this iteration
-                        _active_sync_requests.find(item_to_potentially_request) == _active_sync_requests.end() ) // we've requested it in a previous iteration and we're still waiting for it to arrive
-                    {
-                      // then schedule a request from this peer
-                      sync_item_requests_to_send[peer].push_back(item_to_potentially_request);
-                      sync_items_to_request.insert( item_to_potentially_request );
-                      if (sync_item_requests_to_send[peer].size() >= _maximum_blocks_per_peer_during_syncing)
-                        break;
-                    }
+                    sync_item_requests_to_send[peer].push_back(item_to_potentially_request);
+                    sync_items_to_request.insert( item_to_potentially_request );
+                    --window_space;
+                    item_scheduled_this_round = true;
+                    break;
                   }
                 }
               }
@@ -569,12 +606,86 @@ namespace graphene { namespace net { namespace detail {
         {
           dlog( "no sync items to fetch right now, going to sleep" );
           _retrigger_fetch_sync_items_loop_promise = fc::promise<void>::ptr( new fc::promise<void>("graphene::net::retrigger_fetch_sync_items_loop") );
-          _retrigger_fetch_sync_items_loop_promise->wait();
+          try
+          {
+            // while requests are in flight, wake up in time to reassign the ones which stall
+            if( _active_sync_requests.empty() )
+              _retrigger_fetch_sync_items_loop_promise->wait();
+            else
+              _retrigger_fetch_sync_items_loop_promise->wait(fc::milliseconds(_sync_block_request_timeout_ms));
+          }
+          catch (const fc::timeout_exception&)
+          {
+          }
           _retrigger_fetch_sync_items_loop_promise.reset();
         }
       } // while( !canceled )
     }
 
+    void node_impl::reassign_stalled_sync_requests()
+    {
+      VERIFY_CORRECT_THREAD();
+      // the first block on each peer's list which we haven't received yet is the one holding up the client.
+      // If the peer we asked for it is taking too long, forget the request so the block is asked of another
+      // peer, the slow peer may still deliver it and whichever copy comes first is used.
+      fc::time_point stalled_request_threshold = fc::time_point::now() - fc::milliseconds(_sync_block_request_timeout_ms);
+      for( const peer_connection_ptr& peer : _active_connections )
+      {
+        if( !peer->we_need_sync_items_from_peer )
+          continue;
+        auto next_item_iter = std::find_if(peer->ids_of_items_to_get.begin(), peer->ids_of_items_to_get.end(),
+                                           [this]( const item_hash_t& item ) { return !have_already_received_sync_item(item); });
+        if( next_item_iter == peer->ids_of_items_to_get.end() )
+          continue;
+        auto request_iter = _active_sync_requests.find(*next_item_iter);
+        if( request_iter != _active_sync_requests.end() && request_iter->second < stalled_request_threshold )
+        {
+          dlog( "sync block ${item_hash} was requested ${age} us ago and still hasn't arrived, requesting it from another peer",
+                ("item_hash", *next_item_iter)("age", fc::time_point::now() - request_iter->second) );
+          _active_sync_requests.erase(request_iter);
+        }
+      }
+    }
+
+    bool node_impl::is_item_on_sync_peers_list( const item_hash_t& item_hash ) const
+    {
+      VERIFY_CORRECT_THREAD();
+      for( const peer_connection_ptr& peer : _active_connections )
+        if( std::find(peer->ids_of_items_to_get.begin(), peer->ids_of_items_to_get.end(), item_hash) != peer->ids_of_items_to_get.end() )
+          return true;
+      return false;
+    }
+
+    void node_impl::prune_stale_received_sync_items()
+    {
+      VERIFY_CORRECT_THREAD();
+      // a received block is handed to the client once it is at the front of a sync peer's list. One which no sync
+      // peer lists anymore and which the client already has, e.g. a late copy of a block the client applied, would
+      // stay in _received_sync_items forever and take up room in the download window
+      std::unordered_set<item_hash_t> ids_to_get;
+      std::vector<item_hash_t> unlisted_items;
+      {
+        ASSERT_TASK_NOT_PREEMPTED();
+        if( _received_sync_items.empty() )
+          return;
+        for( const peer_connection_ptr& peer : _active_connections )
+          ids_to_get.insert(peer->ids_of_items_to_get.begin(), peer->ids_of_items_to_get.end());
+        for( const auto& received_item : _received_sync_items )
+          if( ids_to_get.find(received_item.first) == ids_to_get.end() )
+            unlisted_items.push_back(received_item.first);
+      }
+
+      for( const item_hash_t& item_hash : unlisted_items )
+      {
+        // asking the client may yield, the item may have been processed or listed again meanwhile
+        if( !_delegate->has_item(item_id(graphene::net::block_message_type, item_hash)) ||
+            is_item_on_sync_peers_list(item_hash) )
+          continue;
+        if( _received_sync_items.erase(item_hash) )
+          dlog( "dropping stale sync block ${item_hash}, no peer lists it and we already have it", ("item_hash", item_hash) );
+      }
+    }
+
     void node_impl::trigger_fetch_sync_items_loop()
     {
       VERIFY_CORRECT_THREAD();
@@ -1314,6 +1425,15 @@ namespace graphene { namespace net { namespace detail {
       case core_message_type_enum::get_current_connections_reply_message_type:
         on_get_current_connections_reply_message(originating_peer, received_message.as<get_current_connections_reply_message>());
         break;
+      case core_message_type_enum::compact_block_message_type:
+        on_compact_block_message(originating_peer, received_message.as<compact_block_message>());
+        break;
+      case core_message_type_enum::fetch_compact_block_transactions_message_type:
+        on_fetch_compact_block_transactions_message(originating_peer, received_message.as<fetch_compact_block_transactions_message>());
+        break;
+      case core_message_type_enum::compact_block_transactions_message_type:
+        on_compact_block_transactions_message(originating_peer, received_message.as<compact_block_transactions_message>());
+        break;
 
       default:
         // ignore any message in between core_message_type_first and _last that we don't handle above
@@ -1359,6 +1479,9 @@ namespace graphene { namespace net { namespace detail {
       if (!_hard_fork_block_numbers.empty())
         user_data["last_known_fork_block_number"] = _hard_fork_block_numbers.back();
 
+      if (_compact_blocks_enabled)
+        user_data["compact_blocks"] = true;
+
       return user_data;
     }
     void node_impl::parse_hello_user_data_for_peer(peer_connection* originating_peer, const fc::variant_object& user_data)
@@ -1381,6 +1504,8 @@ namespace graphene { namespace net { namespace detail {
         originating_peer->node_id = user_data["node_id"].as<node_id_t>(1);
       if (user_data.contains("last_known_fork_block_number"))
         originating_peer->last_known_fork_block_number = user_data["last_known_fork_block_number"].as<uint32_t>(1);
+      if (user_data.contains("compact_blocks"))
+        originating_peer->supports_compact_blocks = user_data["compact_blocks"].as_bool();
     }
 
     void node_impl::on_hello_message( peer_connection* originating_peer, const hello_message& hello_message_received )
@@ -2267,9 +2392,18 @@ namespace graphene { namespace net { namespace detail {
           dlog("received item request for item ${id} from peer ${endpoint}, returning the item from my message cache",
                ("endpoint", originating_peer->get_remote_endpoint())
                ("id", requested_message.id()));
-          reply_messages.push_back(requested_message);
           if (fetch_items_message_received.item_type == block_message_type)
+          {
             last_block_message_sent = requested_message;
+            // the peer most likely has the transactions of a recent block already, only send their ids
+            if (_compact_blocks_enabled && originating_peer->supports_compact_blocks)
+            {
+              reply_messages.push_back(compact_block_message(item_hash, requested_message.as<graphene::net::block_message>().block));
+              ++_compact_block_stats.blocks_sent;
+              continue;
+            }
+          }
+          reply_messages.push_back(requested_message);
           continue;
         }
         catch (fc::key_not_found_exception&)
@@ -2323,6 +2457,7 @@ namespace graphene { namespace net { namespace detail {
       if (regular_item_iter != originating_peer->items_requested_from_peer.end())
       {
         originating_peer->items_requested_from_peer.erase( regular_item_iter );
+        originating_peer->compact_blocks_being_received.erase( requested_item.item_hash );
         originating_peer->inventory_peer_advertised_to_us.erase( requested_item );
         if (is_item_in_any_peers_inventory(requested_item))
           _items_to_fetch.insert(prioritized_item_id(requested_item, _items_to_fetch_sequence_counter++));
@@ -2752,84 +2887,86 @@ namespace graphene { namespace net { namespace detail {
 
       do
       {
-        std::copy(std::make_move_iterator(_new_received_sync_items.begin()),
-                  std::make_move_iterator(_new_received_sync_items.end()),
-                  std::front_inserter(_received_sync_items));
+        for (graphene::net::block_message& new_received_block : _new_received_sync_items)
+          _received_sync_items.emplace(new_received_block.block_id, std::move(new_received_block));
         _new_received_sync_items.clear();
         dlog("currently ${count} sync items to consider", ("count", _received_sync_items.size()));
 
+        // the next block on the active chain or one of the forks is at the front of a sync peer's list
         block_processed_this_iteration = false;
-        for (auto received_block_iter = _received_sync_items.begin();
-             received_block_iter != _received_sync_items.end();
-             ++received_block_iter)
+        auto received_block_iter = _received_sync_items.end();
+        for (const peer_connection_ptr& peer : _active_connections)
         {
+          ASSERT_TASK_NOT_PREEMPTED(); // don't yield while iterating over _active_connections
+          if (!peer->ids_of_items_to_get.empty())
+          {
+            received_block_iter = _received_sync_items.find(peer->ids_of_items_to_get.front());
+            if (received_block_iter != _received_sync_items.end())
+              break;
+          }
+        }
 
-          // find out if this block is the next block on the active chain or one of the forks
-          bool potential_first_block = false;
+        // if there is one, process it, remove it from all sync peers lists
+        if (received_block_iter != _received_sync_items.end())
+        {
+          graphene::net::block_message block_message_to_process = std::move(received_block_iter->second);
+          _received_sync_items.erase(received_block_iter);
           for (const peer_connection_ptr& peer : _active_connections)
           {
             ASSERT_TASK_NOT_PREEMPTED(); // don't yield while iterating over _active_connections
             if (!peer->ids_of_items_to_get.empty() &&
-                peer->ids_of_items_to_get.front() == received_block_iter->block_id)
+                peer->ids_of_items_to_get.front() == block_message_to_process.block_id)
             {
-              potential_first_block = true;
               peer->ids_of_items_to_get.pop_front();
-              peer->ids_of_items_being_processed.insert(received_block_iter->block_id);
+              peer->ids_of_items_being_processed.insert(block_message_to_process.block_id);
             }
           }
 
-          // if it is, process it, remove it from all sync peers lists
-          if (potential_first_block)
+          // we can get into an interesting situation near the end of synchronization.  We can be in
+          // sync with one peer who is sending us the last block on the chain via a regular inventory
+          // message, while at the same time still be synchronizing with a peer who is sending us the
+          // block through the sync mechanism.  Further, we must request both blocks because
+          // we don't know they're the same (for the peer in normal operation, it has only told us the
+          // message id, for the peer in the sync case we only known the block_id).
+          if (std::find(_most_recent_blocks_accepted.begin(), _most_recent_blocks_accepted.end(),
+                        block_message_to_process.block_id) == _most_recent_blocks_accepted.end())
           {
-            // we can get into an interesting situation near the end of synchronization.  We can be in
-            // sync with one peer who is sending us the last block on the chain via a regular inventory
-            // message, while at the same time still be synchronizing with a peer who is sending us the
-            // block through the sync mechanism.  Further, we must request both blocks because
-            // we don't know they're the same (for the peer in normal operation, it has only told us the
-            // message id, for the peer in the sync case we only known the block_id).
-            if (std::find(_most_recent_blocks_accepted.begin(), _most_recent_blocks_accepted.end(),
-                          received_block_iter->block_id) == _most_recent_blocks_accepted.end())
-            {
-              graphene::net::block_message block_message_to_process = *received_block_iter;
-              _received_sync_items.erase(received_block_iter);
-              _handle_message_calls_in_progress.emplace_back(fc::async([this, block_message_to_process](){
-                send_sync_block_to_node_delegate(block_message_to_process);
-              }, "send_sync_block_to_node_delegate"));
-              ++blocks_processed;
-              block_processed_this_iteration = true;
-            }
-            else
+            _handle_message_calls_in_progress.emplace_back(fc::async([this, block_message_to_process](){
+              send_sync_block_to_node_delegate(block_message_to_process);
+            }, "send_sync_block_to_node_delegate"));
+            ++blocks_processed;
+          }
+          else
+          {
+            dlog("Already received and accepted this block (presumably through normal inventory mechanism), treating it as accepted");
+            std::vector< peer_connection_ptr > peers_needing_next_batch;
+            for (const peer_connection_ptr& peer : _active_connections)
             {
-              dlog("Already received and accepted this block (presumably through normal inventory mechanism), treating it as accepted");
-              std::vector< peer_connection_ptr > peers_needing_next_batch;
-              for (const peer_connection_ptr& peer : _active_connections)
+              auto items_being_processed_iter = peer->ids_of_items_being_processed.find(block_message_to_process.block_id);
+              if (items_being_processed_iter != peer->ids_of_items_being_processed.end())
               {
-                auto items_being_processed_iter = peer->ids_of_items_being_processed.find(received_block_iter->block_id);
-                if (items_being_processed_iter != peer->ids_of_items_being_processed.end())
+                peer->ids_of_items_being_processed.erase(items_being_processed_iter);
+                dlog("Removed item from ${endpoint}'s list of items being processed, still processing ${len} blocks",
+                     ("endpoint", peer->get_remote_endpoint())("len", peer->ids_of_items_being_processed.size()));
+
+                // if we just processed the last item in our list from this peer, we will want to
+                // send another request to find out if we are now in sync (this is normally handled in
+                // send_sync_block_to_node_delegate)
+                if (peer->ids_of_items_to_get.empty() &&
+                    peer->number_of_unfetched_item_ids == 0 &&
+                    peer->ids_of_items_being_processed.empty())
                 {
-                  peer->ids_of_items_being_processed.erase(items_being_processed_iter);
-                  dlog("Removed item from ${endpoint}'s list of items being processed, still processing ${len} blocks",
-                       ("endpoint", peer->get_remote_endpoint())("len", peer->ids_of_items_being_processed.size()));
-
-                  // if we just processed the last item in our list from this peer, we will want to
-                  // send another request to find out if we are now in sync (this is normally handled in
-                  // send_sync_block_to_node_delegate)
-                  if (peer->ids_of_items_to_get.empty() &&
-                      peer->number_of_unfetched_item_ids == 0 &&
-                      peer->ids_of_items_being_processed.empty())
-                  {
-                    dlog("We received last item in our list for peer ${endpoint}, setup to do a sync check", ("endpoint", peer->get_remote_endpoint()));
-                    peers_needing_next_batch.push_back( peer );
-                  }
+                  dlog("We received last item in our list for peer ${endpoint}, setup to do a sync check", ("endpoint", peer->get_remote_endpoint()));
+                  peers_needing_next_batch.push_back( peer );
                 }
               }
-              for( const peer_connection_ptr& peer : peers_needing_next_batch )
-                fetch_next_batch_of_item_ids_from_peer(peer.get());
             }
-
-            break; // start iterating _received_sync_items from the beginning
-          } // end if potential_first_block
-        } // end for each block in _received_sync_items
+            for( const peer_connection_ptr& peer : peers_needing_next_batch )
+              fetch_next_batch_of_item_ids_from_peer(peer.get());
+          }
+          // keep feeding the client, the block after this one may be waiting already
+          block_processed_this_iteration = true;
+        }
 
         if (_handle_message_calls_in_progress.size() >= _maximum_number_of_blocks_to_handle_at_one_time)
         {
@@ -2862,7 +2999,41 @@ namespace graphene { namespace net { namespace detail {
       VERIFY_CORRECT_THREAD();
       dlog( "received a sync block from peer ${endpoint}", ("endpoint", originating_peer->get_remote_endpoint() ) );
 
-      // add it to the front of _received_sync_items, then process _received_sync_items to try to
+      // a block whose request was reassigned can arrive from both peers, only keep the first copy. A copy arriving
+      // after the first one was handed to the client isn't on any sync peer's list anymore, it would never be
+      // processed, so it is only kept if the client still lacks the block
+      const item_hash_t& block_id = block_message_to_process.block_id;
+      const bool block_still_needed = is_item_on_sync_peers_list(block_id) ||
+                                      !_delegate->has_item(item_id(graphene::net::block_message_type, block_id));
+      bool block_already_received = !block_still_needed ||
+                                    have_already_received_sync_item(block_id) ||
+                                    std::find(_most_recent_blocks_accepted.begin(), _most_recent_blocks_accepted.end(),
+                                              block_id) != _most_recent_blocks_accepted.end();
+      for (const peer_connection_ptr& peer : _active_connections)
+        if (peer->ids_of_items_being_processed.find(block_id) != peer->ids_of_items_being_processed.end())
+          block_already_received = true;
+      if (block_already_received)
+      {
+        dlog( "dropping sync block ${block_id} from peer ${endpoint}, we already have it",
+              ("block_id", block_id)("endpoint", originating_peer->get_remote_endpoint()) );
+        trigger_fetch_sync_items_loop();
+        return;
+      }
+
+      // check what doesn't depend on the blocks before it now, while it is waiting for its turn, so a bad
+      // block is fetched again from another peer right away instead of stopping the sync when it is applied
+      if (block_message_to_process.block.id() != block_id ||
+          block_message_to_process.block.calculate_merkle_root() != block_message_to_process.block.transaction_merkle_root)
+      {
+        wlog( "received an invalid sync block ${block_id} from peer ${endpoint}, disconnecting from peer",
+              ("block_id", block_id)("endpoint", originating_peer->get_remote_endpoint()) );
+        fc::exception detailed_error(FC_LOG_MESSAGE(error, "Your block ${block_id} does not match its id or its transaction merkle root",
+                                                    ("block_id", block_id)));
+        disconnect_from_peer(originating_peer, "You sent me an invalid sync block", true, detailed_error);
+        return;
+      }
+
+      // add it to _new_received_sync_items, then process the received sync items to try to
       // pass as many messages as possible to the client.
       _new_received_sync_items.push_front( block_message_to_process );
       trigger_process_backlog_of_sync_blocks();
@@ -3048,16 +3219,13 @@ namespace graphene { namespace net { namespace detail {
             originating_peer->last_sync_item_received_time = fc::time_point::now();
             _active_sync_requests.erase(block_message_to_process.block_id);
             process_block_during_sync(originating_peer, block_message_to_process, message_hash);
-            if (originating_peer->idle())
-            {
-              // we have finished fetching a batch of items, so we either need to grab another batch of items
-              // or we need to get another list of item ids.
-              if (originating_peer->number_of_unfetched_item_ids > 0 &&
-                  originating_peer->ids_of_items_to_get.size() < GRAPHENE_NET_MIN_BLOCK_IDS_TO_PREFETCH)
-                fetch_next_batch_of_item_ids_from_peer(originating_peer);
-              else
-                trigger_fetch_sync_items_loop();
-            }
+            // fetch the next list of item ids while the blocks we've requested are still arriving, so the
+            // download window doesn't run dry, and top up the requests to this peer
+            if (originating_peer->number_of_unfetched_item_ids > 0 &&
+                !originating_peer->item_ids_requested_from_peer &&
+                originating_peer->ids_of_items_to_get.size() < GRAPHENE_NET_MIN_BLOCK_IDS_TO_PREFETCH)
+              fetch_next_batch_of_item_ids_from_peer(originating_peer);
+            trigger_fetch_sync_items_loop();
             return;
           }
           catch (const fc::canceled_exception& e)
@@ -3094,6 +3262,163 @@ namespace graphene { namespace net { namespace detail {
       disconnect_from_peer(originating_peer, "You sent me a block that I didn't ask for", true, detailed_error);
     }
 
+    void node_impl::on_compact_block_message(peer_connection* originating_peer,
+                                             const compact_block_message& compact_block_message_received)
+    {
+      VERIFY_CORRECT_THREAD();
+      const item_hash_t& block_message_hash = compact_block_message_received.block_message_hash;
+      if (originating_peer->items_requested_from_peer.find(item_id(block_message_type, block_message_hash)) ==
+            originating_peer->items_requested_from_peer.end() ||
+          originating_peer->compact_blocks_being_received.find(block_message_hash) !=
+            originating_peer->compact_blocks_being_received.end())
+      {
+        wlog("received a compact block ${hash} I didn't ask for from peer ${endpoint}, disconnecting from peer",
+             ("endpoint", originating_peer->get_remote_endpoint())
+             ("hash", block_message_hash));
+        fc::exception detailed_error(FC_LOG_MESSAGE(error, "You sent me a compact block that I didn't ask for, message_hash: ${hash}",
+                                                    ("hash", block_message_hash)));
+        disconnect_from_peer(originating_peer, "You sent me a block that I didn't ask for", true, detailed_error);
+        return;
+      }
+      const size_t transaction_count = compact_block_message_received.short_transaction_ids.size();
+      if (compact_block_message_received.operation_results.size() != transaction_count)
+      {
+        fc::exception detailed_error(FC_LOG_MESSAGE(error, "You sent me an invalid compact block, message_hash: ${hash}",
+                                                    ("hash", block_message_hash)));
+        disconnect_from_peer(originating_peer, "You sent me an invalid compact block", true, detailed_error);
+        return;
+      }
+      ++_compact_block_stats.blocks_received;
+
+      peer_connection::partial_compact_block& partial_block = originating_peer->compact_blocks_being_received[block_message_hash];
+      partial_block.compact_block = compact_block_message_received;
+      partial_block.transactions.resize(transaction_count);
+      for (uint32_t i = 0; i < transaction_count; ++i)
+      {
+        partial_block.transactions[i] = _message_cache.get_transaction(compact_block_message_received.short_transaction_ids[i]);
+        if (!partial_block.transactions[i])
+          partial_block.requested_transaction_indexes.push_back(i);
+      }
+      _compact_block_stats.transactions_from_cache += transaction_count - partial_block.requested_transaction_indexes.size();
+
+      if (partial_block.requested_transaction_indexes.empty())
+      {
+        ++_compact_block_stats.blocks_reconstructed;
+        finish_compact_block(originating_peer, block_message_hash);
+        return;
+      }
+      dlog("fetching ${count} of the ${total} transactions of compact block ${hash} from peer ${endpoint}",
+           ("count", partial_block.requested_transaction_indexes.size())("total", transaction_count)
+           ("hash", block_message_hash)("endpoint", originating_peer->get_remote_endpoint()));
+      _compact_block_stats.transactions_fetched += partial_block.requested_transaction_indexes.size();
+      originating_peer->send_message(fetch_compact_block_transactions_message(block_message_hash,
+                                                                              partial_block.requested_transaction_indexes));
+    }
+
+    void node_impl::on_fetch_compact_block_transactions_message(peer_connection* originating_peer,
+                                                                const fetch_compact_block_transactions_message& fetch_compact_block_transactions_message_received)
+    {
+      VERIFY_CORRECT_THREAD();
+      const item_hash_t& block_message_hash = fetch_compact_block_transactions_message_received.block_message_hash;
+      signed_block block;
+      try
+      {
+        block = _message_cache.get_message(block_message_hash).as<graphene::net::block_message>().block;
+      }
+      catch (fc::key_not_found_exception&)
+      {
+        // the block fell out of our cache since we sent it, the peer will fetch it from someone else
+        originating_peer->send_message(item_not_available_message(item_id(block_message_type, block_message_hash)));
+        return;
+      }
+
+      compact_block_transactions_message reply(block_message_hash);
+      reply.transactions.reserve(fetch_compact_block_transactions_message_received.transaction_indexes.size());
+      for (uint32_t index : fetch_compact_block_transactions_message_received.transaction_indexes)
+      {
+        if (index >= block.transactions.size())
+        {
+          fc::exception detailed_error(FC_LOG_MESSAGE(error, "You requested transaction ${index} of a block with ${count} transactions",
+                                                      ("index", index)("count", block.transactions.size())));
+          disconnect_from_peer(originating_peer, "You requested a transaction which is not in the block", true, detailed_error);
+          return;
+        }
+        reply.transactions.push_back(block.transactions[index]);
+      }
+      originating_peer->send_message(reply);
+    }
+
+    void node_impl::on_compact_block_transactions_message(peer_connection* originating_peer,
+                                                          const compact_block_transactions_message& compact_block_transactions_message_received)
+    {
+      VERIFY_CORRECT_THREAD();
+      const item_hash_t& block_message_hash = compact_block_transactions_message_received.block_message_hash;
+      auto partial_block_iter = originating_peer->compact_blocks_being_received.find(block_message_hash);
+      if (partial_block_iter == originating_peer->compact_blocks_being_received.end())
+      {
+        dlog("received transactions of compact block ${hash} which we are no longer waiting for", ("hash", block_message_hash));
+        return;
+      }
+      peer_connection::partial_compact_block& partial_block = partial_block_iter->second;
+      if (compact_block_transactions_message_received.transactions.size() != partial_block.requested_transaction_indexes.size())
+      {
+        originating_peer->compact_blocks_being_received.erase(partial_block_iter);
+        fc::exception detailed_error(FC_LOG_MESSAGE(error, "You sent me ${count} transactions of compact block ${hash} instead of ${requested}",
+                                                    ("count", compact_block_transactions_message_received.transactions.size())
+                                                    ("hash", block_message_hash)
+                                                    ("requested", partial_block.requested_transaction_indexes.size())));
+        disconnect_from_peer(originating_peer, "You sent me the wrong transactions of a compact block", true, detailed_error);
+        return;
+      }
+      for (size_t i = 0; i < partial_block.requested_transaction_indexes.size(); ++i)
+        partial_block.transactions[partial_block.requested_transaction_indexes[i]] = compact_block_transactions_message_received.transactions[i];
+      finish_compact_block(originating_peer, block_message_hash);
+    }
+
+    void node_impl::finish_compact_block(peer_connection* originating_peer, const item_hash_t& block_message_hash)
+    {
+      VERIFY_CORRECT_THREAD();
+      auto partial_block_iter = originating_peer->compact_blocks_being_received.find(block_message_hash);
+      peer_connection::partial_compact_block& partial_block = partial_block_iter->second;
+      const compact_block_message& compact_block = partial_block.compact_block;
+
+      signed_block block;
+      static_cast<signed_block_header&>(block) = compact_block.header;
+      block.transactions.reserve(partial_block.transactions.size());
+      for (size_t i = 0; i < partial_block.transactions.size(); ++i)
+      {
+        block.transactions.emplace_back(*partial_block.transactions[i]);
+        block.transactions.back().operation_results = compact_block.operation_results[i];
+      }
+      message block_message_to_process = graphene::net::block_message(block);
+
+      if (block_message_to_process.id() != block_message_hash)
+      {
+        if (!partial_block.all_transactions_requested)
+        {
+          // a short id matched another transaction than the one in the block, fetch all of them from the peer
+          wlog("compact block ${hash} from peer ${endpoint} did not rebuild, fetching all of its transactions",
+               ("hash", block_message_hash)("endpoint", originating_peer->get_remote_endpoint()));
+          ++_compact_block_stats.fallbacks;
+          partial_block.all_transactions_requested = true;
+          partial_block.requested_transaction_indexes.resize(partial_block.transactions.size());
+          std::iota(partial_block.requested_transaction_indexes.begin(), partial_block.requested_transaction_indexes.end(), 0);
+          _compact_block_stats.transactions_fetched += partial_block.requested_transaction_indexes.size();
+          originating_peer->send_message(fetch_compact_block_transactions_message(block_message_hash,
+                                                                                  partial_block.requested_transaction_indexes));
+          return;
+        }
+        originating_peer->compact_blocks_being_received.erase(partial_block_iter);
+        fc::exception detailed_error(FC_LOG_MESSAGE(error, "Your compact block ${hash} does not match the block it stands for",
+                                                    ("hash", block_message_hash)));
+        disconnect_from_peer(originating_peer, "You sent me an invalid compact block", true, detailed_error);
+        return;
+      }
+
+      originating_peer->compact_blocks_being_received.erase(partial_block_iter);
+      process_block_message(originating_peer, block_message_to_process, block_message_hash);
+    }
+
     void node_impl::on_current_time_request_message(peer_connection* originating_peer,
                                                     const current_time_request_message& current_time_request_message_received)
     {
@@ -4525,6 +4850,10 @@ namespace graphene { namespace net { namespace detail {
         _maximum_number_of_sync_blocks_to_prefetch = params["maximum_number_of_sync_blocks_to_prefetch"].as<uint32_t>(1);
       if (params.contains("maximum_blocks_per_peer_during_syncing"))
         _maximum_blocks_per_peer_during_syncing = params["maximum_blocks_per_peer_during_syncing"].as<uint32_t>(1);
+      if (params.contains("sync_block_request_timeout_ms"))
+        _sync_block_request_timeout_ms = params["sync_block_request_timeout_ms"].as<uint32_t>(1);
+      if (params.contains("enable_compact_blocks"))
+        _compact_blocks_enabled = params["enable_compact_blocks"].as_bool();
 
       _desired_number_of_connections = std::min(_desired_number_of_connections, _maximum_number_of_connections);
 
@@ -4544,6 +4873,8 @@ namespace graphene { namespace net { namespace detail {
       result["maximum_number_of_blocks_to_handle_at_one_time"] = _maximum_number_of_blocks_to_handle_at_one_time;
       result["maximum_number_of_sync_blocks_to_prefetch"] = _maximum_number_of_sync_blocks_to_prefetch;
       result["maximum_blocks_per_peer_during_syncing"] = _maximum_blocks_per_peer_during_syncing;
+      result["sync_block_request_timeout_ms"] = _sync_block_request_timeout_ms;
+      result["enable_compact_blocks"] = _compact_blocks_enabled;
       return result;
     }
 
@@ -4604,6 +4935,12 @@ namespace graphene { namespace net { namespace detail {
       return _delegate->get_call_statistics();
     }
 
+    compact_block_relay_stats node_impl::get_compact_block_relay_stats() const
+    {
+      VERIFY_CORRECT_THREAD();
+      return _compact_block_stats;
+    }
+
     fc::variant_object node_impl::network_get_info() const
     {
       VERIFY_CORRECT_THREAD();
@@ -4812,6 +5149,11 @@ namespace graphene { namespace net { namespace detail {
     INVOKE_IN_IMPL(get_call_statistics);
   }
 
+  compact_block_relay_stats node::get_compact_block_relay_stats() const
+  {
+    INVOKE_IN_IMPL(get_compact_block_relay_stats);
+  }
+
   fc::variant_object node::network_get_info() const
   {
     INVOKE_IN_IMPL(network_get_info);
@@ -208,7 +208,7 @@ class node_impl : public peer_connection_delegate
 
       active_sync_requests_map              _active_sync_requests; /// list of sync blocks we've asked for from peers but have not yet received
       std::list<graphene::net::block_message> _new_received_sync_items; /// list of sync blocks we've just received but haven't yet tried to process
-      std::list<graphene::net::block_message> _received_sync_items; /// list of sync blocks we've received, but can't yet process because we are still missing blocks that come earlier in the chain
+      std::unordered_map<item_hash_t, graphene::net::block_message> _received_sync_items; /// sync blocks we've received by block id, but can't yet process because we are still missing blocks that come earlier in the chain
       // @}
 
       fc::future<void> _process_backlog_of_sync_blocks_done;
@@ -334,6 +334,10 @@ class node_impl : public peer_connection_delegate
       unsigned _maximum_number_of_blocks_to_handle_at_one_time;
       unsigned _maximum_number_of_sync_blocks_to_prefetch;
       unsigned _maximum_blocks_per_peer_during_syncing;
+      unsigned _sync_block_request_timeout_ms; /// sync blocks which take longer to arrive are requested from another peer as well
+
+      bool _compact_blocks_enabled; /// whether we offer and send compact blocks to peers which support them
+      compact_block_relay_stats _compact_block_stats;
 
       std::list<fc::future<void> > _handle_message_calls_in_progress;
 
@@ -350,6 +354,9 @@ class node_impl : public peer_connection_delegate
       void request_sync_items_from_peer( const peer_connection_ptr& peer, const std::vector<item_hash_t>& items_to_request );
       void fetch_sync_items_loop();
       void trigger_fetch_sync_items_loop();
+      void reassign_stalled_sync_requests();
+      bool is_item_on_sync_peers_list( const item_hash_t& item_hash ) const;
+      void prune_stale_received_sync_items();
 
       bool is_item_in_any_peers_inventory(const item_id& item) const;
       void fetch_items_loop();
@@ -436,6 +443,18 @@ class node_impl : public peer_connection_delegate
       void on_get_current_connections_reply_message(peer_connection* originating_peer,
                                                     const get_current_connections_reply_message& get_current_connections_reply_message_received);
 
+      void on_compact_block_message(peer_connection* originating_peer,
+                                    const compact_block_message& compact_block_message_received);
+
+      void on_fetch_compact_block_transactions_message(peer_connection* originating_peer,
+                                                       const fetch_compact_block_transactions_message& fetch_compact_block_transactions_message_received);
+
+      void on_compact_block_transactions_message(peer_connection* originating_peer,
+                                                 const compact_block_transactions_message& compact_block_transactions_message_received);
+
+      /// rebuilds the block once all its transactions are known, and processes it as if the block_message was received
+      void finish_compact_block(peer_connection* originating_peer, const item_hash_t& block_message_hash);
+
       void on_connection_closed(peer_connection* originating_peer) override;
 
       void send_sync_block_to_node_delegate(const graphene::net::block_message& block_message_to_send);
@@ -509,6 +528,7 @@ class node_impl : public peer_connection_delegate
       void                       set_total_bandwidth_limit( uint32_t upload_bytes_per_second, uint32_t download_bytes_per_second );
       void                       disable_peer_advertising();
       fc::variant_object         get_call_statistics() const;
+      compact_block_relay_stats  get_compact_block_relay_stats() const;
       message                    get_message_for_item(const item_id& item) override;
 
       fc::variant_object         network_get_info() const;
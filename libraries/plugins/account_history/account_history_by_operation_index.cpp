@@ -0,0 +1,65 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <graphene/account_history/account_history_by_operation_index.hpp>
+
+namespace graphene { namespace account_history {
+
+void account_history_by_operation_index::object_inserted(const object& obj)
+{
+   const auto& entry = static_cast<const account_transaction_history_object&>(obj);
+   const auto* op = _db->find(entry.operation_id);
+   if (op == nullptr)
+      return;
+   _operations[entry.account][op->op.which()].insert(entry.operation_id);
+}
+
+void account_history_by_operation_index::object_removed(const object& obj)
+{
+   const auto& entry = static_cast<const account_transaction_history_object&>(obj);
+   auto account = _operations.find(entry.account);
+   if (account == _operations.end())
+      return;
+
+   // The operation may already be gone when a block is undone, look the entry up under every type of the account
+   for (auto itr = account->second.begin(); itr != account->second.end(); )
+   {
+      itr->second.erase(entry.operation_id);
+      itr = itr->second.empty() ? account->second.erase(itr) : itr + 1;
+   }
+   if (account->second.empty())
+      _operations.erase(account);
+}
+
+const account_history_by_operation_index::operation_set*
+account_history_by_operation_index::find(account_id_type account, int which) const
+{
+   auto itr = _operations.find(account);
+   if (itr == _operations.end())
+      return nullptr;
+   auto type = itr->second.find(which);
+   return type == itr->second.end() ? nullptr : &type->second;
+}
+
+} } // graphene::account_history
@@ -23,6 +23,7 @@
  */
 
 #include <graphene/account_history/account_history_plugin.hpp>
+#include <graphene/account_history/account_history_by_operation_index.hpp>
 
 #include <graphene/chain/impacted.hpp>
 
@@ -56,6 +57,9 @@ class account_history_plugin_impl
        */
       void update_account_histories( const signed_block& b );
 
+      /** moves the history of irreversible blocks from the object database to the store */
+      void archive_irreversible_history();
+
       graphene::chain::database& database()
       {
          return _self.database();
@@ -63,8 +67,12 @@ class account_history_plugin_impl
 
       account_history_plugin& _self;
       flat_set<account_id_type> _tracked_accounts;
+      account_history_store _store;
 };
 
+/// Operations archived per block at most, so that enabling the store on a node with a long history does not stall it
+static const uint32_t max_archived_operations_per_block = 10000;
+
 account_history_plugin_impl::~account_history_plugin_impl()
 {
    return;
@@ -166,15 +174,55 @@ void account_history_plugin_impl::update_account_histories( const signed_block&
                const auto& stats_obj = account_id(db).statistics(db);
                const auto& ath = db.create<account_transaction_history_object>( [&]( account_transaction_history_object& obj ){
                    obj.operation_id = oho_valid_pair.first.id;
+                   obj.account = account_id;
+                   obj.sequence = stats_obj.total_ops+1;
                    obj.next = stats_obj.most_recent_op;
                });
                db.modify( stats_obj, [&]( account_statistics_object& obj ){
                    obj.most_recent_op = ath.id;
+                   obj.total_ops = ath.sequence;
                });
             }
          }
       }
    }
+
+   if( _store.is_open() )
+      archive_irreversible_history();
+}
+
+void account_history_plugin_impl::archive_irreversible_history()
+{
+   graphene::chain::database& db = database();
+   const uint32_t last_irreversible_block = db.get_dynamic_global_properties().last_irreversible_block_num;
+   const auto& ops_by_id = db.get_index_type<operation_history_index>().indices().get<by_id>();
+   const auto& entries_by_op = db.get_index_type<account_transaction_history_index>().indices().get<by_opid>();
+
+   uint32_t archived = 0;
+   while( !ops_by_id.empty() && archived < max_archived_operations_per_block )
+   {
+      const operation_history_object& op = *ops_by_id.begin();
+      if( op.block_num > last_irreversible_block )
+         break;
+
+      // Operations are archived in the order of their ids, so the entries of each account are too
+      _store.append_operation( op );
+      const operation_history_id_type op_id = op.id;
+      auto range = entries_by_op.equal_range( op_id );
+      vector<const account_transaction_history_object*> entries;
+      for( auto itr = range.first; itr != range.second; ++itr )
+      {
+         _store.append_account_entry( itr->account, op );
+         entries.push_back( &*itr );
+      }
+      for( const auto* entry : entries )
+         db.remove( *entry );
+      db.remove( op );
+      ++archived;
+   }
+
+   if( archived > 0 )
+      _store.flush();
 }
 } // end namespace detail
 
@@ -204,6 +252,8 @@ void account_history_plugin::plugin_set_program_options(
 {
    cli.add_options()
          ("track-account", boost::program_options::value<std::vector<std::string>>()->composing()->multitoken(), "Account ID to track history for (may specify multiple times)")
+         ("account-history-dir", boost::program_options::value<boost::filesystem::path>(),
+          "Directory where the history of irreversible blocks is stored, instead of being kept in memory")
          ;
    cfg.add(cli);
 }
@@ -212,18 +262,33 @@ void account_history_plugin::plugin_initialize(const boost::program_options::var
 {
    database().applied_block.connect( [&]( const signed_block& b){ my->update_account_histories(b); } );
    database().add_index< primary_index< operation_history_index > >();
-   database().add_index< primary_index< account_transaction_history_index > >();
+   database().add_index< primary_index< account_transaction_history_index > >()
+         ->add_secondary_index< account_history_by_operation_index >( &database() );
 
    LOAD_VALUE_SET(options, "tracked-accounts", my->_tracked_accounts, graphene::chain::account_id_type);
+
+   if( options.count("account-history-dir") )
+      my->_store.open( options["account-history-dir"].as<boost::filesystem::path>() );
 }
 
 void account_history_plugin::plugin_startup()
 {
 }
 
+void account_history_plugin::plugin_shutdown()
+{
+   if( my->_store.is_open() )
+      my->_store.close();
+}
+
 flat_set<account_id_type> account_history_plugin::tracked_accounts() const
 {
    return my->_tracked_accounts;
 }
 
+const account_history_store* account_history_plugin::store() const
+{
+   return my->_store.is_open() ? &my->_store : nullptr;
+}
+
 } }
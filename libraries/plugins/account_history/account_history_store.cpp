@@ -0,0 +1,506 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <graphene/account_history/account_history_store.hpp>
+#include <graphene/account_history/account_history_by_operation_index.hpp>
+
+#include <graphene/chain/account_object.hpp>
+
+#include <fc/interprocess/file_mapping.hpp>
+#include <fc/io/raw.hpp>
+
+#include <cstring>
+
+namespace graphene { namespace account_history {
+
+namespace {
+
+struct operation_index_entry
+{
+   uint64_t position = 0;
+   uint32_t size = 0;          ///< 0 for ids of operations which failed and were never stored
+   uint32_t block_num = 0;
+};
+
+struct account_entry
+{
+   uint64_t account = 0;
+   uint64_t operation = 0;
+   uint64_t previous = 0;      ///< position of the previous entry of the account plus one, 0 for the first one
+   uint64_t previous_of_type = 0;  ///< same, for the previous entry of the account with the same operation type
+   uint32_t sequence = 0;
+   int32_t  op_type = 0;
+};
+
+static_assert( sizeof(operation_index_entry) == 16, "operation_index_entry is written to disk as is" );
+static_assert( sizeof(account_entry) == 40, "account_entry is written to disk as is" );
+
+void open_stream( std::fstream& stream, const fc::path& filename )
+{
+   stream.exceptions( std::ios_base::failbit | std::ios_base::badbit );
+   if( !fc::exists( filename ) )
+      stream.open( filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out | std::fstream::trunc );
+   else
+      stream.open( filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out );
+}
+
+uint64_t file_size_or_zero( const fc::path& filename )
+{
+   return fc::exists( filename ) ? fc::file_size( filename ) : 0;
+}
+
+} // anonymous namespace
+
+struct account_history_store::mapped_file
+{
+   mapped_file( const fc::path& filename, uint64_t size )
+      : mapping( filename.generic_string().c_str(), fc::read_only ),
+        region( mapping, fc::read_only, 0, size ) {}
+
+   const char* data()const { return (const char*)region.get_address(); }
+   uint64_t size()const { return region.get_size(); }
+
+   fc::file_mapping  mapping;
+   fc::mapped_region region;
+};
+
+account_history_store::account_history_store() {}
+
+account_history_store::~account_history_store()
+{
+   if( is_open() )
+      close();
+}
+
+void account_history_store::open( const fc::path& dir )
+{ try {
+   unmap();
+   fc::create_directories( dir );
+   _operations_filename = dir / "operations";
+   _operation_index_filename = dir / "operations.index";
+   _entries_filename = dir / "entries";
+   _directory_filename = dir / "entries.directory";
+
+   // Drop what an unclean shutdown may have left half written: partial records, and index entries of operations
+   // which did not make it to the log
+   _operations_size = file_size_or_zero( _operations_filename );
+   uint64_t index_size = file_size_or_zero( _operation_index_filename );
+   index_size -= index_size % sizeof(operation_index_entry);
+   while( index_size > 0 )
+   {
+      const auto index = map_file( _operation_index_map, _operation_index_filename, index_size );
+      operation_index_entry e;
+      std::memcpy( (char*)&e, index->data() + index_size - sizeof(e), sizeof(e) );
+      if( e.position + e.size <= _operations_size )
+         break;
+      index_size -= sizeof(e);
+   }
+   uint64_t entries_size = file_size_or_zero( _entries_filename );
+   entries_size -= entries_size % sizeof(account_entry);
+   unmap();
+   if( fc::exists( _operation_index_filename ) && fc::file_size( _operation_index_filename ) != index_size )
+      fc::resize_file( _operation_index_filename, index_size );
+   if( fc::exists( _entries_filename ) && fc::file_size( _entries_filename ) != entries_size )
+      fc::resize_file( _entries_filename, entries_size );
+   _operation_count = index_size / sizeof(operation_index_entry);
+   _entry_count = entries_size / sizeof(account_entry);
+
+   open_stream( _operations, _operations_filename );
+   open_stream( _operation_index, _operation_index_filename );
+   open_stream( _entries, _entries_filename );
+   load_directory();
+} FC_CAPTURE_AND_RETHROW( (dir) ) }
+
+bool account_history_store::is_open()const
+{
+   return _entries.is_open();
+}
+
+void account_history_store::flush()
+{
+   _operations.flush();
+   _operation_index.flush();
+   _entries.flush();
+}
+
+void account_history_store::close()
+{
+   flush();
+   save_directory();
+   unmap();
+   _operations.close();
+   _operation_index.close();
+   _entries.close();
+   _accounts.clear();
+}
+
+void account_history_store::unmap()const
+{
+   std::lock_guard<std::mutex> guard( _map_mutex );
+   _operations_map.reset();
+   _operation_index_map.reset();
+   _entries_map.reset();
+}
+
+account_history_store::mapped_file_ptr account_history_store::map_file( mapped_file_ptr& current,
+                                                                        const fc::path& filename,
+                                                                        uint64_t min_size )const
+{
+   std::lock_guard<std::mutex> guard( _map_mutex );
+   if( current && current->size() >= min_size )
+      return current;
+
+   const uint64_t file_size = file_size_or_zero( filename );
+   if( file_size == 0 || file_size < min_size || ( current && current->size() == file_size ) )
+      return current;
+
+   current = std::make_shared<const mapped_file>( filename, file_size );
+   return current;
+}
+
+void account_history_store::load_directory()
+{
+   _accounts.clear();
+   uint64_t loaded = 0;
+   if( fc::exists( _directory_filename ) )
+   {
+      try
+      {
+         std::vector<char> data( fc::file_size( _directory_filename ) );
+         std::ifstream in( _directory_filename.generic_string().c_str(), std::ios::binary );
+         in.read( data.data(), data.size() );
+         fc::datastream<const char*> ds( data.data(), data.size() );
+         fc::raw::unpack( ds, loaded );
+         fc::raw::unpack( ds, _accounts );
+      }
+      catch( const fc::exception& e )
+      {
+         wlog( "Ignoring the account history directory, it could not be read: ${e}", ("e", e.to_detail_string()) );
+         loaded = 0;
+         _accounts.clear();
+      }
+      if( loaded > _entry_count )
+      {
+         loaded = 0;
+         _accounts.clear();
+      }
+   }
+
+   // The directory is only saved on close, entries appended since are read back from the entries file
+   if( loaded < _entry_count )
+   {
+      const auto entries = map_file( _entries_map, _entries_filename, _entry_count * sizeof(account_entry) );
+      FC_ASSERT( entries && entries->size() >= _entry_count * sizeof(account_entry) );
+      for( uint64_t position = loaded; position < _entry_count; ++position )
+      {
+         account_entry e;
+         std::memcpy( (char*)&e, entries->data() + position * sizeof(e), sizeof(e) );
+         add_to_directory( position, e.account, e.operation, e.op_type );
+      }
+      ilog( "Read ${n} account history entries missing from the directory", ("n", _entry_count - loaded) );
+   }
+}
+
+void account_history_store::save_directory()const
+{
+   const fc::path temporary = _directory_filename.generic_string() + ".tmp";
+   {
+      std::ofstream out( temporary.generic_string().c_str(), std::ios::binary | std::ios::trunc );
+      const auto data = fc::raw::pack( std::make_pair( _entry_count, _accounts ) );
+      out.write( data.data(), data.size() );
+   }
+   fc::rename( temporary, _directory_filename );
+}
+
+void account_history_store::add_to_directory( uint64_t position, uint64_t account, uint64_t operation,
+                                              int32_t op_type )
+{
+   auto& directory = _accounts[account];
+   ++directory.count;
+   directory.last_entry = position + 1;
+   directory.last_operation = operation;
+   directory.last_of_type[op_type] = position + 1;
+   if( directory.count % 64 == 0 )
+      directory.checkpoints.push_back( position );
+}
+
+bool account_history_store::append_operation( const operation_history_object& op )
+{
+   const uint64_t instance = op.id.instance();
+   if( instance < _operation_count )
+      return false;
+
+   _operation_index.seekp( 0, _operation_index.end );
+   const operation_index_entry missing;
+   for( ; _operation_count < instance; ++_operation_count )
+      _operation_index.write( (const char*)&missing, sizeof(missing) );
+
+   const auto data = fc::raw::pack( op );
+   operation_index_entry e;
+   e.position = _operations_size;
+   e.size = data.size();
+   e.block_num = op.block_num;
+   // The operation must reach the log before the index entry pointing at it, see open():
+   _operations.seekp( 0, _operations.end );
+   _operations.write( data.data(), data.size() );
+   _operations_size += data.size();
+   _operation_index.write( (const char*)&e, sizeof(e) );
+   ++_operation_count;
+   return true;
+}
+
+bool account_history_store::append_account_entry( account_id_type account, const operation_history_object& op )
+{
+   auto& directory = _accounts[account.instance.value];
+   if( directory.count > 0 && op.id.instance() <= directory.last_operation )
+      return false;
+
+   account_entry e;
+   e.account = account.instance.value;
+   e.operation = op.id.instance();
+   e.previous = directory.last_entry;
+   e.sequence = directory.count + 1;
+   e.op_type = op.op.which();
+   auto last_of_type = directory.last_of_type.find( e.op_type );
+   e.previous_of_type = last_of_type == directory.last_of_type.end() ? 0 : last_of_type->second;
+   _entries.seekp( 0, _entries.end );
+   _entries.write( (const char*)&e, sizeof(e) );
+   add_to_directory( _entry_count++, e.account, e.operation, e.op_type );
+   return true;
+}
+
+operation_history_id_type account_history_store::next_operation()const
+{
+   return operation_history_id_type( _operation_count );
+}
+
+optional<operation_history_object> account_history_store::get_operation( operation_history_id_type id )const
+{
+   const uint64_t instance = id.instance.value;
+   if( instance >= _operation_count )
+      return {};
+
+   const uint64_t index_pos = instance * sizeof(operation_index_entry);
+   const auto index = map_file( _operation_index_map, _operation_index_filename, index_pos + sizeof(operation_index_entry) );
+   if( !index || index->size() < index_pos + sizeof(operation_index_entry) )
+      return {};
+   operation_index_entry e;
+   std::memcpy( (char*)&e, index->data() + index_pos, sizeof(e) );
+   if( e.size == 0 )
+      return {};
+
+   const auto operations = map_file( _operations_map, _operations_filename, e.position + e.size );
+   FC_ASSERT( operations && operations->size() >= e.position + e.size,
+              "Operation ${id} lies beyond the end of the operations file", ("id", id) );
+   fc::datastream<const char*> ds( operations->data() + e.position, e.size );
+   operation_history_object result;
+   fc::raw::unpack( ds, result );
+   return result;
+}
+
+uint32_t account_history_store::account_entry_count( account_id_type account )const
+{
+   auto itr = _accounts.find( account.instance.value );
+   return itr == _accounts.end() ? 0 : itr->second.count;
+}
+
+void account_history_store::read_entry( uint64_t position, uint64_t& operation, uint64_t& previous )const
+{
+   const auto entries = map_file( _entries_map, _entries_filename, ( position + 1 ) * sizeof(account_entry) );
+   FC_ASSERT( entries && entries->size() >= ( position + 1 ) * sizeof(account_entry),
+              "Account history entry ${p} lies beyond the end of the entries file", ("p", position) );
+   account_entry e;
+   std::memcpy( (char*)&e, entries->data() + position * sizeof(e), sizeof(e) );
+   operation = e.operation;
+   previous = e.previous;
+}
+
+void account_history_store::read_entry_of_type( uint64_t position, uint64_t& operation, uint64_t& previous_of_type )const
+{
+   const auto entries = map_file( _entries_map, _entries_filename, ( position + 1 ) * sizeof(account_entry) );
+   FC_ASSERT( entries && entries->size() >= ( position + 1 ) * sizeof(account_entry),
+              "Account history entry ${p} lies beyond the end of the entries file", ("p", position) );
+   account_entry e;
+   std::memcpy( (char*)&e, entries->data() + position * sizeof(e), sizeof(e) );
+   operation = e.operation;
+   previous_of_type = e.previous_of_type;
+}
+
+optional<uint64_t> account_history_store::find_entry_position( account_id_type account, uint32_t sequence )const
+{
+   auto itr = _accounts.find( account.instance.value );
+   if( itr == _accounts.end() || sequence == 0 || sequence > itr->second.count )
+      return {};
+   const auto& directory = itr->second;
+
+   // Start from the closest checkpoint at or after the sequence, or from the last entry
+   const size_t checkpoint = ( sequence + 63 ) / 64;
+   uint64_t position;
+   uint32_t at;
+   if( checkpoint <= directory.checkpoints.size() )
+   {
+      position = directory.checkpoints[checkpoint - 1];
+      at = checkpoint * 64;
+   }
+   else
+   {
+      position = directory.last_entry - 1;
+      at = directory.count;
+   }
+
+   uint64_t operation;
+   uint64_t previous;
+   for( ; at > sequence; --at )
+   {
+      read_entry( position, operation, previous );
+      FC_ASSERT( previous > 0, "Account history entry ${p} is not linked to the previous one", ("p", position) );
+      position = previous - 1;
+   }
+   return position;
+}
+
+optional<operation_history_id_type> account_history_store::find_account_entry( account_id_type account,
+                                                                              uint32_t sequence )const
+{
+   const auto position = find_entry_position( account, sequence );
+   if( !position )
+      return {};
+   uint64_t operation;
+   uint64_t previous;
+   read_entry( *position, operation, previous );
+   return operation_history_id_type( operation );
+}
+
+void account_history_store::visit_account_entries( account_id_type account, uint32_t sequence,
+                                                   const std::function<bool(uint32_t, operation_history_id_type)>& visitor )const
+{
+   auto position = find_entry_position( account, sequence );
+   if( !position )
+      return;
+
+   uint64_t operation;
+   uint64_t previous;
+   for( uint32_t at = sequence; at > 0; --at )
+   {
+      read_entry( *position, operation, previous );
+      if( !visitor( at, operation_history_id_type( operation ) ) || previous == 0 )
+         return;
+      position = previous - 1;
+   }
+}
+
+void account_history_store::visit_account_entries_of_type( account_id_type account, int which,
+                                                           const std::function<bool(operation_history_id_type)>& visitor )const
+{
+   auto itr = _accounts.find( account.instance.value );
+   if( itr == _accounts.end() )
+      return;
+   auto last = itr->second.last_of_type.find( which );
+   if( last == itr->second.last_of_type.end() )
+      return;
+
+   uint64_t operation;
+   uint64_t previous = last->second;
+   while( previous > 0 )
+   {
+      read_entry_of_type( previous - 1, operation, previous );
+      if( !visitor( operation_history_id_type( operation ) ) )
+         return;
+   }
+}
+
+void visit_account_history( const database& db, const account_history_store* store, account_id_type account,
+                            const std::function<bool(const operation_history_object&)>& visitor )
+{
+   const auto& stats = account(db).statistics(db);
+
+   // The entries of reversible blocks are linked from the most recent one, the link to an archived entry is dangling
+   optional<operation_history_id_type> oldest_in_memory;
+   const account_transaction_history_object* node = nullptr;
+   if( stats.most_recent_op != account_transaction_history_id_type() )
+      node = db.find( stats.most_recent_op );
+   while( node )
+   {
+      oldest_in_memory = node->operation_id;
+      if( !visitor( node->operation_id(db) ) )
+         return;
+      node = node->next == account_transaction_history_id_type() ? nullptr : db.find( node->next );
+   }
+
+   if( store == nullptr )
+      return;
+   store->visit_account_entries( account, store->account_entry_count( account ),
+                                 [&]( uint32_t, operation_history_id_type id ) {
+      // Entries archived by a block which was popped are back in memory until they are archived again
+      if( oldest_in_memory && !( id < *oldest_in_memory ) )
+         return true;
+      const auto op = store->get_operation( id );
+      return !op || visitor( *op );
+   });
+}
+
+optional<operation_history_object> find_account_operation( const database& db, const account_history_store* store,
+                                                           account_id_type account, uint32_t sequence )
+{
+   const auto& by_seq_idx = db.get_index_type<account_transaction_history_index>().indices().get<by_seq>();
+   auto itr = by_seq_idx.find( boost::make_tuple( account, sequence ) );
+   if( itr != by_seq_idx.end() )
+      return itr->operation_id(db);
+
+   if( store == nullptr )
+      return {};
+   const auto id = store->find_account_entry( account, sequence );
+   return id ? store->get_operation( *id ) : optional<operation_history_object>();
+}
+
+void visit_account_history_of_type( const database& db, const account_history_store* store, account_id_type account,
+                                    int which, const std::function<bool(const operation_history_object&)>& visitor )
+{
+   const auto& idx = db.get_index_type<account_transaction_history_index>();
+   const auto& by_operation = dynamic_cast<const primary_index<account_transaction_history_index>&>( idx )
+                                 .get_secondary_index<account_history_by_operation_index>();
+
+   optional<operation_history_id_type> oldest_in_memory;
+   if( const auto* ops = by_operation.find( account, which ) )
+   {
+      for( auto itr = ops->rbegin(); itr != ops->rend(); ++itr )
+      {
+         oldest_in_memory = *itr;
+         const auto* op = db.find( *itr );
+         if( op && !visitor( *op ) )
+            return;
+      }
+   }
+
+   if( store == nullptr )
+      return;
+   store->visit_account_entries_of_type( account, which, [&]( operation_history_id_type id ) {
+      if( oldest_in_memory && !( id < *oldest_in_memory ) )
+         return true;
+      const auto op = store->get_operation( id );
+      return !op || visitor( *op );
+   });
+}
+
+} } // graphene::account_history
@@ -0,0 +1,62 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/operation_history_object.hpp>
+
+#include <map>
+#include <set>
+
+namespace graphene { namespace account_history {
+   using namespace chain;
+
+/**
+ * @brief Indexes the in-memory account history entries by account and operation type.
+ *
+ * The ids of the operations of each type in an account's history are kept ordered, so history filtered by operation
+ * type is a range scan instead of a walk over the whole history of the account.
+ *
+ * This index is attached to the account transaction history index by the account_history plugin.
+ */
+class account_history_by_operation_index : public secondary_index
+{
+  public:
+    typedef std::set<operation_history_id_type> operation_set;
+
+    explicit account_history_by_operation_index(const database* db) : _db(db) {}
+
+    virtual void object_inserted(const object& obj) override;
+    virtual void object_removed(const object& obj) override;
+
+    /// Returns the operations of type @p which in the history of @p account, or nullptr if there are none.
+    const operation_set* find(account_id_type account, int which) const;
+
+  private:
+    const database*                                         _db;
+    std::map<account_id_type, flat_map<int, operation_set>> _operations;
+};
+
+} } // graphene::account_history
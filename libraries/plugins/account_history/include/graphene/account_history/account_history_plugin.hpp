@@ -23,6 +23,8 @@
  */
 #pragma once
 
+#include <graphene/account_history/account_history_store.hpp>
+
 #include <graphene/app/plugin.hpp>
 #include <graphene/chain/database.hpp>
 
@@ -74,8 +76,11 @@ class account_history_plugin : public graphene::app::plugin
          boost::program_options::options_description& cfg) override;
       virtual void plugin_initialize(const boost::program_options::variables_map& options) override;
       virtual void plugin_startup() override;
+      virtual void plugin_shutdown() override;
 
       flat_set<account_id_type> tracked_accounts()const;
+      /// The store of the history of irreversible blocks, null if all history is kept in the object database.
+      const account_history_store* store()const;
 
       friend class detail::account_history_plugin_impl;
       std::unique_ptr<detail::account_history_plugin_impl> my;
@@ -0,0 +1,162 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/operation_history_object.hpp>
+
+#include <fc/filesystem.hpp>
+
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace graphene { namespace account_history {
+   using namespace chain;
+
+/**
+ * What the store keeps in memory about the history of an account, entries are identified by their position in the
+ * entries file.
+ */
+struct account_history_directory
+{
+   uint32_t                count = 0;
+   uint64_t                last_entry = 0;       ///< position of the last entry plus one, 0 if there is none
+   uint64_t                last_operation = 0;   ///< instance of the operation of the last entry
+   std::vector<uint64_t>   checkpoints;          ///< positions of the entries with sequence 64, 128, ...
+   std::map<int32_t, uint64_t> last_of_type;     ///< position of the last entry of each operation type plus one
+};
+
+/**
+ * @brief Keeps the history of irreversible blocks on disk instead of in the object database.
+ *
+ * Operations are appended to a log, with a fixed-size index entry per operation id. The entries of account histories
+ * are appended to a second file, each one pointing back at the previous entry of the same account. In memory there is
+ * only a directory with the number of entries of each account and the position of every 64th one, so the entry with
+ * a given sequence number is at most 64 links away. Each entry also points back at the previous entry of the account
+ * with the same operation type, so the history filtered by operation type is read without skipping other entries.
+ *
+ * Appends go through streams and lookups through read-only memory mappings of what has been flushed, like
+ * @ref chain::block_database. Appending what is already stored is a no-op, so the history of blocks which are applied
+ * again, e.g. when replaying the chain, is not duplicated.
+ */
+class account_history_store
+{
+   public:
+      account_history_store();
+      ~account_history_store();
+
+      void open( const fc::path& dir );
+      bool is_open()const;
+      /// Makes everything appended so far visible to lookups.
+      void flush();
+      void close();
+
+      /**
+       * Operations must be appended in the order of their ids.
+       * @return false if the operation is already stored
+       */
+      bool append_operation( const operation_history_object& op );
+      /**
+       * The entries of an account must be appended in the order of their operation ids, they are numbered from 1.
+       * @return false if the entry is already stored
+       */
+      bool append_account_entry( account_id_type account, const operation_history_object& op );
+
+      /// Id of the next operation to append, all operations before it are stored.
+      operation_history_id_type next_operation()const;
+      optional<operation_history_object> get_operation( operation_history_id_type id )const;
+
+      /// Number of stored entries of the account, their sequence numbers go from 1 to this.
+      uint32_t account_entry_count( account_id_type account )const;
+      optional<operation_history_id_type> find_account_entry( account_id_type account, uint32_t sequence )const;
+      /**
+       * Calls @p visitor with the sequence numbers and operations of the entries of @p account, from @p sequence down
+       * to 1, until it returns false.
+       */
+      void visit_account_entries( account_id_type account, uint32_t sequence,
+                                  const std::function<bool(uint32_t, operation_history_id_type)>& visitor )const;
+      /**
+       * Calls @p visitor with the operations of type @p which in the history of @p account, from the most recent to
+       * the oldest, until it returns false.
+       */
+      void visit_account_entries_of_type( account_id_type account, int which,
+                                          const std::function<bool(operation_history_id_type)>& visitor )const;
+
+   private:
+      struct mapped_file;
+      typedef std::shared_ptr<const mapped_file> mapped_file_ptr;
+
+      mapped_file_ptr map_file( mapped_file_ptr& current, const fc::path& filename, uint64_t min_size )const;
+      void unmap()const;
+      void load_directory();
+      void save_directory()const;
+      void add_to_directory( uint64_t position, uint64_t account, uint64_t operation, int32_t op_type );
+      /// Reads the operation and the position of the previous entry of the account, plus one, of an entry.
+      void read_entry( uint64_t position, uint64_t& operation, uint64_t& previous )const;
+      /// Reads the operation and the position of the previous entry of the account of the same type, plus one.
+      void read_entry_of_type( uint64_t position, uint64_t& operation, uint64_t& previous_of_type )const;
+      optional<uint64_t> find_entry_position( account_id_type account, uint32_t sequence )const;
+
+      fc::path                               _operations_filename;
+      fc::path                               _operation_index_filename;
+      fc::path                               _entries_filename;
+      fc::path                               _directory_filename;
+      std::fstream                           _operations;
+      std::fstream                           _operation_index;
+      std::fstream                           _entries;
+      uint64_t                               _operations_size = 0;
+      uint64_t                               _operation_count = 0;
+      uint64_t                               _entry_count = 0;
+      std::map<uint64_t, account_history_directory> _accounts;
+      mutable std::mutex                     _map_mutex;
+      mutable mapped_file_ptr                _operations_map;
+      mutable mapped_file_ptr                _operation_index_map;
+      mutable mapped_file_ptr                _entries_map;
+};
+
+/**
+ * Calls @p visitor with the operations of @p account from the most recent to the oldest, until it returns false. The
+ * operations of reversible blocks are in the object database, older ones are read from @p store unless it is null.
+ */
+void visit_account_history( const database& db, const account_history_store* store, account_id_type account,
+                            const std::function<bool(const operation_history_object&)>& visitor );
+
+/// Returns the operation of the entry of @p account with the given sequence number, if there is one.
+optional<operation_history_object> find_account_operation( const database& db, const account_history_store* store,
+                                                           account_id_type account, uint32_t sequence );
+
+/**
+ * Like @ref visit_account_history, but only for the operations of type @p which. The operations of reversible blocks
+ * are found through the @ref account_history_by_operation_index of the object database.
+ */
+void visit_account_history_of_type( const database& db, const account_history_store* store, account_id_type account,
+                                    int which, const std::function<bool(const operation_history_object&)>& visitor );
+
+} } // graphene::account_history
+
+FC_REFLECT( graphene::account_history::account_history_directory, (count)(last_entry)(last_operation)(checkpoints)(last_of_type) )
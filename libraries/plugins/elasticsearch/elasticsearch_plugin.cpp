@@ -41,7 +41,7 @@ class elasticsearch_plugin_impl
       {  curl = curl_easy_init(); }
       virtual ~elasticsearch_plugin_impl();
 
-      bool update_account_histories( const signed_block& b );
+      void update_account_histories( const signed_block& b );
 
       graphene::chain::database& database()
       {
@@ -59,22 +59,33 @@ class elasticsearch_plugin_impl
       std::string _elasticsearch_index_prefix = "bitshares-";
       bool _elasticsearch_operation_object = false;
       uint32_t _elasticsearch_start_es_after_block = 0;
+      uint32_t _elasticsearch_max_queued_bulks = 64;
+      bool _elasticsearch_gzip = false;
+      std::string _elasticsearch_spill_file = "es-bulk-spill.json";
+      uint32_t _elasticsearch_stats_interval = 600;
+      fc::time_point _last_stats_log;
       CURL *curl; // curl handler
-      vector <string> bulk_lines; //  vector of op lines
-      vector<std::string> prepare;
 
-      graphene::utilities::ES es;
+      /// a document waiting to be sent, serialized only once the bulk sender gets to it
+      struct pending_document
+      {
+         fc::mutable_variant_object header;
+         bulk_struct                document;
+      };
+      vector<pending_document> pending_documents;
+      std::unique_ptr<graphene::utilities::es_bulk_sender> sender;
+
       uint32_t limit_documents;
       int16_t op_type;
       operation_history_struct os;
       block_struct bs;
       visitor_struct vs;
       bulk_struct bulk_line_struct;
-      std::string bulk_line;
       std::string index_name;
       bool is_sync = false;
+      void start_sender();
    private:
-      bool add_elasticsearch( const account_id_type account_id, const optional<operation_history_object>& oho, const uint32_t block_number );
+      void add_elasticsearch( const account_id_type account_id, const optional<operation_history_object>& oho, const uint32_t block_number );
       const account_transaction_history_object& addNewEntry(const account_statistics_object& stats_obj,
                                                             const account_id_type& account_id,
                                                             const optional <operation_history_object>& oho);
@@ -88,15 +99,18 @@ class elasticsearch_plugin_impl
       void cleanObjects(const account_transaction_history_id_type& ath, const account_id_type& account_id);
       void createBulkLine(const account_transaction_history_object& ath);
       void prepareBulk(const account_transaction_history_id_type& ath_id);
-      void populateESstruct();
+      void sendBulk();
+      void logSenderStats();
 };
 
 elasticsearch_plugin_impl::~elasticsearch_plugin_impl()
 {
-   return;
+   // hand over what was collected since the last bulk, the sender spills it if it cannot be delivered
+   if(sender && pending_documents.size() > 0)
+      sendBulk();
 }
 
-bool elasticsearch_plugin_impl::update_account_histories( const signed_block& b )
+void elasticsearch_plugin_impl::update_account_histories( const signed_block& b )
 {
    checkState(b.timestamp);
    index_name = graphene::utilities::generateIndexName(b.timestamp, _elasticsearch_index_prefix);
@@ -162,29 +176,12 @@ bool elasticsearch_plugin_impl::update_account_histories( const signed_block& b
             impacted.insert( item.first );
 
       for( auto& account_id : impacted )
-      {
-         if(!add_elasticsearch( account_id, oho, b.block_num() ))
-            return false;
-      }
+         add_elasticsearch( account_id, oho, b.block_num() );
    }
    // we send bulk at end of block when we are in sync for better real time client experience
-   if(is_sync)
-   {
-      populateESstruct();
-      if(es.bulk_lines.size() > 0)
-      {
-         prepare.clear();
-         if(!graphene::utilities::SendBulk(std::move(es)))
-            return false;
-         else
-            bulk_lines.clear();
-      }
-   }
-
-   if(bulk_lines.size() != limit_documents)
-      bulk_lines.reserve(limit_documents);
-
-   return true;
+   if(is_sync && pending_documents.size() > 0)
+      sendBulk();
+   logSenderStats();
 }
 
 void elasticsearch_plugin_impl::checkState(const fc::time_point_sec& block_time)
@@ -275,7 +272,7 @@ void elasticsearch_plugin_impl::doVisitor(const optional <operation_history_obje
    vs.fill_data.is_maker = o_v.fill_is_maker;
 }
 
-bool elasticsearch_plugin_impl::add_elasticsearch( const account_id_type account_id,
+void elasticsearch_plugin_impl::add_elasticsearch( const account_id_type account_id,
                                                    const optional <operation_history_object>& oho,
                                                    const uint32_t block_number)
 {
@@ -288,16 +285,9 @@ bool elasticsearch_plugin_impl::add_elasticsearch( const account_id_type account
    }
    cleanObjects(ath.id, account_id);
 
-   if (curl && bulk_lines.size() >= limit_documents) { // we are in bulk time, ready to add data to elasticsearech
-      prepare.clear();
-      populateESstruct();
-      if(!graphene::utilities::SendBulk(std::move(es)))
-         return false;
-      else
-         bulk_lines.clear();
-   }
-
-   return true;
+   // every document takes a header and a source line of the bulk request
+   if (sender && pending_documents.size() * 2 >= limit_documents) // we are in bulk time, ready to add data to elasticsearech
+      sendBulk();
 }
 
 const account_statistics_object& elasticsearch_plugin_impl::getStatsObject(const account_id_type& account_id)
@@ -342,7 +332,6 @@ void elasticsearch_plugin_impl::createBulkLine(const account_transaction_history
    bulk_line_struct.block_data = bs;
    if(_elasticsearch_visitor)
       bulk_line_struct.additional_data = vs;
-   bulk_line = fc::json::to_string(bulk_line_struct, fc::json::legacy_generator);
 }
 
 void elasticsearch_plugin_impl::prepareBulk(const account_transaction_history_id_type& ath_id)
@@ -353,9 +342,7 @@ void elasticsearch_plugin_impl::prepareBulk(const account_transaction_history_id
    bulk_header["_type"] = "data";
    bulk_header["_id"] = fc::to_string(ath_id.space_id) + "." + fc::to_string(ath_id.type_id) + "."
                       + fc::to_string(ath_id.instance.value);
-   prepare = graphene::utilities::createBulk(bulk_header, std::move(bulk_line));
-   std::move(prepare.begin(), prepare.end(), std::back_inserter(bulk_lines));
-   prepare.clear();
+   pending_documents.push_back( pending_document{ std::move(bulk_header), bulk_line_struct } );
 }
 
 void elasticsearch_plugin_impl::cleanObjects(const account_transaction_history_id_type& ath_id, const account_id_type& account_id)
@@ -387,15 +374,52 @@ void elasticsearch_plugin_impl::cleanObjects(const account_transaction_history_i
    }
 }
 
-void elasticsearch_plugin_impl::populateESstruct()
+void elasticsearch_plugin_impl::sendBulk()
 {
-   es.curl = curl;
-   es.bulk_lines = std::move(bulk_lines);
-   es.elasticsearch_url = _elasticsearch_node_url;
-   es.auth = _elasticsearch_basic_auth;
-   es.index_prefix = _elasticsearch_index_prefix;
-   es.endpoint = "";
-   es.query = "";
+   auto documents = std::make_shared<vector<pending_document>>(std::move(pending_documents));
+   pending_documents.clear();
+   pending_documents.reserve(limit_documents / 2);
+
+   // serialization happens on the sender thread, the documents are plain copies of chain state
+   sender->send( [documents]() {
+      vector<std::string> bulk_lines;
+      bulk_lines.reserve(documents->size() * 2);
+      for( auto& d : *documents )
+      {
+         auto lines = graphene::utilities::createBulk(d.header, fc::json::to_string(d.document, fc::json::legacy_generator));
+         std::move(lines.begin(), lines.end(), std::back_inserter(bulk_lines));
+      }
+      return bulk_lines;
+   });
+}
+
+void elasticsearch_plugin_impl::logSenderStats()
+{
+   if(_elasticsearch_stats_interval == 0)
+      return;
+   const fc::time_point now = fc::time_point::now();
+   if(now - _last_stats_log < fc::seconds(_elasticsearch_stats_interval))
+      return;
+   _last_stats_log = now;
+
+   const auto stats = sender->get_stats();
+   ilog("elasticsearch bulk sender: ${q} queued (max ${m}), ${s} spilled, ${sent} sent, ${d} dropped, ${f} failed requests",
+        ("q", stats.queue_size)("m", stats.max_queue_size)("s", stats.bulks_spilled)("sent", stats.bulks_sent)
+        ("d", stats.bulks_dropped)("f", stats.send_failures));
+}
+
+void elasticsearch_plugin_impl::start_sender()
+{
+   graphene::utilities::es_bulk_sender_options options;
+   options.elasticsearch_url = _elasticsearch_node_url;
+   options.auth = _elasticsearch_basic_auth;
+   options.max_queued_bulks = _elasticsearch_max_queued_bulks;
+   options.gzip = _elasticsearch_gzip;
+   // a relative spill file lives in the data directory of the node, not in the working directory
+   options.spill_file = _elasticsearch_spill_file;
+   if( options.spill_file.is_relative() )
+      options.spill_file = _self.app().data_dir() / options.spill_file;
+   sender.reset( new graphene::utilities::es_bulk_sender(options) );
 }
 
 } // end namespace detail
@@ -432,6 +456,10 @@ void elasticsearch_plugin::plugin_set_program_options(
          ("elasticsearch-index-prefix", boost::program_options::value<std::string>(), "Add a prefix to the index(bitshares-)")
          ("elasticsearch-operation-object", boost::program_options::value<bool>(), "Save operation as object(false)")
          ("elasticsearch-start-es-after-block", boost::program_options::value<uint32_t>(), "Start doing ES job after block(0)")
+         ("elasticsearch-max-queued-bulks", boost::program_options::value<uint32_t>(), "Number of bulks waiting to be sent before new ones are spilled to disk(64)")
+         ("elasticsearch-gzip", boost::program_options::value<bool>(), "Compress bulk requests, the node must accept gzip encoded requests(false)")
+         ("elasticsearch-spill-file", boost::program_options::value<std::string>(), "File holding bulks that could not be queued or delivered yet, relative to the data directory(es-bulk-spill.json)")
+         ("elasticsearch-stats-interval", boost::program_options::value<uint32_t>(), "Seconds between logs of the bulk sender queue, spill and retry counters, 0 to disable(600)")
          ;
    cfg.add(cli);
 }
@@ -439,8 +467,7 @@ void elasticsearch_plugin::plugin_set_program_options(
 void elasticsearch_plugin::plugin_initialize(const boost::program_options::variables_map& options)
 {
    database().applied_block.connect( [&]( const signed_block& b) {
-      if (!my->update_account_histories(b))
-         FC_THROW_EXCEPTION(graphene::chain::plugin_exception, "Error populating ES database, we are going to keep trying.");
+      my->update_account_histories(b);
    } );
 
    my->_oho_index = database().add_index< primary_index< operation_history_index > >();
@@ -469,7 +496,22 @@ void elasticsearch_plugin::plugin_initialize(const boost::program_options::varia
    }
    if (options.count("elasticsearch-start-es-after-block")) {
       my->_elasticsearch_start_es_after_block = options["elasticsearch-start-es-after-block"].as<uint32_t>();
-   }   
+   }
+   if (options.count("elasticsearch-max-queued-bulks")) {
+      my->_elasticsearch_max_queued_bulks = options["elasticsearch-max-queued-bulks"].as<uint32_t>();
+   }
+   if (options.count("elasticsearch-gzip")) {
+      my->_elasticsearch_gzip = options["elasticsearch-gzip"].as<bool>();
+   }
+   if (options.count("elasticsearch-spill-file")) {
+      my->_elasticsearch_spill_file = options["elasticsearch-spill-file"].as<std::string>();
+   }
+   if (options.count("elasticsearch-stats-interval")) {
+      my->_elasticsearch_stats_interval = options["elasticsearch-stats-interval"].as<uint32_t>();
+   }
+
+   // blocks are applied during replay, before plugin_startup()
+   my->start_sender();
 }
 
 void elasticsearch_plugin::plugin_startup()
@@ -25,9 +25,19 @@
 
 #include <boost/algorithm/string/join.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <fc/exception/exception.hpp>
 #include <fc/log/logger.hpp>
 #include <fc/io/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
 
 size_t WriteCallback(void *contents, size_t size, size_t nmemb, void *userp)
 {
@@ -65,10 +75,6 @@ const std::string simpleQuery(ES& es)
 bool SendBulk(ES&& es)
 {
    std::string bulking = joinBulkLines(es.bulk_lines);
-   std::ofstream outfile;
-
-   outfile.open("bulk.json", std::ios_base::out);
-   outfile << bulking << "\n";
 
    graphene::utilities::CurlRequest curl_request;
    curl_request.handler = es.curl;
@@ -188,8 +194,397 @@ const std::string doCurl(CurlRequest& curl)
    if(!curl.auth.empty())
       curl_easy_setopt(curl.handler, CURLOPT_USERPWD, curl.auth.c_str());
    curl_easy_perform(curl.handler);
+   curl_slist_free_all(headers);
 
    return CurlReadBuffer;
 }
 
+namespace {
+
+   const std::string gzipBody(const std::string& body)
+   {
+      std::stringstream compressed;
+      {
+         boost::iostreams::filtering_ostream out;
+         out.push(boost::iostreams::gzip_compressor());
+         out.push(compressed);
+         out.write(body.data(), body.size());
+      }
+      return compressed.str();
+   }
+
+}
+
+struct es_bulk_sender::impl
+{
+   // spilled bulks are resent in requests of at most this many lines, i.e. half as many documents
+   static const size_t max_spilled_lines_per_bulk = 10000;
+   static const uint32_t max_retry_delay_seconds = 60;
+
+   enum delivery_result
+   {
+      delivery_done,
+      delivery_retry,
+      delivery_dropped
+   };
+
+   explicit impl( const es_bulk_sender_options& o )
+      : options( o ), curl( curl_easy_init() )
+   {
+      FC_ASSERT( curl, "Unable to create a curl handle for the elasticsearch bulk sender" );
+      headers = curl_slist_append( headers, "Content-Type: application/json" );
+      if( options.gzip )
+         headers = curl_slist_append( headers, "Content-Encoding: gzip" );
+      // the same handle is used for every request, so curl keeps the connection to the node open between bulks
+      curl_easy_setopt( curl, CURLOPT_TCP_KEEPALIVE, 1L );
+      curl_easy_setopt( curl, CURLOPT_HTTPHEADER, headers );
+      curl_easy_setopt( curl, CURLOPT_WRITEFUNCTION, WriteCallback );
+      curl_easy_setopt( curl, CURLOPT_USERAGENT, "libcrp/0.1" );
+      if( !options.auth.empty() )
+         curl_easy_setopt( curl, CURLOPT_USERPWD, options.auth.c_str() );
+      bulk_url = options.elasticsearch_url + "_bulk";
+
+      spill_pending = fc::exists( sending_file() )
+                      || ( fc::exists( options.spill_file ) && fc::file_size( options.spill_file ) > 0 );
+      worker = std::thread( [this]() { run(); } );
+   }
+
+   ~impl()
+   {
+      {
+         std::lock_guard<std::mutex> lock( mutex );
+         stopping = true;
+      }
+      work_cv.notify_all();
+      worker.join();
+      curl_slist_free_all( headers );
+      curl_easy_cleanup( curl );
+   }
+
+   fc::path sending_file()const
+   {
+      return fc::path( options.spill_file.generic_string() + ".sending" );
+   }
+
+   /// appends a bulk to the spill file, the caller holds the mutex
+   void spill( const std::vector<std::string>& lines )
+   {
+      std::ofstream out( options.spill_file.generic_string().c_str(), std::ios::out | std::ios::app | std::ios::binary );
+      out << joinBulkLines( lines );
+      spill_pending = true;
+      ++stats.bulks_spilled;
+   }
+
+   /// serializes the bulks send() could not queue and appends them to the spill file, the caller holds the lock
+   void spill_overflow( std::unique_lock<std::mutex>& lock )
+   {
+      while( !overflow.empty() )
+      {
+         std::deque<es_bulk_sender::bulk_builder> builds;
+         builds.swap( overflow );
+         lock.unlock();
+         std::vector<std::vector<std::string>> bulks;
+         bulks.reserve( builds.size() );
+         for( auto& b : builds )
+         {
+            try
+            {
+               bulks.push_back( b() );
+            }
+            catch( const fc::exception& e )
+            {
+               elog( "Unable to spill elasticsearch bulk: ${e}", ("e", e.to_detail_string()) );
+            }
+         }
+         lock.lock();
+         for( const auto& lines : bulks )
+            spill( lines );
+      }
+   }
+
+   /// puts a bulk in front of the spilled ones, it is older than everything in the spill file; the caller holds the mutex
+   void spill_front( const std::vector<std::string>& lines )
+   {
+      const fc::path temporary( options.spill_file.generic_string() + ".tmp" );
+      {
+         std::ofstream out( temporary.generic_string().c_str(), std::ios::out | std::ios::trunc | std::ios::binary );
+         out << joinBulkLines( lines );
+         std::ifstream in( options.spill_file.generic_string().c_str(), std::ios::in | std::ios::binary );
+         if( in && in.peek() != std::ifstream::traits_type::eof() )
+            out << in.rdbuf();
+      }
+      fc::rename( temporary, options.spill_file );
+      spill_pending = true;
+      ++stats.bulks_spilled;
+   }
+
+   delivery_result deliver( const std::string& body )
+   {
+      const std::string payload = options.gzip ? gzipBody( body ) : body;
+      std::string response;
+      curl_easy_setopt( curl, CURLOPT_URL, bulk_url.c_str() );
+      curl_easy_setopt( curl, CURLOPT_POST, 1L );
+      curl_easy_setopt( curl, CURLOPT_POSTFIELDS, payload.data() );
+      curl_easy_setopt( curl, CURLOPT_POSTFIELDSIZE_LARGE, (curl_off_t)payload.size() );
+      curl_easy_setopt( curl, CURLOPT_WRITEDATA, (void *)&response );
+      if( curl_easy_perform( curl ) != CURLE_OK )
+         return delivery_retry;
+
+      const long http_code = getResponseCode( curl );
+      if( http_code != 200 )
+      {
+         handleBulkResponse( http_code, response );
+         // An overloaded or failing node may take the same request later, any other answer refuses the request itself
+         if( http_code == 429 || http_code >= 500 )
+            return delivery_retry;
+         elog( "Elasticsearch refused a bulk request with ${c}, dropping it: ${r}", ("c", http_code)("r", response) );
+         return delivery_dropped;
+      }
+
+      // Rejected documents would be rejected again, so only a failed request is worth retrying
+      try
+      {
+         if( !handleBulkResponse( http_code, response ) )
+            elog( "Elasticsearch rejected documents of a bulk request: ${r}", ("r", response) );
+      }
+      catch( const fc::exception& e )
+      {
+         elog( "Unable to parse elasticsearch bulk response: ${e}", ("e", e.to_detail_string()) );
+      }
+      return delivery_done;
+   }
+
+   /// retries until the node accepts or refuses the bulk, returns false if the sender was stopped first
+   bool deliver_with_retry( const std::string& body )
+   {
+      uint32_t delay_seconds = 1;
+      delivery_result result;
+      while( ( result = deliver( body ) ) == delivery_retry )
+      {
+         std::unique_lock<std::mutex> lock( mutex );
+         ++stats.send_failures;
+         wlog( "Elasticsearch bulk request failed, retrying in ${s} seconds", ("s", delay_seconds) );
+         // bulks which overflow the queue meanwhile go to disk right away instead of piling up in memory
+         const auto retry_at = std::chrono::steady_clock::now() + std::chrono::seconds( delay_seconds );
+         while( work_cv.wait_until( lock, retry_at, [this]() { return stopping || !overflow.empty(); } ) )
+         {
+            if( stopping )
+               return false;
+            spill_overflow( lock );
+         }
+         delay_seconds = delay_seconds * 2 < max_retry_delay_seconds ? delay_seconds * 2 : max_retry_delay_seconds;
+      }
+      std::lock_guard<std::mutex> lock( mutex );
+      if( result == delivery_dropped )
+         ++stats.bulks_dropped;
+      else
+         ++stats.bulks_sent;
+      return true;
+   }
+
+   void send_spilled()
+   {
+      const fc::path sending = sending_file();
+      {
+         std::lock_guard<std::mutex> lock( mutex );
+         // a leftover from an interrupted run is resent first, the node overwrites documents by id
+         if( !fc::exists( sending ) )
+         {
+            if( !fc::exists( options.spill_file ) )
+            {
+               spill_pending = false;
+               return;
+            }
+            fc::rename( options.spill_file, sending );
+         }
+         // new bulks keep going to the spill file for as long as older ones wait there
+         spill_pending = fc::exists( options.spill_file );
+      }
+
+      {
+         std::ifstream in( sending.generic_string().c_str(), std::ios::in | std::ios::binary );
+         std::vector<std::string> lines;
+         std::string line;
+         while( std::getline( in, line ) )
+         {
+            if( line.empty() )
+               continue;
+            lines.push_back( std::move( line ) );
+            // every document is a header line followed by a source line, never split them
+            if( lines.size() >= max_spilled_lines_per_bulk && lines.size() % 2 == 0 )
+            {
+               if( !deliver_with_retry( joinBulkLines( lines ) ) )
+                  return;
+               lines.clear();
+            }
+         }
+         if( !lines.empty() && !deliver_with_retry( joinBulkLines( lines ) ) )
+            return;
+      }
+      fc::remove( sending );
+
+      std::lock_guard<std::mutex> lock( mutex );
+      if( fc::exists( options.spill_file ) && fc::file_size( options.spill_file ) > 0 )
+         spill_pending = true;
+   }
+
+   void run()
+   {
+      while( true )
+      {
+         es_bulk_sender::bulk_builder build;
+         {
+            std::unique_lock<std::mutex> lock( mutex );
+            work_cv.wait( lock, [this]() { return stopping || !queue.empty() || !overflow.empty() || spill_pending; } );
+            if( stopping )
+               break;
+            // the overflow is newer than anything spilled before, it is appended before the spill file is resent
+            if( !overflow.empty() )
+            {
+               busy = true;
+               spill_overflow( lock );
+               if( !spill_pending && queue.empty() )
+               {
+                  busy = false;
+                  idle_cv.notify_all();
+                  continue;
+               }
+            }
+            // spilled bulks are older than the queued ones, so the spill file is worked off first
+            if( !spill_pending )
+            {
+               build = std::move( queue.front() );
+               queue.pop_front();
+               stats.queue_size = queue.size();
+            }
+            busy = true;
+         }
+
+         try
+         {
+            if( build )
+            {
+               const std::vector<std::string> lines = build();
+               if( !deliver_with_retry( joinBulkLines( lines ) ) )
+               {
+                  std::lock_guard<std::mutex> lock( mutex );
+                  spill_front( lines );
+               }
+            }
+            else
+               send_spilled();
+         }
+         catch( const fc::exception& e )
+         {
+            elog( "Elasticsearch bulk sender failed: ${e}", ("e", e.to_detail_string()) );
+         }
+         catch( const std::exception& e )
+         {
+            elog( "Elasticsearch bulk sender failed: ${e}", ("e", e.what()) );
+         }
+
+         {
+            std::lock_guard<std::mutex> lock( mutex );
+            busy = false;
+         }
+         idle_cv.notify_all();
+      }
+
+      // keep whatever was not delivered for the next run
+      std::lock_guard<std::mutex> lock( mutex );
+      while( !queue.empty() )
+      {
+         try
+         {
+            spill( queue.front()() );
+         }
+         catch( const fc::exception& e )
+         {
+            elog( "Unable to spill elasticsearch bulk: ${e}", ("e", e.to_detail_string()) );
+         }
+         queue.pop_front();
+      }
+      for( auto& build : overflow )
+      {
+         try
+         {
+            spill( build() );
+         }
+         catch( const fc::exception& e )
+         {
+            elog( "Unable to spill elasticsearch bulk: ${e}", ("e", e.to_detail_string()) );
+         }
+      }
+      overflow.clear();
+      stats.queue_size = 0;
+   }
+
+   const es_bulk_sender_options            options;
+   CURL*                                   curl;
+   struct curl_slist*                      headers = nullptr;
+   std::string                             bulk_url;
+
+   mutable std::mutex                      mutex;
+   std::condition_variable                 work_cv;
+   mutable std::condition_variable         idle_cv;
+   std::deque<es_bulk_sender::bulk_builder> queue;
+   /// bulks which did not fit in the queue, waiting for the sender thread to spill them
+   std::deque<es_bulk_sender::bulk_builder> overflow;
+   bool                                    spill_pending = false;
+   bool                                    busy = false;
+   bool                                    stopping = false;
+   es_bulk_sender_stats                    stats;
+   std::thread                             worker;
+};
+
+es_bulk_sender::es_bulk_sender( const es_bulk_sender_options& options )
+   : my( new impl( options ) )
+{
+}
+
+es_bulk_sender::~es_bulk_sender()
+{
+}
+
+void es_bulk_sender::send( bulk_builder&& build )
+{
+   std::unique_lock<std::mutex> lock( my->mutex );
+   if( !my->spill_pending && my->overflow.empty() && my->queue.size() < my->options.max_queued_bulks )
+   {
+      my->queue.push_back( std::move( build ) );
+      ++my->stats.bulks_queued;
+      my->stats.queue_size = my->queue.size();
+      my->stats.max_queue_size = std::max( my->stats.max_queue_size, my->stats.queue_size );
+      lock.unlock();
+      my->work_cv.notify_one();
+      return;
+   }
+
+   // The queue is full or older bulks wait on disk. The queued bulks are older than this one, so they are spilled ahead
+   // of it and the node receives every bulk in order. Serializing and writing them is left to the sender thread.
+   while( !my->queue.empty() )
+   {
+      my->overflow.push_back( std::move( my->queue.front() ) );
+      my->queue.pop_front();
+   }
+   my->overflow.push_back( std::move( build ) );
+   my->stats.queue_size = 0;
+   lock.unlock();
+   my->work_cv.notify_one();
+}
+
+es_bulk_sender_stats es_bulk_sender::get_stats()const
+{
+   std::lock_guard<std::mutex> lock( my->mutex );
+   return my->stats;
+}
+
+bool es_bulk_sender::wait_until_idle( const fc::microseconds& timeout )const
+{
+   std::unique_lock<std::mutex> lock( my->mutex );
+   return my->idle_cv.wait_for( lock, std::chrono::microseconds( timeout.count() ), [this]() {
+      return my->queue.empty() && my->overflow.empty() && !my->spill_pending && !my->busy;
+   } );
+}
+
 } } // end namespace graphene::utilities
@@ -23,10 +23,13 @@
  */
 #pragma once
 #include <cstddef>
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include <curl/curl.h>
+#include <fc/filesystem.hpp>
 #include <fc/time.hpp>
 #include <fc/variant_object.hpp>
 
@@ -53,6 +56,58 @@ namespace graphene { namespace utilities {
          std::string query;
    };
 
+   struct es_bulk_sender_options
+   {
+      std::string elasticsearch_url;
+      std::string auth;
+      /// bulks waiting in memory; once the queue is full new bulks are written to the spill file instead
+      size_t      max_queued_bulks = 64;
+      /// compress request bodies, the node must accept gzip encoded requests
+      bool        gzip = false;
+      /// bulks that could not be queued, delivered before any newer bulk; leftovers are resent after a restart
+      fc::path    spill_file = "es-bulk-spill.json";
+   };
+
+   struct es_bulk_sender_stats
+   {
+      uint64_t bulks_queued   = 0;
+      uint64_t bulks_spilled  = 0;
+      uint64_t bulks_sent     = 0;
+      /// bulks the node refused with a client error other than 429, they are logged and not sent again
+      uint64_t bulks_dropped  = 0;
+      uint64_t send_failures  = 0;
+      size_t   queue_size     = 0;
+      size_t   max_queue_size = 0;
+   };
+
+   /**
+    * Ships bulk requests to elasticsearch from a background thread over a single reused connection.
+    *
+    * Callers hand over a builder that produces the bulk lines, so serialization happens on the sender thread as well.
+    * A bulk which fails to connect or gets a 5xx or 429 answer is retried with a growing delay; other client errors
+    * are logged and the bulk is dropped. Meanwhile new bulks queue up in memory. Once the queue is full, the sender
+    * thread serializes it and appends it to the spill file, also between retries, and so is every later bulk until
+    * the spill file has been delivered, which keeps the bulks in order. send() never waits on the network or the disk.
+    */
+   class es_bulk_sender
+   {
+      public:
+         typedef std::function<std::vector<std::string>()> bulk_builder;
+
+         explicit es_bulk_sender( const es_bulk_sender_options& options );
+         /// stops the thread; bulks that were not delivered yet are moved to the spill file
+         ~es_bulk_sender();
+
+         void send( bulk_builder&& build );
+         es_bulk_sender_stats get_stats()const;
+         /// waits until every queued and spilled bulk has been delivered, returns false if timeout passed first
+         bool wait_until_idle( const fc::microseconds& timeout )const;
+
+      private:
+         struct impl;
+         std::unique_ptr<impl> my;
+   };
+
    bool SendBulk(ES&& es);
    const std::vector<std::string> createBulk(const fc::mutable_variant_object& bulk_header, std::string&& data);
    bool checkES(ES& es);
@@ -691,6 +691,18 @@ BOOST_AUTO_TEST_CASE( get_block_with_virtual_operations )
 
     BOOST_CHECK( count_vops == 5 );
 
+    // Only the requested types are returned:
+    vector<uint16_t> fill_op_ids{ static_cast<uint16_t>(opfo.which()) };
+    results = _dal.get_blocks_with_virtual_operations(1, 20, fill_op_ids);
+    int count_fills = 0;
+    for(auto& blc : results)
+       for(operation& op : blc.block.virtual_operations)
+       {
+          BOOST_CHECK_EQUAL( op.which(), opfo.which() );
+          count_fills++;
+       }
+    BOOST_CHECK( count_fills > 0 && count_fills <= count_vops );
+
 } FC_LOG_AND_RETHROW() }
 
 BOOST_AUTO_TEST_SUITE_END()
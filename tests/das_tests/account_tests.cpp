@@ -28,6 +28,7 @@
 #include <graphene/chain/hardfork.hpp>
 
 #include <graphene/chain/account_object.hpp>
+#include <graphene/app/database_api.hpp>
 
 #include "../common/database_fixture.hpp"
 
@@ -261,5 +262,52 @@ BOOST_AUTO_TEST_CASE(update_global_parameters_test)
 
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( dasc_holder_index_test )
+{ try {
+  ACTOR(wallet);
+  VAULT_ACTORS((vault1)(vault2));
+
+  const auto& aidx = dynamic_cast<const primary_index<account_index>&>(db.get_index_type<account_index>());
+  const auto& ranking = aidx.get_secondary_index<dasc_holder_index>().get_ranking();
+  const auto& holding_of = [&](account_id_type id) -> optional<share_type> {
+    for ( const auto& h : ranking )
+      if ( h.holder == id )
+        return h.amount;
+    return {};
+  };
+
+  tether_accounts(wallet_id, vault1_id);
+  issue_dascoin(vault1_id, 100);
+  issue_dascoin(vault2_id, 50);
+  transfer_dascoin_vault_to_wallet(vault1_id, wallet_id, 1 * DASCOIN_DEFAULT_ASSET_PRECISION);
+  generate_block();
+
+  // The tethered vault is counted under its wallet, the free vault on its own:
+  BOOST_CHECK( !holding_of(vault1_id).valid() );
+  BOOST_CHECK_EQUAL( holding_of(wallet_id)->value, 100 * DASCOIN_DEFAULT_ASSET_PRECISION );
+  BOOST_CHECK_EQUAL( holding_of(vault2_id)->value, 50 * DASCOIN_DEFAULT_ASSET_PRECISION );
+
+  // Tether the second vault, its holdings move to the wallet:
+  tether_accounts(wallet_id, vault2_id);
+  generate_block();
+  BOOST_CHECK( !holding_of(vault2_id).valid() );
+  BOOST_CHECK_EQUAL( holding_of(wallet_id)->value, 150 * DASCOIN_DEFAULT_ASSET_PRECISION );
+
+  graphene::app::application_options app_options;
+  graphene::app::database_api db_api(db, &app_options);
+  auto holders = db_api.get_dasc_holders(0, 1);
+  BOOST_CHECK_EQUAL( holders.size(), 1 );
+  BOOST_CHECK( holders[0].holder == wallet_id );
+  BOOST_CHECK_EQUAL( holders[0].vaults, 2 );
+  BOOST_CHECK_EQUAL( holders[0].amount.value, 150 * DASCOIN_DEFAULT_ASSET_PRECISION );
+  GRAPHENE_REQUIRE_THROW( db_api.get_dasc_holders(0, 101), fc::exception );
+
+  // Undoing the block restores the previous holdings:
+  db.pop_block();
+  BOOST_CHECK_EQUAL( holding_of(wallet_id)->value, 100 * DASCOIN_DEFAULT_ASSET_PRECISION );
+  BOOST_CHECK_EQUAL( holding_of(vault2_id)->value, 50 * DASCOIN_DEFAULT_ASSET_PRECISION );
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()  // account_unit_tests
 BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests
@@ -0,0 +1,225 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <graphene/app/application.hpp>
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/account_object.hpp>
+#include <graphene/chain/das33_object.hpp>
+#include <graphene/chain/global_property_object.hpp>
+#include <graphene/chain/witness_object.hpp>
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/filesystem.hpp>
+#include <fc/io/json.hpp>
+#include <fc/thread/thread.hpp>
+
+#include "../common/database_fixture.hpp"
+#include "../common/genesis_file_util.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+// Benchmarks are disabled by default, run them with --run_test=das_benchmarks
+BOOST_FIXTURE_TEST_SUITE( das_benchmarks, database_fixture, * boost::unit_test::disabled() )
+
+BOOST_AUTO_TEST_CASE( spending_limit_reset_benchmark )
+{ try {
+#ifdef NDEBUG
+  const uint32_t wallet_count = 100000;
+  const uint32_t vault_count = 20000;
+#else
+  const uint32_t wallet_count = 10000;
+  const uint32_t vault_count = 2000;
+#endif
+
+  for ( uint32_t i = 0; i < wallet_count; ++i )
+    create_new_account(get_registrar_id(), "wallet" + fc::to_string(i));
+  for ( uint32_t i = 0; i < vault_count; ++i )
+    create_new_vault_account(get_registrar_id(), "vault" + fc::to_string(i));
+  generate_block();
+
+  // Get to the block right before the reset and time the block which performs it:
+  const auto& dgp = db.get_dynamic_global_properties();
+  generate_blocks(dgp.next_spend_limit_reset - fc::seconds(db.get_global_properties().parameters.block_interval));
+  const auto reset_time = dgp.next_spend_limit_reset;
+
+  auto start = fc::time_point::now();
+  generate_block();
+  auto elapsed = fc::time_point::now() - start;
+
+  BOOST_CHECK( dgp.next_spend_limit_reset > reset_time );
+  ilog("Spending limit reset block with ${w} wallets and ${v} vaults applied in ${t} ms",
+       ("w", wallet_count)("v", vault_count)("t", elapsed.count() / 1000));
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( das33_distribution_benchmark )
+{ try {
+#ifdef NDEBUG
+  const uint32_t pledge_count = 100000;
+#else
+  const uint32_t pledge_count = 10000;
+#endif
+
+  ACTOR(owner);
+  ACTOR(user);
+  asset_id_type token_id = create_new_asset("TEST", 1000000000000000, 5, price{asset(1),asset(1,asset_id_type(1))});
+
+  das33_project_create_operation project_create;
+      project_create.authority       = get_das33_administrator_id();
+      project_create.name            = "benchmark_project";
+      project_create.owner           = owner_id;
+      project_create.token           = token_id;
+      project_create.discounts       = {{get_dascoin_asset_id(), 100}};
+      project_create.goal_amount_eur = 10000000;
+      project_create.min_pledge      = 0;
+      project_create.max_pledge      = 10000000000;
+  do_op(project_create);
+  const das33_project_id_type project_id = get_das33_projects()[0].id;
+
+  // Pledges are created directly, half of them are distributed in a single operation and half over several blocks:
+  const auto create_pledges = [&]() {
+    for ( uint32_t i = 0; i < pledge_count; ++i )
+      db.create<das33_pledge_holder_object>([&](das33_pledge_holder_object& p){
+        p.account_id = user_id;
+        p.project_id = project_id;
+        p.pledged = p.pledge_remaining = asset{1000, get_dascoin_asset_id()};
+        p.base_expected = p.base_remaining = asset{10000, token_id};
+        p.bonus_expected = p.bonus_remaining = asset{0, token_id};
+        p.phase_number = 0;
+        p.timestamp = db.head_block_time();
+      });
+  };
+
+  create_pledges();
+  auto start = fc::time_point::now();
+  do_op_no_balance_check(das33_distribute_project_pledges_operation(get_das33_administrator_id(), project_id, 0, 10000, 10000, 10000));
+  auto one_shot = fc::time_point::now() - start;
+  BOOST_CHECK_EQUAL( get_das33_pledges().size(), 0 );
+
+  create_pledges();
+  const auto& pledges = db.get_index_type<das33_pledge_holder_index>().indices().get<by_project>();
+  das33_pending_distribution distribution;
+  distribution.to_escrow = distribution.base_to_pledger = distribution.bonus_to_pledger = 10000;
+  distribution.timestamp = db.head_block_time();
+  distribution.next_pledge = pledges.begin()->id;
+  distribution.last_pledge = pledges.rbegin()->id;
+  db.modify(project_id(db), [&](das33_project_object& p){
+    p.pending_distributions.push_back(distribution);
+  });
+
+  uint32_t blocks = 0;
+  fc::microseconds max_block;
+  while ( project_id(db).has_pending_distributions() )
+  {
+    start = fc::time_point::now();
+    generate_block();
+    max_block = std::max(max_block, fc::time_point::now() - start);
+    ++blocks;
+  }
+  BOOST_CHECK_EQUAL( get_das33_pledges().size(), 0 );
+  BOOST_CHECK_EQUAL( blocks, (pledge_count + DASCOIN_MAX_DAS33_PLEDGES_PER_BLOCK - 1) / DASCOIN_MAX_DAS33_PLEDGES_PER_BLOCK );
+
+  ilog("Distributed ${n} das33 pledges in a single operation in ${t} ms, over ${b} blocks in at most ${m} ms per block",
+       ("n", pledge_count)("t", one_shot.count() / 1000)("b", blocks)("m", max_block.count() / 1000));
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( multi_peer_sync_benchmark )
+{ try {
+#ifdef NDEBUG
+  const uint32_t block_count = 20000;
+#else
+  const uint32_t block_count = 2000;
+#endif
+  const uint32_t seed_count = 3;
+  const uint32_t first_port = 5050;
+
+  // Start the chain far enough in the past for all of its blocks to be behind us:
+  fc::temp_directory genesis_dir( graphene::utilities::temp_directory_path() );
+  genesis_state_type example_genesis = graphene::app::detail::create_example_genesis();
+  const uint32_t block_interval = example_genesis.initial_parameters.block_interval;
+  example_genesis.initial_timestamp = fc::time_point_sec(
+        (fc::time_point::now().sec_since_epoch() - 2 * block_count * block_interval) / block_interval * block_interval );
+  fc::path genesis_path = genesis_dir.path() / "genesis.json";
+  fc::json::save_to_file( example_genesis, genesis_path );
+
+  boost::program_options::variables_map cfg;
+  cfg.emplace("genesis-json", boost::program_options::variable_value(boost::filesystem::path(genesis_path.generic_string()), false));
+  cfg.emplace("seed-nodes", boost::program_options::variable_value(string("[]"), false));
+
+  std::vector<std::unique_ptr<fc::temp_directory>> seed_dirs;
+  std::vector<std::unique_ptr<graphene::app::application>> seeds;
+  vector<string> seed_endpoints;
+  for ( uint32_t i = 0; i < seed_count; ++i )
+  {
+    seed_endpoints.push_back("127.0.0.1:" + fc::to_string(first_port + i));
+    seed_dirs.emplace_back(new fc::temp_directory(graphene::utilities::temp_directory_path()));
+    seeds.emplace_back(new graphene::app::application());
+    seeds.back()->startup_plugins();
+    auto seed_cfg = cfg;
+    seed_cfg.emplace("p2p-endpoint", boost::program_options::variable_value(seed_endpoints.back(), false));
+    seeds.back()->initialize(seed_dirs.back()->path(), seed_cfg);
+    seeds.back()->startup();
+  }
+
+  // Witnesses of the example genesis sign with the key generated from their account name:
+  std::shared_ptr<database> producer_db = seeds.front()->chain_database();
+  for ( uint32_t i = 0; i < block_count; ++i )
+  {
+    const witness_id_type witness = producer_db->get_scheduled_witness(1);
+    const string& witness_name = witness(*producer_db).witness_account(*producer_db).name;
+    signed_block block = producer_db->generate_block(producer_db->get_slot_time(1), witness,
+                                                     fc::ecc::private_key::regenerate(fc::sha256::hash(witness_name)),
+                                                     database::skip_nothing);
+    for ( uint32_t j = 1; j < seed_count; ++j )
+      seeds[j]->chain_database()->push_block(block);
+  }
+
+  fc::temp_directory sync_dir( graphene::utilities::temp_directory_path() );
+  graphene::app::application sync_app;
+  sync_app.startup_plugins();
+  auto sync_cfg = cfg;
+  sync_cfg.emplace("p2p-endpoint", boost::program_options::variable_value("127.0.0.1:" + fc::to_string(first_port + seed_count), false));
+  sync_cfg.emplace("seed-node", boost::program_options::variable_value(seed_endpoints, false));
+  sync_app.initialize(sync_dir.path(), sync_cfg);
+
+  auto start = fc::time_point::now();
+  sync_app.startup();
+  std::shared_ptr<database> sync_db = sync_app.chain_database();
+  const auto deadline = start + fc::seconds(600);
+  while ( sync_db->head_block_num() < block_count && fc::time_point::now() < deadline )
+    fc::usleep(fc::milliseconds(10));
+  auto elapsed = fc::time_point::now() - start;
+
+  BOOST_REQUIRE_EQUAL( sync_db->head_block_num(), block_count );
+  BOOST_CHECK( sync_db->head_block_id() == producer_db->head_block_id() );
+  ilog("Synced ${n} blocks from ${p} peers in ${t} ms, ${r} blocks/s",
+       ("n", block_count)("p", seed_count)("t", elapsed.count() / 1000)
+       ("r", block_count * 1000000.0 / elapsed.count()));
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()  // das_benchmarks
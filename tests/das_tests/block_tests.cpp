@@ -0,0 +1,202 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <graphene/chain/block_database.hpp>
+#include <graphene/chain/exceptions.hpp>
+#include <graphene/app/transaction_admission.hpp>
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/filesystem.hpp>
+#include <fc/thread/thread.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+BOOST_FIXTURE_TEST_SUITE( dascoin_tests, database_fixture )
+BOOST_FIXTURE_TEST_SUITE( block_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( block_database_remove_and_recover_test )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+
+      block_database bdb;
+      bdb.open( data_dir.path() );
+
+      signed_block b;
+      vector<block_id_type> ids;
+      for( uint32_t i = 0; i < 5; ++i )
+      {
+         if( i > 0 ) b.previous = b.id();
+         b.witness = witness_id_type(i+1);
+         bdb.store( b.id(), b );
+         ids.push_back( b.id() );
+      }
+
+      // Removed blocks vanish from lookups made through the mapped index:
+      bdb.remove( ids[4] );
+      FC_ASSERT( !bdb.contains( ids[4] ) );
+      FC_ASSERT( !bdb.fetch_optional( ids[4] ).valid() );
+      FC_ASSERT( bdb.contains( ids[3] ) );
+      FC_ASSERT( bdb.fetch_block_id( 4 ) == ids[3] );
+
+      // The removed entry is cut off the index on the next lookup of the last block:
+      auto last = bdb.last();
+      FC_ASSERT( last );
+      FC_ASSERT( last->id() == ids[3] );
+
+      // Blocks stored after the index has been truncated are visible again:
+      bdb.store( ids[4], b );
+      FC_ASSERT( bdb.contains( ids[4] ) );
+      FC_ASSERT( *bdb.last_id() == ids[4] );
+
+      bdb.close();
+      bdb.open( data_dir.path() );
+      for( uint32_t i = 0; i < 5; ++i )
+      {
+         auto blk = bdb.fetch_by_number( i+1 );
+         FC_ASSERT( blk.valid() );
+         FC_ASSERT( blk->id() == ids[i] );
+      }
+
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( transaction_admission_test )
+{ try {
+   generate_block();
+   ACTOR(bob);
+   ACTOR(carol);
+
+   set_expiration( db, trx );
+   transfer_operation t;
+   t.from = account_id_type();
+   t.to = bob_id;
+   t.amount = asset(1000);
+   trx.operations.push_back(t);
+   for( auto& op : trx.operations ) db.current_fee_schedule().set_fee(op);
+   db.push_transaction(trx, ~0);
+
+   graphene::app::transaction_admission admission( db, 1 );
+   const auto& stats = admission.get_stats();
+   const auto bob_to_carol = [&]( share_type amount ) {
+      trx.clear();
+      set_expiration( db, trx );
+      transfer_operation t;
+      t.from = bob_id;
+      t.to = carol_id;
+      t.amount = asset(amount);
+      trx.operations.push_back(t);
+      for( auto& op : trx.operations ) db.current_fee_schedule().set_fee(op);
+   };
+
+   bob_to_carol( -100 );
+   sign( trx, bob_private_key );
+   GRAPHENE_REQUIRE_THROW( admission.admit(trx), fc::exception );
+   BOOST_CHECK_EQUAL( stats.rejected_invalid, 1 );
+
+   bob_to_carol( 100 );
+   sign( trx, bob_private_key );
+   sign( trx, bob_private_key );
+   GRAPHENE_REQUIRE_THROW( admission.admit(trx), tx_duplicate_sig );
+   BOOST_CHECK_EQUAL( stats.rejected_signatures, 1 );
+
+   trx.signatures.pop_back();
+   admission.admit(trx);
+   BOOST_CHECK_EQUAL( stats.admitted, 1 );
+   BOOST_CHECK_EQUAL( db.get_balance( carol_id, asset_id_type() ).amount.value, 100 );
+
+   GRAPHENE_REQUIRE_THROW( admission.admit(trx), fc::exception );
+   BOOST_CHECK_EQUAL( stats.rejected_duplicate, 1 );
+
+   bob_to_carol( 200 );
+   trx.expiration = db.head_block_time() - 1;
+   sign( trx, bob_private_key );
+   GRAPHENE_REQUIRE_THROW( admission.admit(trx), fc::exception );
+   BOOST_CHECK_EQUAL( stats.rejected_expiration, 1 );
+
+   BOOST_TEST_MESSAGE( "Unsigned transactions pass the checks and are rejected when applied" );
+   bob_to_carol( 300 );
+   GRAPHENE_REQUIRE_THROW( admission.admit(trx), fc::exception );
+   BOOST_CHECK_EQUAL( stats.rejected_apply, 1 );
+
+   BOOST_CHECK_EQUAL( stats.received, 6 );
+   BOOST_CHECK_EQUAL( db.get_balance( carol_id, asset_id_type() ).amount.value, 100 );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( transaction_admission_order_test )
+{ try {
+   generate_block();
+   ACTOR(bob);
+   ACTOR(carol);
+   ACTOR(dave);
+   transfer( account_id_type(), bob_id, asset( 1000 ) );
+
+   graphene::app::transaction_admission admission( db, 2 );
+   const auto make_transfer = [&]( account_id_type from, account_id_type to, share_type amount, size_t count ) {
+      signed_transaction tx;
+      set_expiration( db, tx );
+      for( size_t i = 0; i < count; ++i )
+      {
+         transfer_operation t;
+         t.from = from;
+         t.to = to;
+         t.amount = asset(amount);
+         tx.operations.push_back(t);
+      }
+      for( auto& op : tx.operations ) db.current_fee_schedule().set_fee(op);
+      return tx;
+   };
+
+   // The first transaction takes longer to check, the second one spends what the first one transfers:
+   signed_transaction bob_to_carol = make_transfer( bob_id, carol_id, 10, 100 );
+   sign( bob_to_carol, bob_private_key );
+   signed_transaction carol_to_dave = make_transfer( carol_id, dave_id, 1000, 1 );
+   sign( carol_to_dave, carol_private_key );
+
+   auto first = fc::async( [&]{ return admission.admit( bob_to_carol ); } );
+   auto second = fc::async( [&]{ return admission.admit( carol_to_dave ); } );
+   first.wait();
+   second.wait();
+
+   BOOST_CHECK_EQUAL( admission.get_stats().admitted, 2 );
+   BOOST_CHECK_EQUAL( db.get_balance( dave_id, asset_id_type() ).amount.value, 1000 );
+
+   generate_block();
+   const auto& transactions = db.fetch_block_by_number( db.head_block_num() )->transactions;
+   BOOST_REQUIRE_EQUAL( transactions.size(), 2 );
+   BOOST_CHECK( transactions[0].id() == bob_to_carol.id() );
+   BOOST_CHECK( transactions[1].id() == carol_to_dave.id() );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests::block_tests
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests
@@ -27,6 +27,7 @@
 #include <graphene/chain/access_layer.hpp>
 #include <graphene/chain/exceptions.hpp>
 #include <graphene/chain/das33_object.hpp>
+#include <graphene/chain/das33_pledge_aggregate_index.hpp>
 #include <graphene/chain/market_object.hpp>
 #include "../common/database_fixture.hpp"
 
@@ -701,6 +702,139 @@ BOOST_AUTO_TEST_CASE( das33_reject_project_test )
 
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( das33_pledge_aggregates_test )
+{ try {
+
+    ACTOR(alice);
+    ACTOR(bob);
+    const das33_project_id_type project_id(1);
+    const asset_id_type token_id(100);
+
+    const auto& idx = db.get_index_type<das33_pledge_holder_index>();
+    const auto& aggregates = dynamic_cast<const primary_index<das33_pledge_holder_index>&>(idx).get_secondary_index<das33_pledge_aggregate_index>();
+
+    const auto pledge = [&](account_id_type account, asset pledged, share_type base, share_type phase) -> const das33_pledge_holder_object& {
+      return db.create<das33_pledge_holder_object>([&](das33_pledge_holder_object& p){
+        p.account_id = account;
+        p.project_id = project_id;
+        p.pledged = p.pledge_remaining = pledged;
+        p.base_expected = p.base_remaining = asset{base, token_id};
+        p.bonus_expected = p.bonus_remaining = asset{base / 10, token_id};
+        p.phase_number = phase;
+      });
+    };
+
+    BOOST_CHECK( aggregates.get_project_totals(project_id) == nullptr );
+
+    pledge(alice_id, asset{100, get_dascoin_asset_id()}, 1000, 0);
+    const auto& second = pledge(alice_id, asset{50, get_btc_asset_id()}, 500, 1);
+    pledge(bob_id, asset{200, get_dascoin_asset_id()}, 2000, 1);
+
+    const auto* project_totals = aggregates.get_project_totals(project_id);
+    BOOST_REQUIRE( project_totals != nullptr );
+    BOOST_CHECK_EQUAL( project_totals->count, 3 );
+    BOOST_CHECK_EQUAL( project_totals->pledged.at(get_dascoin_asset_id()).amount.value, 300 );
+    BOOST_CHECK_EQUAL( project_totals->pledged.at(get_btc_asset_id()).amount.value, 50 );
+    BOOST_CHECK_EQUAL( project_totals->base_expected.value, 3500 );
+    BOOST_CHECK_EQUAL( project_totals->bonus_expected.value, 350 );
+
+    const auto* phase_totals = aggregates.get_phase_totals(project_id, 1);
+    BOOST_REQUIRE( phase_totals != nullptr );
+    BOOST_CHECK_EQUAL( phase_totals->count, 2 );
+    BOOST_CHECK_EQUAL( phase_totals->base_expected.value, 2500 );
+
+    const auto* alice_totals = aggregates.get_account_totals(alice_id);
+    BOOST_REQUIRE( alice_totals != nullptr );
+    BOOST_CHECK_EQUAL( alice_totals->size(), 2 );
+    BOOST_CHECK_EQUAL( alice_totals->rbegin()->first.second.value, 1 );
+    BOOST_CHECK_EQUAL( alice_totals->rbegin()->second.base_expected.value, 500 );
+
+    // Distributing only changes the remaining amounts, removing the pledge holder removes it from the totals:
+    db.modify(second, [](das33_pledge_holder_object& p){
+      p.pledge_remaining.amount = 0;
+    });
+    BOOST_CHECK_EQUAL( aggregates.get_project_totals(project_id)->pledged.at(get_btc_asset_id()).amount.value, 50 );
+
+    db.remove(second);
+    project_totals = aggregates.get_project_totals(project_id);
+    BOOST_CHECK_EQUAL( project_totals->count, 2 );
+    BOOST_CHECK( project_totals->pledged.find(get_btc_asset_id()) == project_totals->pledged.end() );
+    BOOST_CHECK_EQUAL( aggregates.get_phase_totals(project_id, 1)->count, 1 );
+    BOOST_CHECK_EQUAL( aggregates.get_account_totals(alice_id)->size(), 1 );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( das33_queued_distribution_test )
+{ try {
+
+    // After the hardfork project pledges are distributed over several blocks:
+    generate_blocks(HARDFORK_DAS33_SPREAD_DISTRIBUTION_TIME);
+    generate_block();
+
+    ACTOR(owner);
+    ACTOR(user);
+    const auto das33_admin_id = get_das33_administrator_id();
+    asset_id_type token_id = create_new_asset("TEST", 1000000000000000, 5, price{asset(1),asset(1,asset_id_type(1))});
+
+    das33_project_create_operation project_create;
+        project_create.authority       = das33_admin_id;
+        project_create.name            = "queued_project";
+        project_create.owner           = owner_id;
+        project_create.token           = token_id;
+        project_create.discounts       = {{get_dascoin_asset_id(), 100}};
+        project_create.goal_amount_eur = 10000000;
+        project_create.min_pledge      = 0;
+        project_create.max_pledge      = 10000000000;
+    do_op(project_create);
+    generate_block();
+    const das33_project_id_type project_id = get_das33_projects()[0].id;
+
+    const auto create_pledge = [&]() {
+      return das33_pledge_holder_id_type{ db.create<das33_pledge_holder_object>([&](das33_pledge_holder_object& p){
+        p.account_id = user_id;
+        p.project_id = project_id;
+        p.pledged = p.pledge_remaining = asset{1000, get_dascoin_asset_id()};
+        p.base_expected = p.base_remaining = asset{10000, token_id};
+        p.bonus_expected = p.bonus_remaining = asset{0, token_id};
+        p.phase_number = 0;
+        p.timestamp = db.head_block_time();
+      }).id };
+    };
+
+    // More pledges than are distributed in a single block:
+    const uint32_t pledge_count = DASCOIN_MAX_DAS33_PLEDGES_PER_BLOCK + 10;
+    std::vector<das33_pledge_holder_id_type> pledges;
+    for ( uint32_t i = 0; i < pledge_count; ++i )
+      pledges.push_back(create_pledge());
+
+    do_op_no_balance_check(das33_distribute_project_pledges_operation(das33_admin_id, project_id, 0, 10000, 10000, 10000));
+    BOOST_CHECK( project_id(db).has_pending_distributions() );
+    BOOST_CHECK_EQUAL( get_das33_pledges().size(), pledge_count );
+
+    // Queued pledges can neither be refunded nor paid out ahead of the distribution:
+    GRAPHENE_REQUIRE_THROW( do_op_no_balance_check(das33_pledge_reject_operation(das33_admin_id, pledges.back())), fc::exception );
+    GRAPHENE_REQUIRE_THROW( do_op_no_balance_check(das33_project_reject_operation(das33_admin_id, project_id)), fc::exception );
+    GRAPHENE_REQUIRE_THROW( do_op_no_balance_check(das33_distribute_pledge_operation(das33_admin_id, pledges.front(), 10000, 10000, 10000)), fc::exception );
+
+    generate_block();
+    BOOST_CHECK( project_id(db).has_pending_distributions() );
+    BOOST_CHECK_EQUAL( get_das33_pledges().size(), pledge_count - DASCOIN_MAX_DAS33_PLEDGES_PER_BLOCK );
+    GRAPHENE_REQUIRE_THROW( do_op_no_balance_check(das33_pledge_reject_operation(das33_admin_id, pledges.back())), fc::exception );
+    GRAPHENE_REQUIRE_THROW( do_op_no_balance_check(das33_project_reject_operation(das33_admin_id, project_id)), fc::exception );
+
+    // A pledge made after the distribution was requested is not part of it and can be handled on its own:
+    const das33_pledge_holder_id_type late_pledge = create_pledge();
+    do_op_no_balance_check(das33_distribute_pledge_operation(das33_admin_id, late_pledge, 10000, 10000, 10000));
+    BOOST_CHECK_EQUAL( get_das33_pledges().size(), pledge_count - DASCOIN_MAX_DAS33_PLEDGES_PER_BLOCK );
+
+    generate_block();
+    BOOST_CHECK( !project_id(db).has_pending_distributions() );
+    BOOST_CHECK_EQUAL( get_das33_pledges().size(), 0 );
+    BOOST_CHECK_EQUAL( get_balance(owner_id, get_dascoin_asset_id()), (pledge_count + 1) * 1000 );
+    BOOST_CHECK_EQUAL( get_balance(user_id, token_id), (pledge_count + 1) * 10000 );
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests::das33_tests
 BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests
 
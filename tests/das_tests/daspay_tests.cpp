@@ -162,6 +162,104 @@ BOOST_AUTO_TEST_CASE( delayed_operations_index_test )
 
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( delayed_operations_due_time_index_test )
+{ try {
+  ACTORS((wa1)(wa2));
+
+  const auto now = db.head_block_time();
+
+  const auto& late = db.create<delayed_operation_object>([&](delayed_operation_object& dlo){
+    dlo.account = wa1_id;
+    dlo.issued_time = now;
+    dlo.skip = 600;
+    dlo.op = unreserve_asset_on_account_operation{wa1_id, asset{ 0, db.get_dascoin_asset_id() } };
+  });
+
+  const auto& early = db.create<delayed_operation_object>([&](delayed_operation_object& dlo){
+    dlo.account = wa2_id;
+    dlo.issued_time = now;
+    dlo.skip = 60;
+    dlo.op = unreserve_asset_on_account_operation{wa2_id, asset{ 0, db.get_dascoin_asset_id() } };
+  });
+
+  BOOST_CHECK( late.due_time() == now + 600 );
+  BOOST_CHECK( early.due_time() == now + 60 );
+
+  // Earliest maturity comes first, regardless of the issuing account:
+  const auto& idx = db.get_index_type<delayed_operations_index>().indices().get<by_due_time>();
+  BOOST_CHECK( idx.begin()->id == early.id );
+
+  // Only the first operation is due at now + 60:
+  const auto end = idx.upper_bound(boost::make_tuple(now + 60));
+  BOOST_CHECK_EQUAL( std::distance(idx.begin(), end), 1 );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( delayed_operations_cap_test )
+{ try {
+  const uint32_t count = DASCOIN_MAX_DELAYED_OPERATIONS_PER_BLOCK + 10;
+
+  // An account holds a single delayed operation of each kind, so every operation gets an account of its own:
+  vector<account_id_type> accounts;
+  for ( uint32_t i = 0; i < count; ++i )
+    accounts.push_back(create_new_account(get_registrar_id(), "wallet" + fc::to_string(i)).id);
+  generate_block();
+
+  // Operations are issued in reverse account order, so due time order and (account, id) order differ:
+  auto issue_delayed_operations = [&]() {
+    for ( uint32_t i = 0; i < count; ++i )
+    {
+      const account_id_type account = accounts[count - 1 - i];
+      db.create<delayed_operation_object>([&](delayed_operation_object& dlo){
+        dlo.account = account;
+        dlo.issued_time = db.head_block_time();
+        dlo.skip = 0;
+        dlo.op = unreserve_asset_on_account_operation{account, asset{ 0, db.get_dascoin_asset_id() } };
+      });
+    }
+  };
+
+  vector<account_id_type> resolved;
+  boost::signals2::scoped_connection connection = db.applied_block.connect( [&]( const signed_block& ){
+    for ( const auto& o : db.get_applied_operations() )
+      if ( o.valid() && o->op.which() == operation::tag<unreserve_completed_operation>::value )
+        resolved.push_back(o->op.get<unreserve_completed_operation>().account);
+  });
+
+  const auto& idx = db.get_index_type<delayed_operations_index>().indices();
+
+  do_op(update_delayed_operations_resolver_parameters_operation(db.get_global_properties().authorities.root_administrator, true, 600));
+  issue_delayed_operations();
+
+  // Before the hardfork every due operation is resolved in one block, in (account, id) order:
+  generate_block();
+  BOOST_CHECK_EQUAL( resolved.size(), count );
+  BOOST_CHECK( std::is_sorted(resolved.begin(), resolved.end()) );
+  BOOST_CHECK_EQUAL( idx.size(), 0 );
+  BOOST_CHECK( db.get_dynamic_global_properties().next_delayed_operations_resolver_time == db.head_block_time() + 600 );
+
+  generate_blocks(HARDFORK_DELAYED_OPERATIONS_CAP_TIME);
+  issue_delayed_operations();
+  resolved.clear();
+
+  // After the hardfork only the first DASCOIN_MAX_DELAYED_OPERATIONS_PER_BLOCK are resolved, in due time order:
+  const auto resolver_time = db.get_dynamic_global_properties().next_delayed_operations_resolver_time;
+  generate_blocks(resolver_time);
+  BOOST_CHECK_EQUAL( resolved.size(), DASCOIN_MAX_DELAYED_OPERATIONS_PER_BLOCK );
+  BOOST_CHECK( std::equal(resolved.begin(), resolved.end(), accounts.rbegin()) );
+  BOOST_CHECK_EQUAL( idx.size(), count - DASCOIN_MAX_DELAYED_OPERATIONS_PER_BLOCK );
+
+  // The resolver time stays put while work is left, so the leftovers are resolved in the very next block:
+  BOOST_CHECK( db.get_dynamic_global_properties().next_delayed_operations_resolver_time == resolver_time );
+  resolved.clear();
+  generate_block();
+  BOOST_CHECK_EQUAL( resolved.size(), count - DASCOIN_MAX_DELAYED_OPERATIONS_PER_BLOCK );
+  BOOST_CHECK( std::equal(resolved.begin(), resolved.end(), accounts.rbegin() + DASCOIN_MAX_DELAYED_OPERATIONS_PER_BLOCK) );
+  BOOST_CHECK_EQUAL( idx.size(), 0 );
+  BOOST_CHECK( db.get_dynamic_global_properties().next_delayed_operations_resolver_time == db.head_block_time() + 600 );
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( register_daspay_authority_test )
 { try {
   ACTORS((foo)(bar)(foobar)(payment));
@@ -0,0 +1,74 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <graphene/app/database_api.hpp>
+#include <graphene/app/subscription_dispatcher.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+BOOST_FIXTURE_TEST_SUITE( dascoin_tests, database_fixture )
+BOOST_FIXTURE_TEST_SUITE( database_api_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( shared_subscription_dispatch_test )
+{ try {
+   ACTOR( alice );
+   generate_block();
+
+   // The sessions share one dispatcher, as those of an application do:
+   const auto dispatcher = std::make_shared<graphene::app::subscription_dispatcher>( db );
+   graphene::app::application_options app_options;
+   uint32_t updates1 = 0;
+   uint32_t updates2 = 0;
+   graphene::app::database_api db_api1( db, &app_options, dispatcher );
+   graphene::app::database_api db_api2( db, &app_options, dispatcher );
+   db_api1.set_subscribe_callback( [&]( const variant& ) { ++updates1; }, false );
+   db_api2.set_subscribe_callback( [&]( const variant& ) { ++updates2; }, false );
+
+   // Both sessions follow alice, so both receive every object changed by her transfer
+   db_api1.get_full_accounts( { "alice" }, true );
+   db_api2.get_full_accounts( { "alice" }, true );
+   const auto before = dispatcher->get_stats();
+
+   transfer( account_id_type(), alice_id, asset( 1 ) );
+   generate_block();
+   fc::usleep( fc::milliseconds( 200 ) ); // sleep a while to execute callback in another thread
+
+   const auto after = dispatcher->get_stats();
+   BOOST_CHECK( updates1 > 0 );
+   BOOST_CHECK_EQUAL( updates1, updates2 );
+   BOOST_CHECK_EQUAL( after.blocks - before.blocks, 1 );
+   BOOST_CHECK_EQUAL( after.serialization.count - before.serialization.count, 1 );
+   // The objects were serialized once for both sessions
+   BOOST_CHECK( after.objects_serialized > before.objects_serialized );
+   BOOST_CHECK( 2 * ( after.objects_serialized - before.objects_serialized )
+                <= after.updates_dispatched - before.updates_dispatched );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests::database_api_tests
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests
@@ -0,0 +1,233 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/account_object.hpp>
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/filesystem.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+BOOST_FIXTURE_TEST_SUITE( dascoin_tests, database_fixture )
+BOOST_FIXTURE_TEST_SUITE( database_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( undo_pool_test )
+{ try {
+   database db;
+   const auto bal_id = db.create<account_balance_object>( [&]( account_balance_object& obj ){
+      obj.owner = account_id_type(1);
+   }).id;
+   db._undo_db.enable();
+
+   for( int i = 0; i < 3; ++i )
+   {
+      auto ses = db._undo_db.start_undo_session();
+      db.modify( db.get<account_balance_object>( bal_id ), [&]( account_balance_object& obj ){
+         obj.owner = account_id_type(100 + i);
+      });
+      db.remove( db.get_object( bal_id ) );
+      ses.undo();
+      BOOST_CHECK_EQUAL( db.get<account_balance_object>( bal_id ).owner.instance.value, 1 );
+   }
+
+   // After the first session both the undo state and the saved copy come from the pools:
+   const auto& stats = db._undo_db.stats();
+   BOOST_CHECK_EQUAL( stats.states_started, 3 );
+   BOOST_CHECK_EQUAL( stats.states_recycled, 2 );
+   BOOST_CHECK_EQUAL( stats.objects_saved, 3 );
+   BOOST_CHECK_EQUAL( stats.objects_recycled, 2 );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( undo_stats_per_block_test )
+{ try {
+   generate_block();
+   generate_block();
+   const undo_stats first = db.get_last_block_undo_stats();
+
+   // Every block modifies at least the dynamic global properties:
+   BOOST_CHECK_GT( first.objects_saved, 0 );
+
+   // Counters start over with each block instead of adding up:
+   generate_blocks( 5 );
+   const undo_stats last = db.get_last_block_undo_stats();
+   BOOST_CHECK_EQUAL( last.states_started, first.states_started );
+   BOOST_CHECK_GT( last.objects_saved, 0 );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( snapshot_test )
+{ try {
+   ACTOR( alice );
+   ACTOR( bob );
+   transfer( account_id_type(), alice_id, asset( 1000 ) );
+   generate_block();
+
+   fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+   const fc::path snapshot_file = data_dir.path() / "state.snapshot";
+   db.export_snapshot( snapshot_file );
+
+   database restored;
+   restored.open_from_snapshot( data_dir.path() / "blockchain", snapshot_file, [this]{ return genesis_state; }, "test" );
+   BOOST_CHECK( restored.head_block_id() == db.head_block_id() );
+   BOOST_CHECK( restored.get_chain_id() == db.get_chain_id() );
+   BOOST_CHECK( restored.get_index_type<account_index>().indices().get<by_name>().find( "alice" )->id == alice_id );
+   BOOST_CHECK_EQUAL( restored.get_balance( alice_id, asset_id_type() ).amount.value, 1000 );
+   BOOST_CHECK( restored.get_index_type<account_index>().get_next_id() == db.get_index_type<account_index>().get_next_id() );
+
+   // the restored node follows the chain from the snapshot block on
+   transfer( alice_id, bob_id, asset( 100 ) );
+   generate_block();
+   restored.push_block( *db.fetch_block_by_number( db.head_block_num() ) );
+   BOOST_CHECK( restored.head_block_id() == db.head_block_id() );
+   BOOST_CHECK_EQUAL( restored.get_balance( bob_id, asset_id_type() ).amount.value, 100 );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( snapshot_of_other_chain_test )
+{ try {
+   generate_block();
+
+   fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+   const fc::path snapshot_file = data_dir.path() / "state.snapshot";
+   db.export_snapshot( snapshot_file );
+
+   // a node configured for another chain refuses the snapshot
+   genesis_state_type other_genesis = genesis_state;
+   other_genesis.initial_chain_id = fc::sha256::hash( "other chain" );
+   database restored;
+   GRAPHENE_REQUIRE_THROW( restored.open_from_snapshot( data_dir.path() / "blockchain", snapshot_file,
+                                                        [&]{ return other_genesis; }, "test" ), fc::exception );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( block_profiler_test )
+{ try {
+   ACTOR( alice );
+   auto& profiler = db.get_block_profiler();
+   profiler.reset();
+
+   transfer( account_id_type(), alice_id, asset( 1000 ) );
+   generate_block();
+
+   const auto profile = profiler.get_profile();
+   BOOST_CHECK( profile.enabled );
+   BOOST_CHECK_EQUAL( profile.blocks, 1 );
+   BOOST_CHECK_EQUAL( profile.stages.size(), block_stage_count );
+   BOOST_CHECK_EQUAL( profile.stages[block_stage_global_dynamic_data].name, "global_dynamic_data" );
+   BOOST_CHECK_EQUAL( profile.stages[block_stage_global_dynamic_data].latency.count, 1 );
+   BOOST_CHECK_EQUAL( profile.stages[block_stage_maintenance].latency.count, 0 );
+   BOOST_CHECK_EQUAL( profile.production_latency.count, 1 );
+
+   BOOST_REQUIRE_EQUAL( profile.operations.size(), 1 );
+   BOOST_CHECK_EQUAL( profile.operations[0].name, "transfer_operation" );
+   BOOST_CHECK_EQUAL( profile.operations[0].failed, 0 );
+
+   const auto text = profiler.to_prometheus();
+   BOOST_CHECK( text.find( "graphene_blocks_applied_total 1\n" ) != std::string::npos );
+   BOOST_CHECK( text.find( "graphene_block_stage_seconds_count{stage=\"global_dynamic_data\"} 1\n" ) != std::string::npos );
+   BOOST_CHECK( text.find( "graphene_block_production_seconds_count 1\n" ) != std::string::npos );
+   BOOST_CHECK( text.find( "graphene_operation_seconds_count{operation=\"transfer_operation\"}" ) != std::string::npos );
+
+   profiler.enable( false );
+   generate_block();
+   BOOST_CHECK_EQUAL( profiler.get_profile().blocks, 1 );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( generate_block_from_pending_state_test )
+{ try {
+   ACTOR( alice );
+   generate_block();
+   auto& profiler = db.get_block_profiler();
+   profiler.reset();
+
+   transfer( account_id_type(), alice_id, asset( 1000 ) );
+   transfer( account_id_type(), alice_id, asset( 500 ) );
+   BOOST_CHECK_EQUAL( get_balance( alice_id, asset_id_type() ), 1500 );
+
+   const signed_block block = generate_block();
+   BOOST_CHECK_EQUAL( block.transactions.size(), 2 );
+   BOOST_CHECK_EQUAL( get_balance( alice_id, asset_id_type() ), 1500 );
+   BOOST_CHECK( db.is_known_transaction( block.transactions[0].id() ) );
+
+   // The transfers were applied when pushed, but neither when the block was generated nor when it was applied:
+   const auto profile = profiler.get_profile();
+   BOOST_CHECK_EQUAL( profile.production_latency.count, 1 );
+   BOOST_CHECK_EQUAL( profile.stages[block_stage_transactions].latency.count, 0 );
+   BOOST_REQUIRE_EQUAL( profile.operations.size(), 1 );
+   BOOST_CHECK_EQUAL( profile.operations[0].latency.count, 2 );
+
+   // Popping the block undoes the transfers
+   db.pop_block();
+   BOOST_CHECK_EQUAL( get_balance( alice_id, asset_id_type() ), 0 );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( impacted_accounts_on_demand_test )
+{ try {
+   ACTOR( alice );
+   generate_block();
+
+   flat_set<account_id_type> impacted;
+   uint32_t notifications = 0;
+   boost::signals2::scoped_connection connection = db.changed_objects.connect(
+      [&]( const vector<object_id_type>&, const flat_set<account_id_type>& accounts ) {
+         impacted = accounts;
+         ++notifications;
+      });
+
+   // Nobody needs the impacted accounts
+   transfer( account_id_type(), alice_id, asset( 1000 ) );
+   generate_block();
+   BOOST_CHECK_EQUAL( notifications, 1 );
+   BOOST_CHECK( impacted.empty() );
+
+   db.require_impacted_accounts();
+   transfer( account_id_type(), alice_id, asset( 1000 ) );
+   generate_block();
+   BOOST_CHECK( impacted.count( alice_id ) );
+
+   // They are computed until the last subscriber releases them
+   db.require_impacted_accounts();
+   db.release_impacted_accounts();
+   transfer( account_id_type(), alice_id, asset( 1000 ) );
+   generate_block();
+   BOOST_CHECK( impacted.count( alice_id ) );
+
+   db.release_impacted_accounts();
+   transfer( account_id_type(), alice_id, asset( 1000 ) );
+   generate_block();
+   BOOST_CHECK( impacted.empty() );
+   GRAPHENE_REQUIRE_THROW( db.release_impacted_accounts(), fc::exception );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests::database_tests
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests
@@ -0,0 +1,273 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <graphene/utilities/elasticsearch.hpp>
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/filesystem.hpp>
+
+#include <boost/asio.hpp>
+
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+namespace {
+
+/**
+ * Minimal stand-in for an elasticsearch node: answers bulk requests on a loopback port with the given status codes,
+ * then accepts every further request, keeping connections alive between requests.
+ */
+class stub_es_server
+{
+   public:
+      explicit stub_es_server( std::vector<int> statuses )
+         : _statuses( std::move( statuses ) ),
+           _acceptor( _io, boost::asio::ip::tcp::endpoint( boost::asio::ip::address_v4::loopback(), 0 ) )
+      {
+         _thread = std::thread( [this]() { run(); } );
+      }
+
+      ~stub_es_server()
+      {
+         _stopping = true;
+         // unblock accept()
+         boost::asio::ip::tcp::socket wake( _io );
+         boost::system::error_code ec;
+         wake.connect( _acceptor.local_endpoint(), ec );
+         _thread.join();
+      }
+
+      std::string url()const { return "http://127.0.0.1:" + std::to_string( _acceptor.local_endpoint().port() ) + "/"; }
+
+      /// bodies of the accepted requests, in the order they arrived
+      std::vector<std::string> accepted_bodies()const
+      {
+         std::lock_guard<std::mutex> lock( _mutex );
+         return _accepted;
+      }
+
+      std::atomic<uint32_t> requests{0};
+      std::atomic<uint32_t> connections{0};
+
+   private:
+      void run()
+      {
+         while( !_stopping )
+         {
+            boost::asio::ip::tcp::socket socket( _io );
+            boost::system::error_code ec;
+            _acceptor.accept( socket, ec );
+            if( ec || _stopping )
+               continue;
+            ++connections;
+            serve( socket );
+         }
+      }
+
+      void serve( boost::asio::ip::tcp::socket& socket )
+      {
+         boost::asio::streambuf buffer;
+         boost::system::error_code ec;
+         while( true )
+         {
+            const size_t header_size = boost::asio::read_until( socket, buffer, "\r\n\r\n", ec );
+            if( ec )
+               return;
+            std::string headers( boost::asio::buffers_begin( buffer.data() ),
+                                 boost::asio::buffers_begin( buffer.data() ) + header_size );
+            buffer.consume( header_size );
+
+            size_t content_length = 0;
+            const auto pos = headers.find( "Content-Length: " );
+            if( pos != std::string::npos )
+               content_length = std::stoul( headers.substr( pos + 16 ) );
+            if( buffer.size() < content_length )
+               boost::asio::read( socket, buffer, boost::asio::transfer_exactly( content_length - buffer.size() ), ec );
+            if( ec )
+               return;
+            std::string body( boost::asio::buffers_begin( buffer.data() ),
+                              boost::asio::buffers_begin( buffer.data() ) + content_length );
+            buffer.consume( content_length );
+
+            std::string response;
+            const uint32_t n = requests++;
+            if( n < _statuses.size() )
+               response = "HTTP/1.1 " + std::to_string( _statuses[n] ) + " Stub\r\nContent-Length: 0\r\n\r\n";
+            else
+            {
+               {
+                  std::lock_guard<std::mutex> lock( _mutex );
+                  _accepted.push_back( std::move( body ) );
+               }
+               const std::string reply = "{\"took\":1,\"errors\":false,\"items\":[]}";
+               response = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: "
+                          + std::to_string( reply.size() ) + "\r\n\r\n" + reply;
+            }
+            boost::asio::write( socket, boost::asio::buffer( response ), ec );
+            if( ec )
+               return;
+         }
+      }
+
+      const std::vector<int>         _statuses;
+      std::atomic<bool>              _stopping{false};
+      boost::asio::io_service        _io;
+      boost::asio::ip::tcp::acceptor _acceptor;
+      std::thread                    _thread;
+      mutable std::mutex             _mutex;
+      std::vector<std::string>       _accepted;
+};
+
+/// a bulk of n documents with ids prefix0 .. prefix(n-1)
+graphene::utilities::es_bulk_sender::bulk_builder make_bulk( const std::string& prefix, uint32_t n )
+{
+   return [prefix, n]() {
+      std::vector<std::string> lines;
+      for( uint32_t i = 0; i < n; ++i )
+      {
+         lines.push_back( "{\"index\":{\"_index\":\"test\",\"_type\":\"data\",\"_id\":\"" + prefix + std::to_string(i) + "\"}}" );
+         lines.push_back( "{\"value\":" + std::to_string(i) + "}" );
+      }
+      return lines;
+   };
+}
+
+uint32_t count_lines( const std::vector<std::string>& bodies )
+{
+   uint32_t lines = 0;
+   for( const auto& body : bodies )
+      lines += std::count( body.begin(), body.end(), '\n' );
+   return lines;
+}
+
+}
+
+BOOST_FIXTURE_TEST_SUITE( dascoin_tests, database_fixture )
+BOOST_FIXTURE_TEST_SUITE( es_bulk_sender_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( es_bulk_sender_retry_and_spill_test )
+{ try {
+   fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+   stub_es_server server( { 503 } );
+
+   graphene::utilities::es_bulk_sender_options options;
+   options.elasticsearch_url = server.url();
+   options.max_queued_bulks = 2;
+   options.spill_file = data_dir.path() / "spill.json";
+
+   {
+      graphene::utilities::es_bulk_sender sender( options );
+      // the first bulk is retried while the rest fill the queue and spill over to disk; send() does not block
+      for( uint32_t i = 0; i < 5; ++i )
+         sender.send( make_bulk( "b" + std::to_string(i) + "-", 10 ) );
+
+      BOOST_REQUIRE( sender.wait_until_idle( fc::seconds(30) ) );
+      const auto stats = sender.get_stats();
+      BOOST_CHECK_EQUAL( stats.send_failures, 1u );
+      BOOST_CHECK_GE( stats.bulks_spilled, 1u );
+      BOOST_CHECK_EQUAL( stats.bulks_dropped, 0u );
+      BOOST_CHECK( !fc::exists( options.spill_file.generic_string() + ".sending" ) );
+   }
+   const auto bodies = server.accepted_bodies();
+   BOOST_CHECK_EQUAL( count_lines( bodies ), 100u );
+
+   // the bulks arrive in the order they were sent, spilled ones included
+   std::string all;
+   for( const auto& body : bodies )
+      all += body;
+   for( uint32_t i = 1; i < 5; ++i )
+      BOOST_CHECK_LT( all.find( "\"b" + std::to_string(i - 1) + "-0\"" ), all.find( "\"b" + std::to_string(i) + "-0\"" ) );
+
+   // every request went over the one kept-alive connection
+   BOOST_CHECK_EQUAL( server.connections.load(), 1u );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( es_bulk_sender_drops_refused_bulks_test )
+{ try {
+   fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+   // a malformed request is refused for good, an overloaded node only for now
+   stub_es_server server( { 400, 429 } );
+
+   graphene::utilities::es_bulk_sender_options options;
+   options.elasticsearch_url = server.url();
+   options.spill_file = data_dir.path() / "spill.json";
+
+   graphene::utilities::es_bulk_sender sender( options );
+   sender.send( make_bulk( "refused-", 1 ) );
+   sender.send( make_bulk( "throttled-", 1 ) );
+   BOOST_REQUIRE( sender.wait_until_idle( fc::seconds(30) ) );
+
+   const auto stats = sender.get_stats();
+   BOOST_CHECK_EQUAL( stats.bulks_dropped, 1u );
+   BOOST_CHECK_EQUAL( stats.send_failures, 1u );
+   BOOST_CHECK_EQUAL( stats.bulks_sent, 1u );
+   BOOST_CHECK_EQUAL( server.requests.load(), 3u );
+
+   const auto bodies = server.accepted_bodies();
+   BOOST_REQUIRE_EQUAL( bodies.size(), 1u );
+   BOOST_CHECK( bodies[0].find( "throttled-0" ) != std::string::npos );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( es_bulk_sender_drains_spill_file_first_test )
+{ try {
+   fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+   stub_es_server server( {} );
+
+   graphene::utilities::es_bulk_sender_options options;
+   options.elasticsearch_url = server.url();
+   options.spill_file = data_dir.path() / "spill.json";
+
+   // bulks left over from an earlier run
+   {
+      std::ofstream out( options.spill_file.generic_string().c_str(), std::ios::out | std::ios::binary );
+      out << graphene::utilities::joinBulkLines( make_bulk( "old-", 3 )() );
+   }
+
+   graphene::utilities::es_bulk_sender sender( options );
+   sender.send( make_bulk( "new-", 3 ) );
+   BOOST_REQUIRE( sender.wait_until_idle( fc::seconds(30) ) );
+
+   const auto bodies = server.accepted_bodies();
+   BOOST_REQUIRE_GE( bodies.size(), 1u );
+   std::string all;
+   for( const auto& body : bodies )
+      all += body;
+   BOOST_CHECK_EQUAL( count_lines( bodies ), 12u );
+   BOOST_CHECK_LT( all.find( "old-2" ), all.find( "new-0" ) );
+   BOOST_CHECK( !fc::exists( options.spill_file ) || fc::file_size( options.spill_file ) == 0 );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests::es_bulk_sender_tests
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests
@@ -24,6 +24,7 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <graphene/app/database_api.hpp>
 #include <graphene/chain/database.hpp>
 #include <graphene/chain/exceptions.hpp>
 #include <graphene/chain/market_object.hpp>
@@ -200,6 +201,52 @@ BOOST_AUTO_TEST_CASE( cancel_order_test )
 
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( limit_order_price_levels_test )
+{ try {
+    ACTOR(alice);
+
+    issue_webasset("1", alice_id, 300, 0);
+    generate_blocks(db.head_block_time() + fc::hours(24) + fc::seconds(1));
+
+    graphene::app::application_options app_options;
+    graphene::app::database_api db_api(db, &app_options);
+
+    // Two orders at 1 DASC for 1.00 WebEUR, one at 2 DASC for 1.00 WebEUR:
+    set_expiration( db, trx );
+    auto order = create_sell_order(alice_id, asset{100, get_web_asset_id()}, asset{1 * DASCOIN_DEFAULT_ASSET_PRECISION, get_dascoin_asset_id()});
+    set_expiration( db, trx );
+    create_sell_order(alice_id, asset{100, get_web_asset_id()}, asset{1 * DASCOIN_DEFAULT_ASSET_PRECISION, get_dascoin_asset_id()});
+    set_expiration( db, trx );
+    create_sell_order(alice_id, asset{100, get_web_asset_id()}, asset{2 * DASCOIN_DEFAULT_ASSET_PRECISION, get_dascoin_asset_id()});
+
+    auto book = db_api.get_limit_orders_grouped_by_price(get_dascoin_asset_id(), get_web_asset_id(), 10);
+    BOOST_CHECK( book.sell.empty() );
+    BOOST_REQUIRE_EQUAL( book.buy.size(), 2 );
+    BOOST_CHECK_EQUAL( book.buy[0].price.value, 1000000 );
+    BOOST_CHECK_EQUAL( book.buy[0].count.value, 2 );
+    BOOST_CHECK_EQUAL( book.buy[0].base_volume.value, 200 );
+    BOOST_CHECK_EQUAL( book.buy[0].quote_volume.value, 2 * DASCOIN_DEFAULT_ASSET_PRECISION );
+    BOOST_CHECK_EQUAL( book.buy[1].price.value, 500000 );
+    BOOST_CHECK_EQUAL( book.buy[1].count.value, 1 );
+
+    // Only the requested levels are returned:
+    book = db_api.get_limit_orders_grouped_by_price(get_dascoin_asset_id(), get_web_asset_id(), 1);
+    BOOST_CHECK_EQUAL( book.buy.size(), 1 );
+
+    // Levels follow cancellations:
+    cancel_limit_order(*order);
+    book = db_api.get_limit_orders_grouped_by_price(get_dascoin_asset_id(), get_web_asset_id(), 10);
+    BOOST_REQUIRE_EQUAL( book.buy.size(), 2 );
+    BOOST_CHECK_EQUAL( book.buy[0].count.value, 1 );
+    BOOST_CHECK_EQUAL( book.buy[0].base_volume.value, 100 );
+
+    // A query at a different precision still walks the orders:
+    book = db_api.get_limit_orders_grouped_by_price_with_precision(get_dascoin_asset_id(), get_web_asset_id(), 10, 4);
+    BOOST_REQUIRE_EQUAL( book.buy.size(), 2 );
+    BOOST_CHECK_EQUAL( book.buy[0].price.value, 10000 );
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( exchange_test )
 { try {
     ACTOR(alicew);
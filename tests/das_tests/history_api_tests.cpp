@@ -0,0 +1,163 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <graphene/app/api.hpp>
+#include <graphene/account_history/account_history_store.hpp>
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/filesystem.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+BOOST_FIXTURE_TEST_SUITE( dascoin_tests, database_fixture )
+BOOST_FIXTURE_TEST_SUITE( history_api_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( account_history_store_test )
+{ try {
+   ACTORS( (alice) );
+   // more entries than there are between two checkpoints of the store
+   for( int i = 0; i < 70; ++i )
+      transfer( account_id_type(), alice_id, asset( 1 ) );
+   generate_block();
+
+   const auto& ops = db.get_index_type<operation_history_index>().indices().get<by_id>();
+   const auto& entries_by_op = db.get_index_type<account_transaction_history_index>().indices().get<by_opid>();
+   const auto& entries_by_seq = db.get_index_type<account_transaction_history_index>().indices().get<by_seq>();
+   const uint32_t total_ops = alice_id(db).statistics(db).total_ops;
+
+   fc::temp_directory dir( graphene::utilities::temp_directory_path() );
+   graphene::account_history::account_history_store store;
+   store.open( dir.path() );
+   for( const auto& op : ops )
+   {
+      BOOST_CHECK( store.append_operation( op ) );
+      const operation_history_id_type op_id = op.id;
+      auto range = entries_by_op.equal_range( op_id );
+      for( auto itr = range.first; itr != range.second; ++itr )
+         BOOST_CHECK( store.append_account_entry( itr->account, op ) );
+   }
+   // appending again is a no-op
+   BOOST_CHECK( !store.append_operation( *ops.rbegin() ) );
+   store.flush();
+
+   BOOST_CHECK_EQUAL( store.account_entry_count( alice_id ), total_ops );
+   for( uint32_t sequence = 1; sequence <= total_ops; ++sequence )
+   {
+      const auto expected = entries_by_seq.find( boost::make_tuple( alice_id, sequence ) );
+      const auto stored = store.find_account_entry( alice_id, sequence );
+      BOOST_REQUIRE( stored.valid() );
+      BOOST_CHECK( *stored == expected->operation_id );
+   }
+   const auto op = store.get_operation( ops.rbegin()->id );
+   BOOST_REQUIRE( op.valid() );
+   BOOST_CHECK_EQUAL( op->block_num, ops.rbegin()->block_num );
+
+   // the directory is saved on close and loaded on open
+   store.close();
+   store.open( dir.path() );
+   BOOST_CHECK_EQUAL( store.account_entry_count( alice_id ), total_ops );
+   BOOST_CHECK( store.next_operation() == operation_history_id_type( ops.rbegin()->id.instance() + 1 ) );
+
+   // operations both in memory and in the store are visited once
+   uint32_t visited = 0;
+   graphene::account_history::visit_account_history( db, &store, alice_id, [&]( const operation_history_object& ) {
+      ++visited;
+      return true;
+   });
+   BOOST_CHECK_EQUAL( visited, total_ops );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( account_history_by_operation_type_test )
+{ try {
+   graphene::app::history_api hist_api(app);
+   ACTORS( (alice)(bob) );
+   for( int i = 0; i < 5; ++i )
+   {
+      transfer( account_id_type(), alice_id, asset( 1 ) );
+      transfer( account_id_type(), bob_id, asset( 1 ) );
+   }
+   generate_block();
+
+   const int transfer_op_id = operation::tag<transfer_operation>::value;
+   const int account_create_op_id = operation::tag<account_create_operation>::value;
+
+   auto histories = hist_api.get_account_history_by_operation( alice_id, { uint32_t(transfer_op_id) } );
+   BOOST_REQUIRE_EQUAL( histories.size(), 5 );
+   for( size_t i = 0; i < histories.size(); ++i )
+   {
+      BOOST_CHECK_EQUAL( histories[i].op.which(), transfer_op_id );
+      if( i > 0 )
+         BOOST_CHECK( histories[i].id < histories[i - 1].id );
+   }
+
+   // several types are merged from the most recent to the oldest
+   histories = hist_api.get_account_history_by_operation( alice_id,
+                                                          { uint32_t(transfer_op_id), uint32_t(account_create_op_id) } );
+   BOOST_REQUIRE_EQUAL( histories.size(), 6 );
+   BOOST_CHECK_EQUAL( histories.back().op.which(), account_create_op_id );
+
+   histories = hist_api.get_account_history_by_operation( alice_id, { uint32_t(transfer_op_id) },
+                                                          operation_history_id_type(), 2 );
+   BOOST_CHECK_EQUAL( histories.size(), 2 );
+
+   // operations archived to the store are found by type as well, once
+   const auto& ops = db.get_index_type<operation_history_index>().indices().get<by_id>();
+   const auto& entries_by_op = db.get_index_type<account_transaction_history_index>().indices().get<by_opid>();
+   fc::temp_directory dir( graphene::utilities::temp_directory_path() );
+   graphene::account_history::account_history_store store;
+   store.open( dir.path() );
+   for( const auto& op : ops )
+   {
+      store.append_operation( op );
+      auto range = entries_by_op.equal_range( operation_history_id_type( op.id ) );
+      for( auto itr = range.first; itr != range.second; ++itr )
+         store.append_account_entry( itr->account, op );
+   }
+   store.flush();
+
+   uint32_t stored = 0;
+   store.visit_account_entries_of_type( alice_id, transfer_op_id, [&]( operation_history_id_type ) {
+      ++stored;
+      return true;
+   });
+   BOOST_CHECK_EQUAL( stored, 5 );
+
+   uint32_t visited = 0;
+   graphene::account_history::visit_account_history_of_type( db, &store, alice_id, transfer_op_id,
+                                                             [&]( const operation_history_object& op ) {
+      BOOST_CHECK_EQUAL( op.op.which(), transfer_op_id );
+      ++visited;
+      return true;
+   });
+   BOOST_CHECK_EQUAL( visited, 5 );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests::history_api_tests
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests
@@ -32,6 +32,7 @@
 #include <graphene/chain/frequency_history_record_object.hpp>
 #include <graphene/chain/license_objects.hpp>
 #include <graphene/chain/upgrade_event_object.hpp>
+#include <graphene/app/database_api.hpp>
 
 #include "../common/database_fixture.hpp"
 
@@ -50,6 +51,114 @@ BOOST_AUTO_TEST_CASE( regression_test_license_information_index )
 
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( continue_upgrade_cursor_test )
+{ try {
+  VAULT_ACTORS((first)(second)(third));
+
+  auto standard_charter = *(_dal.get_license_type("standard_charter"));
+  auto manager_charter = *(_dal.get_license_type("manager_charter"));
+  const time_point_sec hbt = db.head_block_time();
+
+  do_op(issue_license_operation(get_license_issuer_id(), first_id, standard_charter.id, 0, 200, hbt));
+  do_op(issue_license_operation(get_license_issuer_id(), second_id, standard_charter.id, 0, 200, hbt - fc::days(2)));
+  do_op(issue_license_operation(get_license_issuer_id(), third_id, standard_charter.id, 0, 200, hbt - fc::days(1)));
+
+  // An execution which has already upgraded the first license holder:
+  const auto second_license_id = *second_id(db).license_information;
+  const upgrade_event_id_type upgrade_id{ db.create<upgrade_event_object>([&](upgrade_event_object& ueo){
+    ueo.execution_time = hbt;
+    ueo.execution_started = hbt;
+    ueo.next_license_to_upgrade = second_license_id;
+  }).id };
+
+  // A license activated earlier than all others must not make the walk skip anyone:
+  do_op(issue_license_operation(get_license_issuer_id(), third_id, manager_charter.id, 0, 200, hbt - fc::days(3)));
+
+  generate_block();
+  BOOST_CHECK( !upgrade_id(db).in_progress() );
+
+  const auto upgraded_by_event = [&](account_id_type account_id) {
+    const auto& lio = (*account_id(db).license_information)(db);
+    for ( const auto& record : lio.history )
+      if ( std::find_if(record.upgrades.begin(), record.upgrades.end(),
+                        [&](const pair<upgrade_event_id_type, time_point_sec>& u){ return u.first == upgrade_id; })
+           == record.upgrades.end() )
+        return false;
+    return true;
+  };
+  BOOST_CHECK( !upgraded_by_event(first_id) );
+  BOOST_CHECK( upgraded_by_event(second_id) );
+  BOOST_CHECK( upgraded_by_event(third_id) );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( spread_upgrade_matches_one_shot_test )
+{ try {
+  const uint32_t holders = DASCOIN_MAX_UPGRADES_PER_BLOCK + 10;
+  const vector<license_type_id_type> types{ _dal.get_license_type("standard_locked")->id,
+                                            _dal.get_license_type("manager_locked")->id,
+                                            _dal.get_license_type("pro_locked")->id };
+  const auto& dgpo = db.get_dynamic_global_properties();
+  const auto& upgrade_idx = db.get_index_type<upgrade_event_index>().indices().get<by_id>();
+
+  // Issues licenses to a fresh set of holders and runs an upgrade event on them through maintenance. Returns the
+  // cycle balance of every holder and how many of its licenses the event upgraded at the execution time:
+  const auto run_upgrade_event = [&](const string& prefix, uint32_t& blocks) -> vector<pair<share_type, size_t>> {
+    const time_point_sec hbt = db.head_block_time();
+    vector<account_id_type> accounts;
+    for ( uint32_t i = 0; i < holders; ++i )
+    {
+      const account_id_type account_id = create_new_vault_account(get_registrar_id(), prefix + fc::to_string(i)).id;
+      accounts.push_back(account_id);
+      // Every seventh license is activated after the cutoff time and must not be upgraded:
+      const time_point_sec activated = i % 7 == 0 ? hbt + fc::days(3) : hbt - fc::hours(i % 24);
+      do_op(issue_license_operation(get_license_issuer_id(), account_id, types[i % types.size()], 0, 100, activated));
+    }
+    generate_block();
+
+    do_op(create_upgrade_event_operation(get_license_administrator_id(), dgpo.next_maintenance_time,
+                                         hbt + fc::days(1), {}, prefix + "_upgrade"));
+    const upgrade_event_id_type upgrade_id{ upgrade_idx.rbegin()->id };
+
+    generate_blocks(dgpo.next_maintenance_time);
+    blocks = 1;
+    while ( upgrade_id(db).in_progress() )
+    {
+      generate_block();
+      ++blocks;
+    }
+    BOOST_CHECK( upgrade_id(db).executed() );
+
+    vector<pair<share_type, size_t>> result;
+    for ( const auto& account_id : accounts )
+    {
+      size_t upgrades = 0;
+      for ( const auto& record : (*account_id(db).license_information)(db).history )
+        upgrades += std::count_if(record.upgrades.begin(), record.upgrades.end(),
+                                  [&](const pair<upgrade_event_id_type, time_point_sec>& u){
+                                    return u.first == upgrade_id && u.second == upgrade_id(db).execution_time;
+                                  });
+      result.emplace_back(get_cycle_balance(account_id), upgrades);
+    }
+    return result;
+  };
+
+  // Before the hardfork the maintenance block upgrades every license holder at once:
+  uint32_t one_shot_blocks = 0;
+  const auto one_shot = run_upgrade_event("oneshot", one_shot_blocks);
+  BOOST_CHECK_EQUAL( one_shot_blocks, 1 );
+  BOOST_CHECK_EQUAL( one_shot[0].second, 0 );
+  BOOST_CHECK_EQUAL( one_shot[1].second, 1 );
+
+  // After it the same holders take several blocks, and end up exactly where the one-shot execution left them:
+  generate_blocks(HARDFORK_SPREAD_UPGRADES_TIME);
+  uint32_t spread_blocks = 0;
+  const auto spread = run_upgrade_event("spread", spread_blocks);
+  BOOST_CHECK_GT( spread_blocks, 1 );
+  BOOST_CHECK( spread == one_shot );
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( charter_license_type_value_test )
 { try {
 
@@ -1293,6 +1402,74 @@ BOOST_AUTO_TEST_CASE( upgrade_executed_with_package_licences_test )
 
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( queue_projection_index_consistency_test )
+{ try {
+  ACTOR(wallet);
+  VAULT_ACTORS((locked)(charter)(utility)(package));
+
+  graphene::app::application_options app_options;
+  graphene::app::database_api db_api(db, &app_options);
+
+  // Compares the maintained totals against a full recomputation over all vaults:
+  const auto& check_consistency = [&]() {
+    total_cycles_res expected_cycles;
+    queue_projection_res expected_queue;
+    for ( const auto& acc : db.get_index_type<account_index>().indices().get<by_id>() )
+    {
+      if ( !acc.is_vault() )
+        continue;
+      auto cycles = _dal.get_total_cycles(acc.id);
+      if ( cycles.valid() )
+        expected_cycles = expected_cycles + *cycles;
+      auto queue = _dal.get_queue_state_for_account(acc.id);
+      if ( queue.valid() )
+        expected_queue = expected_queue + *queue;
+    }
+    BOOST_CHECK_EQUAL( fc::json::to_string(*db_api.get_total_cycles()), fc::json::to_string(expected_cycles) );
+    BOOST_CHECK_EQUAL( fc::json::to_string(*db_api.get_queue_projection()), fc::json::to_string(expected_queue) );
+  };
+
+  const share_type bonus_percent = 0;
+  const share_type frequency_lock = 100;
+  const time_point_sec activated_time = db.head_block_time();
+  const auto& dgpo = db.get_dynamic_global_properties();
+  const auto& gpo = db.get_global_properties();
+
+  check_consistency();
+
+  do_op(issue_license_operation(get_license_issuer_id(), locked_id, _dal.get_license_type("standard_locked")->id,
+                                bonus_percent, frequency_lock, activated_time));
+  do_op(issue_license_operation(get_license_issuer_id(), charter_id, _dal.get_license_type("standard_charter")->id,
+                                bonus_percent, frequency_lock, activated_time));
+  do_op(issue_license_operation(get_license_issuer_id(), utility_id, _dal.get_license_type("standard_utility")->id,
+                                bonus_percent, frequency_lock, activated_time));
+  do_op(issue_license_operation(get_license_issuer_id(), package_id, _dal.get_license_type("starter_package")->id,
+                                bonus_percent, frequency_lock, activated_time));
+  check_consistency();
+  BOOST_CHECK( db_api.get_total_cycles()->total_cycles > 0 );
+
+  // Tethering moves the locked vault from the untethered to the tethered bucket:
+  tether_accounts(wallet_id, locked_id);
+  generate_block();
+  check_consistency();
+  BOOST_CHECK( db_api.get_queue_projection()->total_locked_manual_submit.tethered.cycles > 0 );
+
+  // Upgrades change the license information of every vault:
+  do_op(create_upgrade_event_operation(get_license_administrator_id(), dgpo.next_maintenance_time,
+                                       activated_time + fc::hours(72), {}, "upgrade"));
+  generate_blocks(dgpo.next_maintenance_time + gpo.parameters.maintenance_interval);
+  check_consistency();
+
+  // Undo must bring the totals back as well:
+  do_op(issue_cycles_to_license_operation(get_cycle_issuer_id(), locked_id, _dal.get_license_type("standard_locked")->id,
+                                          200, "foo", "bar"));
+  const auto cycles_before_pop = db_api.get_total_cycles()->total_cycles;
+  db.pop_block();
+  check_consistency();
+  BOOST_CHECK( db_api.get_total_cycles()->total_cycles < cycles_before_pop );
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
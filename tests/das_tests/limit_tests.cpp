@@ -304,6 +304,38 @@ BOOST_AUTO_TEST_CASE( limit_reset_test )
 
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE( limit_reset_vaults_only_test )
+{ try {
+  const auto DASCOIN_ASSET_ID = get_dascoin_asset_id();
+  ACTOR(wallet);
+  VAULT_ACTOR(vault);
+
+  // Only the vault is tracked by the vault index:
+  const auto& aidx = dynamic_cast<const primary_index<account_index>&>(db.get_index_type<account_index>());
+  const auto& vaults = aidx.get_secondary_index<account_vault_index>().vaults;
+  BOOST_CHECK( vaults.find(vault_id) != vaults.end() );
+  BOOST_CHECK( vaults.find(wallet_id) == vaults.end() );
+
+  tether_accounts(wallet_id, vault_id);
+  issue_dascoin(vault_id, 100);
+  const auto& dgp = db.get_dynamic_global_properties();
+  const share_type expected_limit = *db.get_dascoin_limit(vault, dgp.last_dascoin_price);
+
+  // Spend some of the limit and put a limit on the wallet which the reset must not touch:
+  transfer_dascoin_vault_to_wallet(vault_id, wallet_id, 1 * DASCOIN_DEFAULT_ASSET_PRECISION);
+  db.adjust_balance_limit(wallet, DASCOIN_ASSET_ID, 5);
+  BOOST_CHECK_EQUAL( db.get_balance_object(vault_id, DASCOIN_ASSET_ID).spent.value, 1 * DASCOIN_DEFAULT_ASSET_PRECISION );
+
+  // Wait for the limit interval to pass:
+  generate_blocks(dgp.next_spend_limit_reset + fc::seconds(10));
+
+  const auto& vault_balance = db.get_balance_object(vault_id, DASCOIN_ASSET_ID);
+  BOOST_CHECK_EQUAL( vault_balance.spent.value, 0 );
+  BOOST_CHECK_EQUAL( vault_balance.limit.value, expected_limit.value );
+  BOOST_CHECK_EQUAL( db.get_balance_object(wallet_id, DASCOIN_ASSET_ID).limit.value, 5 );
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( daily_dascoin_price_test )
 { try {
   const auto DSC_ID = get_dascoin_asset_id();
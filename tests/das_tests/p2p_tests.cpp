@@ -0,0 +1,123 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Tech Solutions Malta LTD
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <graphene/app/application.hpp>
+#include <graphene/chain/balance_object.hpp>
+#include <graphene/chain/witness_object.hpp>
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/filesystem.hpp>
+#include <fc/io/json.hpp>
+#include <fc/thread/thread.hpp>
+
+#include "../common/database_fixture.hpp"
+#include "../common/genesis_file_util.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+namespace {
+
+/// Signs a block in the name of the witness scheduled for the next slot, witnesses of the example genesis use the key
+/// generated from their account name.
+signed_block produce_block( database& db )
+{
+   const witness_id_type witness = db.get_scheduled_witness( 1 );
+   const string& witness_name = witness( db ).witness_account( db ).name;
+   return db.generate_block( db.get_slot_time( 1 ), witness,
+                             fc::ecc::private_key::regenerate( fc::sha256::hash( witness_name ) ),
+                             database::skip_nothing );
+}
+
+} // anonymous namespace
+
+BOOST_FIXTURE_TEST_SUITE( dascoin_tests, database_fixture )
+BOOST_FIXTURE_TEST_SUITE( p2p_tests, database_fixture )
+
+BOOST_AUTO_TEST_CASE( compact_block_relay_test )
+{ try {
+   fc::temp_directory app1_dir( graphene::utilities::temp_directory_path() );
+   graphene::app::application app1;
+   app1.startup_plugins();
+   boost::program_options::variables_map cfg;
+   cfg.emplace("p2p-endpoint", boost::program_options::variable_value(string("127.0.0.1:3939"), false));
+   cfg.emplace("genesis-json", boost::program_options::variable_value(create_genesis_file(app1_dir), false));
+   cfg.emplace("seed-nodes", boost::program_options::variable_value(string("[]"), false));
+   app1.initialize(app1_dir.path(), cfg);
+   app1.startup();
+   fc::usleep(fc::milliseconds(500));
+
+   fc::temp_directory app2_dir( graphene::utilities::temp_directory_path() );
+   graphene::app::application app2;
+   app2.startup_plugins();
+   auto cfg2 = cfg;
+   cfg2.erase("p2p-endpoint");
+   cfg2.emplace("p2p-endpoint", boost::program_options::variable_value(string("127.0.0.1:4040"), false));
+   cfg2.emplace("seed-node", boost::program_options::variable_value(vector<string>{"127.0.0.1:3939"}, false));
+   app2.initialize(app2_dir.path(), cfg2);
+   app2.startup();
+   fc::usleep(fc::milliseconds(500));
+   BOOST_REQUIRE_EQUAL( app1.p2p_node()->get_connection_count(), 1 );
+
+   std::shared_ptr<database> db1 = app1.chain_database();
+   std::shared_ptr<database> db2 = app2.chain_database();
+
+   // The master account claims its genesis balance on app1, the transaction is relayed to app2:
+   const fc::ecc::private_key master_key = fc::ecc::private_key::regenerate( fc::sha256::hash( string("sys.master") ) );
+   signed_transaction trx;
+   balance_claim_operation claim_op;
+   claim_op.deposit_to_account = db1->get_index_type<account_index>().indices().get<by_name>().find( "sys.master" )->id;
+   claim_op.balance_to_claim = balance_id_type();
+   claim_op.balance_owner_key = master_key.get_public_key();
+   claim_op.total_claimed = balance_id_type()(*db1).balance;
+   trx.operations.push_back( claim_op );
+   trx.set_expiration( db1->get_slot_time( 10 ) );
+   trx.sign( master_key, db1->get_chain_id() );
+
+   db1->push_transaction( trx );
+   app1.p2p_node()->broadcast( graphene::net::trx_message( trx ) );
+   fc::usleep(fc::milliseconds(500));
+   BOOST_REQUIRE( db2->is_known_transaction( trx.id() ) );
+
+   // app2 produces the block, app1 rebuilds it from the transaction it already has:
+   const signed_block block = produce_block( *db2 );
+   app2.p2p_node()->broadcast( graphene::net::block_message( block ) );
+   fc::usleep(fc::milliseconds(500));
+   BOOST_CHECK_EQUAL( app1.p2p_node()->get_connection_count(), 1 );
+   BOOST_CHECK( db1->head_block_id() == block.id() );
+
+   const graphene::net::compact_block_relay_stats sent = app2.p2p_node()->get_compact_block_relay_stats();
+   const graphene::net::compact_block_relay_stats received = app1.p2p_node()->get_compact_block_relay_stats();
+   BOOST_CHECK_EQUAL( sent.blocks_sent, 1u );
+   BOOST_CHECK_EQUAL( received.blocks_received, 1u );
+   BOOST_CHECK_EQUAL( received.blocks_reconstructed, 1u );
+   BOOST_CHECK_EQUAL( received.transactions_from_cache, 1u );
+   BOOST_CHECK_EQUAL( received.transactions_fetched, 0u );
+   BOOST_CHECK_EQUAL( received.fallbacks, 0u );
+
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests::p2p_tests
+BOOST_AUTO_TEST_SUITE_END()  // dascoin_tests
@@ -593,6 +593,39 @@ BOOST_AUTO_TEST_CASE(get_queue_by_page_test)
 
 } FC_LOG_AND_RETHROW() }
 
+BOOST_AUTO_TEST_CASE(queue_submission_position_test)
+{ try {
+  VAULT_ACTORS((first)(second)(third))
+
+  do_op(submit_reserve_cycles_to_queue_operation(get_cycle_issuer_id(), first_id, 200, 200, "test"));
+  do_op(submit_reserve_cycles_to_queue_operation(get_cycle_issuer_id(), second_id, 200, 200, "test"));
+  do_op(submit_reserve_cycles_to_queue_operation(get_cycle_issuer_id(), third_id, 200, 200, "test"));
+  do_op(submit_reserve_cycles_to_queue_operation(get_cycle_issuer_id(), first_id, 200, 200, "test"));
+
+  // Positions follow the order of submissions:
+  auto result = _dal.get_queue_submissions_with_pos_for_accounts({first_id, third_id});
+  BOOST_CHECK_EQUAL(result.size(), 2);
+  BOOST_CHECK_EQUAL(result[0].result->size(), 2);
+  BOOST_CHECK_EQUAL((*result[0].result)[0].position, 0);
+  BOOST_CHECK_EQUAL((*result[0].result)[1].position, 3);
+  BOOST_CHECK_EQUAL((*result[1].result)[0].position, 2);
+
+  // Mint from the front of the queue, positions must still point at the right submissions:
+  adjust_dascoin_reward(1 * DASCOIN_DEFAULT_ASSET_PRECISION);
+  toggle_reward_queue(true);
+  generate_blocks(db.head_block_time() + fc::seconds(get_global_properties().parameters.reward_interval_time_seconds));
+  BOOST_CHECK_LT(_dal.get_reward_queue_size(), 4);
+
+  result = _dal.get_queue_submissions_with_pos_for_accounts({first_id, second_id, third_id});
+  for ( const auto& acc_result : result )
+    for ( const auto& sub : *acc_result.result )
+    {
+      auto queue = _dal.get_reward_queue_by_page(sub.position, 1);
+      BOOST_CHECK(queue[0].id == sub.submission.id);
+    }
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()